@@ -0,0 +1,986 @@
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "benchmark/harness.hpp"
+#include "mml/aabb.hpp"
+#include "mml/affine_transformation.hpp"
+#include "mml/bvh.hpp"
+#include "mml/dynamic_decomposition.hpp"
+#include "mml/dynamic_matrix.hpp"
+#include "mml/dynamic_vector.hpp"
+#include "mml/frustum.hpp"
+#include "mml/parallel.hpp"
+#include "mml/quaternion.hpp"
+#include "mml/sparse_matrix.hpp"
+#include "mml/storage.hpp"
+#include "mml/transform_tree.hpp"
+#include "mml/transformation.hpp"
+#include "mml/vector_batch.hpp"
+
+using namespace mml;
+using namespace mml::benchmark;
+
+// Elements per batch of the micro-benchmarks: small enough to stay in the first level cache.
+static const size_t batch = 1024;
+
+template<typename V>
+void vector_suite(runner& r, std::string const& type) {
+	using T = typename V::value_type;
+	using base = basic_vector<T, V::size_value>;
+	generator g;
+	auto const a = g.vectors<V>(batch), b = g.vectors<V>(batch, 0.5, 2.0);
+	std::vector<base> out(batch);
+	r.run("vector.add", type, batch, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++) {
+			for (size_t i = 0; i < batch; i++)
+				out[i] = a[i] + b[i];
+			sum += double(out[it % batch][0]);
+		}
+		return sum;
+	});
+	r.run("vector.scale", type, batch, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++) {
+			for (size_t i = 0; i < batch; i++)
+				out[i] = a[i] * T(3);
+			sum += double(out[it % batch][0]);
+		}
+		return sum;
+	});
+	r.run("vector.dot", type, batch, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++)
+			for (size_t i = 0; i < batch; i++)
+				sum += double(dot(a[i], b[i]));
+		return sum;
+	});
+	r.run("vector.length", type, batch, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++)
+			for (size_t i = 0; i < batch; i++)
+				sum += double(b[i].length());
+		return sum;
+	});
+	if constexpr (std::is_floating_point<T>::value)
+		r.run("vector.normalize", type, batch, [&](size_t iterations) {
+			double sum = 0;
+			for (size_t it = 0; it < iterations; it++) {
+				for (size_t i = 0; i < batch; i++) {
+					out[i] = b[i];
+					out[i].normalize();
+				}
+				sum += double(out[it % batch][0]);
+			}
+			return sum;
+		});
+	if constexpr (V::size_value == 3)
+		r.run("vector.cross", type, batch, [&](size_t iterations) {
+			double sum = 0;
+			for (size_t it = 0; it < iterations; it++) {
+				for (size_t i = 0; i < batch; i++)
+					out[i] = a[i] ^ b[i];
+				sum += double(out[it % batch][0]);
+			}
+			return sum;
+		});
+}
+
+template<typename M>
+void matrix_suite(runner& r, std::string const& type) {
+	using T = typename M::row_type::value_type;
+	static const size_t S = M::size_value;
+	using base = basic_matrix<T, S, S>;
+	using vector_type = basic_vector<T, S>;
+	generator g;
+	auto const a = g.matrices<M>(batch), b = g.matrices<M>(batch);
+	auto const v = g.vectors<vector_type>(batch);
+	std::vector<T> values(batch * S * S);
+	for (auto& value : values)
+		value = T(g());
+	std::vector<base> out(batch);
+	std::vector<vector_type> vout(batch);
+	r.run("matrix.construct_identity", type, batch, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++) {
+			for (size_t i = 0; i < batch; i++)
+				out[i] = base(IdentityMatrix);
+			sum += double(out[it % batch].element(0, 0));
+		}
+		return sum;
+	});
+	r.run("matrix.construct_values", type, batch, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++) {
+			for (size_t i = 0; i < batch; i++) {
+				T const* p = values.data() + i * S * S;
+				if constexpr (S == 2)
+					out[i] = base(p[0], p[1], p[2], p[3]);
+				else if constexpr (S == 3)
+					out[i] = base(p[0], p[1], p[2], p[3], p[4], p[5], p[6], p[7], p[8]);
+				else
+					out[i] = base(p[0], p[1], p[2], p[3], p[4], p[5], p[6], p[7], p[8], p[9], p[10], p[11], p[12], p[13], p[14], p[15]);
+			}
+			sum += double(out[it % batch].element(0, 0));
+		}
+		return sum;
+	});
+	r.run("matrix.multiply", type, batch, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++) {
+			for (size_t i = 0; i < batch; i++)
+				out[i] = a[i] * b[i];
+			sum += double(out[it % batch].element(0, 0));
+		}
+		return sum;
+	});
+	r.run("matrix.transform", type, batch, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++) {
+			for (size_t i = 0; i < batch; i++)
+				vout[i] = a[i] * v[i];
+			sum += double(vout[it % batch][0]);
+		}
+		return sum;
+	});
+	if constexpr (std::is_floating_point<T>::value) {
+		r.run("matrix.determinant", type, batch, [&](size_t iterations) {
+			double sum = 0;
+			for (size_t it = 0; it < iterations; it++)
+				for (size_t i = 0; i < batch; i++)
+					sum += double(a[i].determinant());
+			return sum;
+		});
+		r.run("matrix.inverse", type, batch, [&](size_t iterations) {
+			double sum = 0;
+			for (size_t it = 0; it < iterations; it++) {
+				for (size_t i = 0; i < batch; i++)
+					out[i] = a[i].inverse();
+				sum += double(out[it % batch].element(0, 0));
+			}
+			return sum;
+		});
+	}
+}
+
+template<typename M>
+void transformation_suite(runner& r, std::string const& type) {
+	using T = typename M::row_type::value_type;
+	static const size_t S = M::size_value - 1;
+	using base = basic_transformation<T, S>;
+	using vector_type = basic_vector<T, S>;
+	generator g;
+	auto const d = g.vectors<vector_type>(batch);
+	auto const axes = g.vectors<vector_type>(batch, 0.1, 1.0);
+	std::vector<T> angles(batch);
+	for (auto& angle : angles)
+		angle = T(g(-3.0, 3.0));
+	std::vector<base> a(batch), b(batch), out(batch);
+	for (size_t i = 0; i < batch; i++) {
+		a[i].translate(d[i]);
+		b[i].scale(axes[i]);
+		if constexpr (S == 3) {
+			a[i].rotate(angles[i], axes[i]);
+			b[i].rotate(angles[batch - 1 - i], axes[batch - 1 - i]);
+		} else {
+			a[i].rotate(angles[i]);
+			b[i].rotate(angles[batch - 1 - i]);
+		}
+	}
+	r.run("transformation.compose", type, batch, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++) {
+			for (size_t i = 0; i < batch; i++)
+				static_cast<basic_matrix<T, S + 1, S + 1>&>(out[i]) = a[i] * b[i];
+			sum += double(out[it % batch].element(0, S));
+		}
+		return sum;
+	});
+	r.run("transformation.translate", type, batch, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++) {
+			for (size_t i = 0; i < batch; i++) {
+				out[i] = a[i];
+				out[i].translate(d[i]);
+			}
+			sum += double(out[it % batch].element(0, S));
+		}
+		return sum;
+	});
+	r.run("transformation.rotate", type, batch, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++) {
+			for (size_t i = 0; i < batch; i++) {
+				out[i] = a[i];
+				if constexpr (S == 3)
+					out[i].rotate(angles[i], axes[i]);
+				else
+					out[i].rotate(angles[i]);
+			}
+			sum += double(out[it % batch].element(0, 0));
+		}
+		return sum;
+	});
+	r.run("transformation.rotation", type, batch, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++) {
+			for (size_t i = 0; i < batch; i++) {
+				if constexpr (S == 3)
+					out[i] = rotation<T>(angles[i], axes[i]);
+				else
+					out[i] = rotation<T>(angles[i]);
+			}
+			sum += double(out[it % batch].element(0, 0));
+		}
+		return sum;
+	});
+	if constexpr (S == 3) {
+		r.run("transformation.rotations_z", type, batch, [&](size_t iterations) {
+			double sum = 0;
+			for (size_t it = 0; it < iterations; it++) {
+				rotations_z(angles.data(), out.data(), batch);
+				sum += double(out[it % batch].element(0, 0));
+			}
+			return sum;
+		});
+		r.run("transformation.rotations", type, batch, [&](size_t iterations) {
+			double sum = 0;
+			for (size_t it = 0; it < iterations; it++) {
+				rotations(angles.data(), axes.data(), out.data(), batch);
+				sum += double(out[it % batch].element(0, 0));
+			}
+			return sum;
+		});
+	}
+	r.run("transformation.affine_inverse", type, batch, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++) {
+			for (size_t i = 0; i < batch; i++)
+				out[i] = affine_inverse(a[i]);
+			sum += double(out[it % batch].element(0, S));
+		}
+		return sum;
+	});
+	if constexpr (S == 3) {
+		r.run("projection.perspective", type, batch, [&](size_t iterations) {
+			double sum = 0;
+			for (size_t it = 0; it < iterations; it++) {
+				for (size_t i = 0; i < batch; i++) {
+					T const w = T(1) + axes[i][0], h = T(1) + axes[i][1];
+					out[i] = perspective_projection<T>(-w, w, -h, h, T(0.1), T(100) + axes[i][2]);
+				}
+				sum += double(out[it % batch].element(0, 0));
+			}
+			return sum;
+		});
+		r.run("projection.orthographic", type, batch, [&](size_t iterations) {
+			double sum = 0;
+			for (size_t it = 0; it < iterations; it++) {
+				for (size_t i = 0; i < batch; i++) {
+					T const w = T(1) + axes[i][0], h = T(1) + axes[i][1];
+					out[i] = orthographic_projection<T>(-w, w, -h, h, T(0.1), T(100) + axes[i][2]);
+				}
+				sum += double(out[it % batch].element(0, 0));
+			}
+			return sum;
+		});
+	}
+}
+
+// Points transformed by one matrix: serial array-of-structures, structure-of-arrays batches
+// and the thread pool at every thread count up to the hardware concurrency.
+template<typename T>
+void point_suite(runner& r, std::string const& type) {
+	using point = basic_vector<T, 3>;
+	static const size_t count = size_t(1) << 20;
+	generator g;
+	auto const points = g.vectors<point>(count);
+	std::vector<point> out(count);
+	basic_transformation<T, 3> m;
+	m.translate(point(T(1), T(2), T(3)));
+	m.rotate(T(0.5), point(T(1), T(1), T(0)));
+	affine_transformation<T, 3> a;
+	a.translate(point(T(1), T(2), T(3)));
+	a.rotate(T(0.5), point(T(1), T(1), T(0)));
+
+	r.run("points.transform", type, count, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++) {
+			for (size_t i = 0; i < count; i++) {
+				basic_vector<T, 4> p(points[i]);
+				p[3] = T(1);
+				out[i] = point(m * p);
+			}
+			sum += double(out[it % count][0]);
+		}
+		return sum;
+	});
+	r.run("points.affine_transform", type, count, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++) {
+			transform_points(a, points.data(), count, out.data());
+			sum += double(out[it % count][0]);
+		}
+		return sum;
+	});
+	for (auto p : {precision::precise, precision::fast}) {
+		std::vector<point> normals(points);
+		r.run(p == precision::fast ? "points.fast_normalize" : "points.normalize", type, count, [&](size_t iterations) {
+			double sum = 0;
+			for (size_t it = 0; it < iterations; it++) {
+				std::copy(points.begin(), points.end(), normals.begin());
+				normalize(normals.data(), count, p);
+				sum += double(normals[it % count][0]);
+			}
+			return sum;
+		});
+	}
+	vector_batch<T, 3> soa(points.begin(), points.end()), soa_out;
+	r.run("points.batch_transform", type, count, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++) {
+			transform(m, soa, soa_out);
+			sum += double(soa_out.element(it % count)[0]);
+		}
+		return sum;
+	});
+	std::vector<size_t> thread_counts;
+	for (size_t threads = 1; threads < thread_pool::default_size(); threads *= 2)
+		thread_counts.push_back(threads);
+	thread_counts.push_back(thread_pool::default_size());
+	for (size_t threads : thread_counts) {
+		thread_pool pool(threads);
+		r.run("points.parallel_transform", type, count, [&](size_t iterations) {
+			double sum = 0;
+			for (size_t it = 0; it < iterations; it++) {
+				parallel_transform(m, points.data(), count, out.data(), default_chunk_size<point>(), pool);
+				sum += double(out[it % count][0]);
+			}
+			return sum;
+		}, threads);
+	}
+}
+
+// Bulk conversion of a vertex stream between float and a storage format, in both directions.
+template<typename T>
+void storage_suite(runner& r, std::string const& type) {
+	static const size_t count = size_t(1) << 20;
+	generator g;
+	auto const vertices = g.vectors<vector4f>(count);
+	std::vector<basic_vector<T, 4>> stored(count);
+	std::vector<vector4f> loaded(count);
+
+	r.run("storage.pack", type, count, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++) {
+			convert(vertices.data(), stored.data(), count);
+			sum += double(float(stored[it % count][0]));
+		}
+		return sum;
+	});
+	r.run("storage.unpack", type, count, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++) {
+			convert(stored.data(), loaded.data(), count);
+			sum += double(loaded[it % count][0]);
+		}
+		return sum;
+	});
+}
+
+// Bounds of transformed boxes: all eight corners through the matrix, against the center and
+// extent form one box at a time and over the whole array.
+template<typename T>
+void aabb_suite(runner& r, std::string const& type) {
+	using point = basic_vector<T, 3>;
+	using box = basic_aabb<T, 3>;
+	generator g;
+	auto const centers = g.vectors<point>(batch, -100.0, 100.0);
+	auto const extents = g.vectors<point>(batch, 0.1, 2.0);
+	std::vector<box> boxes(batch), out(batch);
+	for (size_t i = 0; i < batch; i++)
+		boxes[i] = box::from_center(centers[i], extents[i]);
+	basic_transformation<T, 3> m;
+	m.translate(point(T(1), T(2), T(3)));
+	m.rotate(T(0.5), point(T(1), T(1), T(0)));
+
+	r.run("aabb.transform_corners", type, batch, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++) {
+			for (size_t i = 0; i < batch; i++) {
+				box res;
+				for (size_t c = 0; c < 8; c++) {
+					basic_vector<T, 4> p;
+					for (size_t k = 0; k < 3; k++)
+						p[k] = (c >> k) & 1 ? boxes[i].maximum()[k] : boxes[i].minimum()[k];
+					p[3] = T(1);
+					res.expand(point(m * p));
+				}
+				out[i] = res;
+			}
+			sum += double(out[it % batch].maximum()[0]);
+		}
+		return sum;
+	});
+	r.run("aabb.transform", type, batch, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++) {
+			for (size_t i = 0; i < batch; i++)
+				out[i] = transform(m, boxes[i]);
+			sum += double(out[it % batch].maximum()[0]);
+		}
+		return sum;
+	});
+	r.run("aabb.batch_transform", type, batch, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++) {
+			transform(m, boxes.data(), batch, out.data());
+			sum += double(out[it % batch].maximum()[0]);
+		}
+		return sum;
+	});
+}
+
+// View frustum culling of a million spheres and boxes scattered around the camera, object by
+// object and in structure-of-arrays batches.
+template<typename T>
+void culling_suite(runner& r, std::string const& type) {
+	using point = basic_vector<T, 3>;
+	static const size_t count = size_t(1) << 20;
+	generator g;
+	auto const centers = g.vectors<point>(count, -100.0, 100.0);
+	auto const extents = g.vectors<point>(count, 0.1, 2.0);
+	auto view = rotation_y<T>(T(0.5));
+	view.translate(point(T(0), T(0), T(-10)));
+	basic_frustum<T> const f(basic_matrix<T, 4, 4>(perspective_projection<T>(T(-1), T(1), T(-0.75), T(0.75), T(1), T(200)) * view));
+
+	vector_batch<T, 3> soa_centers(centers.begin(), centers.end()), minima, maxima;
+	std::vector<T> radii(count);
+	for (size_t i = 0; i < count; i++) {
+		radii[i] = extents[i].length();
+		minima.push_back(centers[i] - extents[i]);
+		maxima.push_back(centers[i] + extents[i]);
+	}
+	std::vector<uint64_t> visible(visibility_words(count));
+	auto const report = [&](result* res) {
+		if (res)
+			res->metrics.emplace_back("visible", double(visible_count(visible.data(), count)));
+	};
+
+	report(r.run("culling.spheres_scalar", type, count, [&](size_t iterations) {
+		for (size_t it = 0; it < iterations; it++) {
+			std::fill(visible.begin(), visible.end(), uint64_t(0));
+			for (size_t i = 0; i < count; i++)
+				if (f.intersects(centers[i], radii[i]))
+					visible[i / 64] |= uint64_t(1) << (i % 64);
+		}
+		return double(visible[count / 128]);
+	}));
+	report(r.run("culling.spheres", type, count, [&](size_t iterations) {
+		for (size_t it = 0; it < iterations; it++)
+			cull_spheres(f, soa_centers.x(), soa_centers.y(), soa_centers.z(), radii.data(), count, visible.data());
+		return double(visible[count / 128]);
+	}));
+	report(r.run("culling.boxes_scalar", type, count, [&](size_t iterations) {
+		for (size_t it = 0; it < iterations; it++) {
+			std::fill(visible.begin(), visible.end(), uint64_t(0));
+			for (size_t i = 0; i < count; i++)
+				if (f.intersects(centers[i] - extents[i], centers[i] + extents[i]))
+					visible[i / 64] |= uint64_t(1) << (i % 64);
+		}
+		return double(visible[count / 128]);
+	}));
+	T const* const low[3] = {minima.x(), minima.y(), minima.z()};
+	T const* const high[3] = {maxima.x(), maxima.y(), maxima.z()};
+	report(r.run("culling.boxes", type, count, [&](size_t iterations) {
+		for (size_t it = 0; it < iterations; it++)
+			cull_boxes(f, low, high, count, visible.data());
+		return double(visible[count / 128]);
+	}));
+}
+
+// Hierarchies over a million small triangles and points: build time by thread count, then
+// ray casts, nearest neighbours and radius queries per second.
+template<typename T>
+void bvh_suite(runner& r, std::string const& type) {
+	using point = basic_vector<T, 3>;
+	static const size_t count = size_t(1) << 20, queries = size_t(1) << 14;
+	generator g;
+	auto const centers = g.vectors<point>(count, -100.0, 100.0);
+	auto const corners = g.vectors<point>(2 * count, -0.5, 0.5);
+	std::vector<basic_triangle<T>> triangles(count);
+	for (size_t i = 0; i < count; i++)
+		triangles[i] = basic_triangle<T>(centers[i], centers[i] + corners[2 * i], centers[i] + corners[2 * i + 1]);
+	auto const origins = g.vectors<point>(queries, -100.0, 100.0);
+	auto const directions = g.vectors<point>(queries);
+
+	std::vector<size_t> thread_counts{1};
+	if (thread_pool::default_size() > 1)
+		thread_counts.push_back(thread_pool::default_size());
+	for (size_t threads : thread_counts) {
+		thread_pool pool(threads);
+		basic_bvh<basic_triangle<T>> tree;
+		if (auto res = r.run("bvh.build_triangles", type, count, [&](size_t iterations) {
+				for (size_t it = 0; it < iterations; it++)
+					tree.build(triangles.data(), count, 4, pool);
+				return double(tree.node_count());
+			}, threads))
+			res->metrics.emplace_back("nodes", double(tree.node_count()));
+		basic_bvh<point> points;
+		r.run("bvh.build_points", type, count, [&](size_t iterations) {
+			for (size_t it = 0; it < iterations; it++)
+				points.build(centers.data(), count, 4, pool);
+			return double(points.node_count());
+		}, threads);
+	}
+
+	basic_bvh<basic_triangle<T>> const tree(triangles);
+	basic_bvh<point> const points(centers);
+	size_t hits = 0;
+	if (auto res = r.run("bvh.cast", type, queries, [&](size_t iterations) {
+			double sum = 0;
+			hits = 0;
+			for (size_t it = 0; it < iterations; it++)
+				for (size_t i = 0; i < queries; i++)
+					if (auto hit = tree.cast(basic_ray<T>(origins[i], directions[i]))) {
+						sum += double(hit.distance);
+						hits++;
+					}
+			return sum;
+		}))
+		res->metrics.emplace_back("hits", double(hits) / double(res->iterations));
+	std::vector<typename basic_bvh<point>::hit> neighbours;
+	r.run("bvh.nearest_8", type, queries, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++)
+			for (size_t i = 0; i < queries; i++) {
+				points.nearest(origins[i], 8, neighbours);
+				sum += double(neighbours.back().distance);
+			}
+		return sum;
+	});
+	std::vector<size_t> found;
+	r.run("bvh.within", type, queries, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++)
+			for (size_t i = 0; i < queries; i++) {
+				found.clear();
+				points.within(origins[i], T(5), found);
+				sum += double(found.size());
+			}
+		return sum;
+	});
+}
+
+// Rotation composition in the three representations.
+template<typename T>
+void composition_suite(runner& r, std::string const& type) {
+	using axis = basic_vector<T, 3>;
+	generator g;
+	auto const axes = g.vectors<axis>(batch, 0.1, 1.0);
+	std::vector<basic_quaternion<T>> q(batch), q_out(batch);
+	std::vector<affine_transformation<T, 3>> a(batch), a_out(batch);
+	for (size_t i = 0; i < batch; i++) {
+		q[i] = quaternion_rotation(T(g(-3.0, 3.0)), axes[i]);
+		a[i].rotate(T(g(-3.0, 3.0)), axes[i]);
+		a[i].translate(axes[batch - 1 - i]);
+	}
+	r.run("quaternion.compose", type, batch, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++) {
+			for (size_t i = 0; i < batch; i++)
+				q_out[i] = q[i] * q[batch - 1 - i];
+			sum += double(q_out[it % batch].w());
+		}
+		return sum;
+	});
+	r.run("quaternion.slerp", type, batch, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++) {
+			for (size_t i = 0; i < batch; i++)
+				q_out[i] = slerp(q[i], q[batch - 1 - i], T(0.3));
+			sum += double(q_out[it % batch].w());
+		}
+		return sum;
+	});
+	r.run("quaternion.nlerp", type, batch, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++) {
+			for (size_t i = 0; i < batch; i++)
+				q_out[i] = nlerp(q[i], q[batch - 1 - i], T(0.3));
+			sum += double(q_out[it % batch].w());
+		}
+		return sum;
+	});
+	// The batched entry points over the same operands, against the loops above.
+	std::vector<basic_quaternion<T>> q_reversed(q.rbegin(), q.rend());
+	std::vector<axis> v_out(batch);
+	r.run("quaternion.compose_array", type, batch, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++) {
+			multiply(q.data(), q_reversed.data(), batch, q_out.data());
+			sum += double(q_out[it % batch].w());
+		}
+		return sum;
+	});
+	r.run("quaternion.slerp_array", type, batch, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++) {
+			slerp(q.data(), q_reversed.data(), batch, T(0.3), q_out.data());
+			sum += double(q_out[it % batch].w());
+		}
+		return sum;
+	});
+	r.run("quaternion.nlerp_array", type, batch, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++) {
+			nlerp(q.data(), q_reversed.data(), batch, T(0.3), q_out.data());
+			sum += double(q_out[it % batch].w());
+		}
+		return sum;
+	});
+	r.run("quaternion.rotate", type, batch, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++) {
+			for (size_t i = 0; i < batch; i++)
+				v_out[i] = q[i].rotate(axes[batch - 1 - i]);
+			sum += double(v_out[it % batch][0]);
+		}
+		return sum;
+	});
+	std::vector<axis> axes_reversed(axes.rbegin(), axes.rend());
+	r.run("quaternion.rotate_array", type, batch, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++) {
+			rotate(q.data(), axes_reversed.data(), batch, v_out.data());
+			sum += double(v_out[it % batch][0]);
+		}
+		return sum;
+	});
+	r.run("affine_transformation.compose", type, batch, [&](size_t iterations) {
+		double sum = 0;
+		for (size_t it = 0; it < iterations; it++) {
+			for (size_t i = 0; i < batch; i++)
+				a_out[i] = a[i] * a[batch - 1 - i];
+			sum += double(a_out[it % batch].element(0, 3));
+		}
+		return sum;
+	});
+}
+
+// Right-looking LU without blocking, the baseline for dynamic_lu.
+template<typename T>
+void naive_lu(std::vector<T>& a, size_t n) {
+	for (size_t k = 0; k < n; k++) {
+		size_t p = k;
+		for (size_t r = k + 1; r < n; r++)
+			if (std::abs(a[r * n + k]) > std::abs(a[p * n + k]))
+				p = r;
+		for (size_t c = 0; c < n; c++)
+			std::swap(a[k * n + c], a[p * n + c]);
+		for (size_t r = k + 1; r < n; r++) {
+			T const f = a[r * n + k] /= a[k * n + k];
+			for (size_t c = k + 1; c < n; c++)
+				a[r * n + c] -= f * a[k * n + c];
+		}
+	}
+}
+
+// Macro-benchmarks; items are floating point operations, so ns_per_item is the inverse of
+// the throughput and gflops is reported next to it.
+template<typename T>
+void dense_suite(runner& r, std::string const& type) {
+	generator g;
+	for (size_t n : {size_t(256), size_t(1024)}) {
+		dynamic_matrix<T> a(n, n, ZeroMatrix), b(n, n, ZeroMatrix), c;
+		for (size_t i = 0; i < n; i++)
+			for (size_t j = 0; j < n; j++) {
+				a.element(i, j) = T(g());
+				b.element(i, j) = T(g()) + (i == j ? T(n) : T(0));
+			}
+		std::string const sized = type + "/" + std::to_string(n);
+		size_t const flops = 2 * n * n * n;
+		if (auto res = r.run("dynamic_matrix.multiply", sized, flops, [&](size_t iterations) {
+				for (size_t it = 0; it < iterations; it++)
+					multiply(a, b, c);
+				return double(c.element(n - 1, n - 1));
+			}, thread_pool::default_size()))
+			res->metrics.emplace_back("gflops", 1.0 / res->median());
+		if (auto res = r.run("dynamic_lu", sized, flops / 3, [&](size_t iterations) {
+				double sum = 0;
+				for (size_t it = 0; it < iterations; it++)
+					sum += double(dynamic_lu<T>(b).determinant() > T(0));
+				return sum;
+			}, thread_pool::default_size()))
+			res->metrics.emplace_back("gflops", 1.0 / res->median());
+		std::vector<T> flat(n * n);
+		if (auto res = r.run("naive_lu", sized, flops / 3, [&](size_t iterations) {
+				double sum = 0;
+				for (size_t it = 0; it < iterations; it++) {
+					for (size_t i = 0; i < n; i++)
+						for (size_t j = 0; j < n; j++)
+							flat[i * n + j] = b.element(i, j);
+					naive_lu(flat, n);
+					sum += double(flat[n * n - 1]);
+				}
+				return sum;
+			}))
+			res->metrics.emplace_back("gflops", 1.0 / res->median());
+	}
+}
+
+// A million rows of ten entries each near the diagonal, as a finite element mesh in a good
+// node order: assembly from triplets, the footprint of the compressed arrays and products
+// per stored entry, by thread count and with vector and 3 x 3 block elements.
+template<typename T>
+void sparse_suite(runner& r, std::string const& type) {
+	static const size_t count = size_t(1) << 20, per_row = 10, band = 2048, nodes = size_t(1) << 18;
+	generator g;
+	auto const column = [&](size_t row, size_t size) {
+		return size_t(std::min(std::max(double(row) + g(-double(band), double(band)), 0.0), double(size - 1)));
+	};
+	sparse_builder<T> builder(count, count, count * per_row);
+	for (size_t i = 0; i < count; i++)
+		for (size_t k = 0; k < per_row; k++)
+			builder.add(i, column(i, count), T(g()));
+	sparse_matrix<T> a;
+	if (auto res = r.run("sparse.build", type, builder.size(), [&](size_t iterations) {
+			for (size_t it = 0; it < iterations; it++)
+				a = builder.build();
+			return double(a.non_zeros());
+		})) {
+		res->metrics.emplace_back("bytes_per_entry", double(a.memory_size()) / double(a.non_zeros()));
+		res->metrics.emplace_back("megabytes", double(a.memory_size()) / 1048576.0);
+		res->metrics.emplace_back("dense_ratio", double(count) * double(count) * double(sizeof(T)) / double(a.memory_size()));
+	}
+
+	std::vector<T> x(count), y(count);
+	for (auto& value : x)
+		value = T(g());
+	auto const columns = a.with_layout(ColumnMajor);
+	std::vector<size_t> thread_counts{1};
+	if (thread_pool::default_size() > 1)
+		thread_counts.push_back(thread_pool::default_size());
+	for (size_t threads : thread_counts) {
+		thread_pool pool(threads);
+		if (auto res = r.run("sparse.multiply", type, a.non_zeros(), [&](size_t iterations) {
+				for (size_t it = 0; it < iterations; it++)
+					multiply(a, x.data(), y.data(), default_chunk_size<T>(), pool);
+				return double(y[count / 2]);
+			}, threads))
+			res->metrics.emplace_back("gflops", 2.0 / res->median());
+		r.run("sparse.multiply_csc", type, columns.non_zeros(), [&](size_t iterations) {
+			for (size_t it = 0; it < iterations; it++)
+				multiply(columns, x.data(), y.data(), default_chunk_size<T>(), pool);
+			return double(y[count / 2]);
+		}, threads);
+	}
+
+	auto const points = g.vectors<basic_vector<T, 3>>(count);
+	std::vector<basic_vector<T, 3>> moved(count);
+	if (auto res = r.run("sparse.multiply_vector3", type, a.non_zeros(), [&](size_t iterations) {
+			for (size_t it = 0; it < iterations; it++)
+				multiply(a, points.data(), moved.data());
+			return double(moved[count / 2][0]);
+		}, thread_pool::default_size()))
+		res->metrics.emplace_back("gflops", 6.0 / res->median());
+
+	using block = basic_matrix<T, 3, 3>;
+	sparse_builder<block> blocks(nodes, nodes, nodes * per_row);
+	for (size_t i = 0; i < nodes; i++)
+		for (size_t k = 0; k < per_row; k++) {
+			block b(ZeroMatrix);
+			for (size_t p = 0; p < 3; p++)
+				for (size_t q = 0; q < 3; q++)
+					b.element(p, q) = T(g());
+			blocks.add(i, column(i, nodes), b);
+		}
+	auto const stiffness = blocks.build();
+	std::vector<basic_vector<T, 3>> forces(nodes);
+	if (auto res = r.run("sparse.multiply_block3", type, stiffness.non_zeros(), [&](size_t iterations) {
+			for (size_t it = 0; it < iterations; it++)
+				multiply(stiffness, points.data(), forces.data());
+			return double(forces[nodes / 2][0]);
+		}, thread_pool::default_size())) {
+		res->metrics.emplace_back("gflops", 18.0 / res->median());
+		res->metrics.emplace_back("bytes_per_entry", double(stiffness.memory_size()) / double(stiffness.non_zeros()));
+	}
+}
+
+template<typename T>
+void blas1_suite(runner& r, std::string const& type) {
+	static const size_t count = size_t(1) << 22;
+	generator g;
+	dynamic_vector<T> x(count), y(count), z(count);
+	for (size_t i = 0; i < count; i++) {
+		x[i] = T(g());
+		y[i] = T(g());
+		z[i] = T(g());
+	}
+	r.run("dynamic_vector.dot_naive", type, count, [&](size_t iterations) {
+		T res = T(0);
+		for (size_t it = 0; it < iterations; it++)
+			for (size_t i = 0; i < count; i++)
+				res += x.element(i) * y.element(i);
+		return double(res);
+	});
+	std::vector<size_t> thread_counts{1};
+	if (thread_pool::default_size() > 1)
+		thread_counts.push_back(thread_pool::default_size());
+	for (size_t threads : thread_counts) {
+		thread_pool pool(threads);
+		if (auto res = r.run("dynamic_vector.dot", type, count, [&](size_t iterations) {
+				T res = T(0);
+				for (size_t it = 0; it < iterations; it++)
+					res += dot(x, y, pool);
+				return double(res);
+			}, threads))
+			res->metrics.emplace_back("gb_per_s", 2.0 * sizeof(T) / res->median());
+		if (auto res = r.run("dynamic_vector.length", type, count, [&](size_t iterations) {
+				T res = T(0);
+				for (size_t it = 0; it < iterations; it++)
+					res += x.length(pool);
+				return double(res);
+			}, threads))
+			res->metrics.emplace_back("gb_per_s", double(sizeof(T)) / res->median());
+		if (auto res = r.run("dynamic_vector.axpy", type, count, [&](size_t iterations) {
+				for (size_t it = 0; it < iterations; it++)
+					axpy(T(it & 1 ? 1 : -1), x, y, pool);
+				return double(y[count / 2]);
+			}, threads))
+			res->metrics.emplace_back("gb_per_s", 3.0 * sizeof(T) / res->median());
+		if (auto res = r.run("dynamic_vector.scale", type, count, [&](size_t iterations) {
+				for (size_t it = 0; it < iterations; it++)
+					scale(T(it & 1 ? 2 : 0.5), z, pool);
+				return double(z[count / 2]);
+			}, threads))
+			res->metrics.emplace_back("gb_per_s", 2.0 * sizeof(T) / res->median());
+		if (auto res = r.run("dynamic_vector.fma", type, count, [&](size_t iterations) {
+				for (size_t it = 0; it < iterations; it++)
+					fma(x, y, z, pool);
+				return double(z[count / 2]);
+			}, threads))
+			res->metrics.emplace_back("gb_per_s", 4.0 * sizeof(T) / res->median());
+	}
+}
+
+void hierarchy_suite(runner& r) {
+	static const size_t count = 100000;
+	generator g;
+	transform_tree3f tree;
+	tree.reserve(count);
+	std::vector<size_t> path;
+	for (size_t i = 0; i < count; i++) {
+		path.resize(i % 1000 == 0 ? 0 : size_t(g(0.0, double(path.size()) + 0.99)));
+		transformation3f local;
+		local.translate(vector(float(g()), float(g()), float(g())));
+		path.push_back(tree.add(path.empty() ? transform_tree3f::npos : path.back(), local));
+	}
+	tree.update();
+	std::vector<size_t> changes(count / 50);
+	for (auto& change : changes)
+		change = size_t(g(0.0, double(count) - 1.0));
+	for (double fraction : {0.02, 1.0}) {
+		size_t recomputed = 0;
+		if (auto res = r.run("transform_tree.update", fraction < 1.0 ? "transform_tree3f/2%" : "transform_tree3f/all", count, [&](size_t iterations) {
+				for (size_t it = 0; it < iterations; it++) {
+					if (fraction < 1.0)
+						for (size_t node : changes)
+							tree.set_local(node, tree.local(node));
+					else
+						for (size_t root = 0; root < count; root = tree.end(root))
+							tree.set_local(root, tree.local(root));
+					tree.update();
+					recomputed = tree.last_recomputed();
+				}
+				return double(tree.world(count - 1).element(0, 3));
+			}, thread_pool::default_size()))
+			res->metrics.emplace_back("recomputed", double(recomputed));
+	}
+}
+
+int main(int argc, char** argv) {
+	std::string filter, output;
+	double min_time = 0.05;
+	size_t repetitions = 5;
+	for (int i = 1; i < argc; i++) {
+		std::string const arg = argv[i];
+		if (arg == "--filter" && i + 1 < argc)
+			filter = argv[++i];
+		else if (arg == "--min-time" && i + 1 < argc)
+			min_time = std::stod(argv[++i]);
+		else if (arg == "--repetitions" && i + 1 < argc)
+			repetitions = size_t(std::stoul(argv[++i]));
+		else if (arg == "--output" && i + 1 < argc)
+			output = argv[++i];
+		else {
+			std::fprintf(stderr, "usage: %s [--filter substring] [--min-time seconds] [--repetitions n] [--output file.json]\n", argv[0]);
+			return arg == "--help" ? 0 : 1;
+		}
+	}
+	runner r(filter, min_time, repetitions);
+
+	vector_suite<vector2f>(r, "vector2f");
+	vector_suite<vector3f>(r, "vector3f");
+	vector_suite<vector4f>(r, "vector4f");
+	vector_suite<vector2d>(r, "vector2d");
+	vector_suite<vector3d>(r, "vector3d");
+	vector_suite<vector4d>(r, "vector4d");
+	vector_suite<vector3i>(r, "vector3i");
+	vector_suite<vector4i>(r, "vector4i");
+
+	matrix_suite<matrix2f>(r, "matrix2f");
+	matrix_suite<matrix3f>(r, "matrix3f");
+	matrix_suite<matrix4f>(r, "matrix4f");
+	matrix_suite<matrix2d>(r, "matrix2d");
+	matrix_suite<matrix3d>(r, "matrix3d");
+	matrix_suite<matrix4d>(r, "matrix4d");
+	matrix_suite<matrix4i>(r, "matrix4i");
+
+	transformation_suite<transformation2f>(r, "transformation2f");
+	transformation_suite<transformation3f>(r, "transformation3f");
+	transformation_suite<transformation2d>(r, "transformation2d");
+	transformation_suite<transformation3d>(r, "transformation3d");
+
+	point_suite<float>(r, "vector3f");
+	point_suite<double>(r, "vector3d");
+
+	storage_suite<half>(r, "vector4h");
+	storage_suite<unorm16>(r, "vector4n16");
+	storage_suite<snorm16>(r, "vector4sn16");
+	storage_suite<unorm8>(r, "vector4n8");
+	storage_suite<snorm8>(r, "vector4sn8");
+
+	aabb_suite<float>(r, "aabb3f");
+	aabb_suite<double>(r, "aabb3d");
+
+	culling_suite<float>(r, "float");
+	culling_suite<double>(r, "double");
+
+	bvh_suite<float>(r, "float");
+	bvh_suite<double>(r, "double");
+
+	composition_suite<float>(r, "float");
+	composition_suite<double>(r, "double");
+
+	dense_suite<float>(r, "float");
+	dense_suite<double>(r, "double");
+
+	sparse_suite<float>(r, "float");
+	sparse_suite<double>(r, "double");
+	blas1_suite<float>(r, "float");
+	blas1_suite<double>(r, "double");
+
+	hierarchy_suite(r);
+
+	std::FILE* out = output.empty() ? stdout : std::fopen(output.c_str(), "w");
+	if (!out) {
+		std::fprintf(stderr, "Cannot open %s.\n", output.c_str());
+		return 1;
+	}
+	r.write_json(out);
+	if (out != stdout)
+		std::fclose(out);
+	return 0;
+}
\ No newline at end of file
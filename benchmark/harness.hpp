@@ -0,0 +1,141 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mml/version.hpp"
+
+namespace mml::benchmark {
+	struct result {
+		std::string name;
+		std::string type;
+		size_t threads;
+		size_t items;
+		size_t iterations;
+		std::vector<double> samples;
+		double checksum;
+		std::vector<std::pair<std::string, double>> metrics;
+
+		double median() const {
+			auto sorted = samples;
+			std::sort(sorted.begin(), sorted.end());
+			return sorted[sorted.size() / 2];
+		}
+		double minimum() const {
+			return *std::min_element(samples.begin(), samples.end());
+		}
+		double maximum() const {
+			return *std::max_element(samples.begin(), samples.end());
+		}
+	};
+
+	// Runs a body(iterations) that processes items elements per iteration and returns a checksum
+	// of its outputs, so that the work cannot be optimized away. The iteration count is grown
+	// until one sample takes min_time; every sample is reported in nanoseconds per item.
+	class runner {
+	protected:
+		std::string filter;
+		double min_time;
+		size_t repetitions;
+		std::vector<result> results;
+
+		using clock = std::chrono::steady_clock;
+		template<typename F>
+		static double measure(F& body, size_t iterations, double& checksum) {
+			auto const start = clock::now();
+			checksum = double(body(iterations));
+			return std::chrono::duration<double>(clock::now() - start).count();
+		}
+	public:
+		explicit runner(std::string filter = "", double min_time = 0.05, size_t repetitions = 5)
+			: filter(std::move(filter)), min_time(min_time), repetitions(std::max<size_t>(repetitions, 1)) {}
+
+		bool enabled(std::string const& name, std::string const& type) const {
+			return filter.empty() || (name + '/' + type).find(filter) != std::string::npos;
+		}
+
+		template<typename F>
+		result* run(std::string const& name, std::string const& type, size_t items, F&& body, size_t threads = 1) {
+			if (!enabled(name, type))
+				return nullptr;
+			std::fprintf(stderr, "%s/%s", name.c_str(), type.c_str());
+			result r{name, type, threads, items, 1, {}, 0.0, {}};
+			double elapsed = measure(body, 1, r.checksum);
+			while (elapsed < min_time) {
+				double const scale = elapsed > 0 ? std::min(min_time * 1.2 / elapsed, 10.0) : 10.0;
+				r.iterations = std::max(r.iterations + 1, size_t(double(r.iterations) * scale));
+				elapsed = measure(body, r.iterations, r.checksum);
+			}
+			for (size_t i = 0; i < repetitions; i++)
+				r.samples.push_back(measure(body, r.iterations, r.checksum) * 1e9 / double(r.iterations * items));
+			std::fprintf(stderr, ": %.3f ns\n", r.median());
+			results.push_back(std::move(r));
+			return &results.back();
+		}
+
+		std::vector<result> const& all() const {
+			return results;
+		}
+
+		void write_json(std::FILE* out) const {
+			std::fprintf(out, "{\n\t\"library\": \"mml\",\n\t\"version\": \"%d.%d.%d.%d\",\n\t\"compiler\": \"%s\",\n",
+						 Version_Major, Version_Minor, Version_Patch, Version_Build, compiler().c_str());
+			std::fprintf(out, "\t\"min_time\": %g,\n\t\"repetitions\": %zu,\n\t\"results\": [", min_time, repetitions);
+			for (size_t i = 0; i < results.size(); i++) {
+				auto const& r = results[i];
+				std::fprintf(out, "%s\n\t\t{\"name\": \"%s\", \"type\": \"%s\", \"threads\": %zu, \"items\": %zu, \"iterations\": %zu, ",
+							 i ? "," : "", r.name.c_str(), r.type.c_str(), r.threads, r.items, r.iterations);
+				std::fprintf(out, "\"ns_per_item\": %.4f, \"min_ns\": %.4f, \"max_ns\": %.4f, \"checksum\": %.9g",
+							 r.median(), r.minimum(), r.maximum(), r.checksum);
+				for (auto const& metric : r.metrics)
+					std::fprintf(out, ", \"%s\": %.4f", metric.first.c_str(), metric.second);
+				std::fprintf(out, "}");
+			}
+			std::fprintf(out, "\n\t]\n}\n");
+		}
+
+		static std::string compiler() {
+#if defined(__clang__)
+			return "clang " __clang_version__;
+#elif defined(__GNUC__)
+			return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+			return "msvc " + std::to_string(_MSC_FULL_VER);
+#else
+			return "unknown";
+#endif
+		}
+	};
+
+	// Inputs are generated from a fixed seed so that checksums can be compared between runs.
+	class generator {
+	protected:
+		std::mt19937 engine;
+	public:
+		explicit generator(unsigned seed = 42) : engine(seed) {}
+		double operator()(double min = -1.0, double max = 1.0) {
+			return std::uniform_real_distribution<double>(min, max)(engine);
+		}
+		template<typename V>
+		std::vector<V> vectors(size_t count, double min = -1.0, double max = 1.0) {
+			std::vector<V> res(count);
+			for (auto& v : res)
+				for (size_t i = 0; i < V::size_value; i++)
+					v[i] = typename V::value_type((*this)(min, max));
+			return res;
+		}
+		template<typename M>
+		std::vector<M> matrices(size_t count, double min = -1.0, double max = 1.0) {
+			std::vector<M> res(count);
+			for (auto& m : res)
+				for (size_t r = 0; r < M::size_value; r++)
+					for (size_t c = 0; c < M::row_type::size_value; c++)
+						m.element(r, c) = typename M::row_type::value_type((*this)(min, max));
+			return res;
+		}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,231 @@
+#pragma once
+#include <algorithm>
+#include <limits>
+
+#include "mml/transformation.hpp"
+
+namespace mml {
+	// Axis-aligned bounding box given by its minimum and maximum corners, both inclusive.
+	// The default box is empty: its minimum lies above its maximum, so it contains and
+	// intersects nothing, and expanding it by a point yields a box of just that point.
+	template<typename T, size_t S>
+	class basic_aabb {
+	protected:
+		basic_vector<T, S> lower, upper;
+	public:
+		using value_type = T;
+		using vector_type = basic_vector<T, S>;
+		static const size_t size_value = S;
+
+		constexpr basic_aabb() {
+			for (size_t i = 0; i < S; i++) {
+				lower.element(i) = std::numeric_limits<T>::max();
+				upper.element(i) = std::numeric_limits<T>::lowest();
+			}
+		}
+		constexpr basic_aabb(vector_type const& minimum, vector_type const& maximum) : lower(minimum), upper(maximum) {}
+		static constexpr basic_aabb from_center(vector_type const& center, vector_type const& extent) {
+			basic_aabb res;
+			for (size_t i = 0; i < S; i++) {
+				res.lower.element(i) = center.element(i) - extent.element(i);
+				res.upper.element(i) = center.element(i) + extent.element(i);
+			}
+			return res;
+		}
+
+		constexpr vector_type const& minimum() const {
+			return lower;
+		}
+		constexpr vector_type const& maximum() const {
+			return upper;
+		}
+		constexpr vector_type& minimum() {
+			return lower;
+		}
+		constexpr vector_type& maximum() {
+			return upper;
+		}
+		constexpr vector_type center() const {
+			vector_type res;
+			for (size_t i = 0; i < S; i++)
+				res.element(i) = (lower.element(i) + upper.element(i)) / T(2);
+			return res;
+		}
+		// Half the size along every axis.
+		constexpr vector_type extent() const {
+			vector_type res;
+			for (size_t i = 0; i < S; i++)
+				res.element(i) = (upper.element(i) - lower.element(i)) / T(2);
+			return res;
+		}
+		constexpr bool empty() const {
+			for (size_t i = 0; i < S; i++)
+				if (lower.element(i) > upper.element(i))
+					return true;
+			return false;
+		}
+		constexpr T volume() const {
+			if (empty())
+				return T(0);
+			T res = T(1);
+			for (size_t i = 0; i < S; i++)
+				res *= upper.element(i) - lower.element(i);
+			return res;
+		}
+
+		constexpr basic_aabb& expand(vector_type const& point) {
+			for (size_t i = 0; i < S; i++) {
+				lower.element(i) = std::min(lower.element(i), point.element(i));
+				upper.element(i) = std::max(upper.element(i), point.element(i));
+			}
+			return *this;
+		}
+		constexpr basic_aabb& expand(basic_aabb const& other) {
+			for (size_t i = 0; i < S; i++) {
+				lower.element(i) = std::min(lower.element(i), other.lower.element(i));
+				upper.element(i) = std::max(upper.element(i), other.upper.element(i));
+			}
+			return *this;
+		}
+
+		constexpr bool contains(vector_type const& point) const {
+			for (size_t i = 0; i < S; i++)
+				if (point.element(i) < lower.element(i) || point.element(i) > upper.element(i))
+					return false;
+			return true;
+		}
+		// Every box contains the empty one.
+		constexpr bool contains(basic_aabb const& other) const {
+			if (other.empty())
+				return true;
+			for (size_t i = 0; i < S; i++)
+				if (other.lower.element(i) < lower.element(i) || other.upper.element(i) > upper.element(i))
+					return false;
+			return true;
+		}
+		constexpr bool intersects(basic_aabb const& other) const {
+			for (size_t i = 0; i < S; i++)
+				if (other.upper.element(i) < lower.element(i) || other.lower.element(i) > upper.element(i))
+					return false;
+			return !empty() && !other.empty();
+		}
+
+		constexpr bool operator==(basic_aabb const& other) const {
+			return lower == other.lower && upper == other.upper;
+		}
+		constexpr bool operator!=(basic_aabb const& other) const {
+			return !operator==(other);
+		}
+	};
+
+	template<typename T, size_t S>
+	constexpr basic_aabb<T, S> merge(basic_aabb<T, S> const& a, basic_aabb<T, S> const& b) {
+		return basic_aabb<T, S>(a).expand(b);
+	}
+	// Disjoint boxes intersect in the default empty box.
+	template<typename T, size_t S>
+	constexpr basic_aabb<T, S> intersection(basic_aabb<T, S> const& a, basic_aabb<T, S> const& b) {
+		basic_vector<T, S> lower, upper;
+		for (size_t i = 0; i < S; i++) {
+			lower.element(i) = std::max(a.minimum().element(i), b.minimum().element(i));
+			upper.element(i) = std::min(a.maximum().element(i), b.maximum().element(i));
+			if (lower.element(i) > upper.element(i))
+				return basic_aabb<T, S>();
+		}
+		return basic_aabb<T, S>(lower, upper);
+	}
+	template<typename T, size_t S>
+	basic_aabb<T, S> bounds(basic_vector<T, S> const* points, size_t count) {
+		basic_aabb<T, S> res;
+		for (size_t i = 0; i < count; i++)
+			res.expand(points[i]);
+		return res;
+	}
+	template<typename T, size_t S>
+	basic_aabb<T, S> bounds(basic_aabb<T, S> const* boxes, size_t count) {
+		basic_aabb<T, S> res;
+		for (size_t i = 0; i < count; i++)
+			res.expand(boxes[i]);
+		return res;
+	}
+
+	// Bounds of a box under an affine transformation, either a basic_transformation or an
+	// affine_transformation, whose last row is never read: the center goes through the whole
+	// matrix and the extent through the absolute values of its linear block (Arvo), instead
+	// of transforming all 2^S corners. The box grows under rotations, as its corners do.
+	template<typename T, size_t S, size_t R, typename = typename std::enable_if<R == S || R == S + 1>::type>
+	constexpr basic_aabb<T, S> transform(basic_matrix<T, R, S + 1> const& m, basic_aabb<T, S> const& box) {
+		if (box.empty())
+			return box;
+		auto const center = box.center(), extent = box.extent();
+		basic_vector<T, S> c, e;
+		for (size_t r = 0; r < S; r++) {
+			c.element(r) = m.element(r, S);
+			for (size_t k = 0; k < S; k++) {
+				c.element(r) += m.element(r, k) * center.element(k);
+				e.element(r) += math::abs(m.element(r, k)) * extent.element(k);
+			}
+		}
+		return basic_aabb<T, S>::from_center(c, e);
+	}
+	// The absolute values are taken once for the whole array, and the rows are computed in
+	// the SIMD lanes of simd::pack where there are some; every result matches the single box
+	// transform.
+	template<typename T, size_t S, size_t R, typename = typename std::enable_if<R == S || R == S + 1>::type>
+	void transform(basic_matrix<T, R, S + 1> const& m, basic_aabb<T, S> const* input, size_t count, basic_aabb<T, S>* output) {
+		T columns[S][S], absolute[S][S], offset[S];
+		for (size_t r = 0; r < S; r++) {
+			offset[r] = m.element(r, S);
+			for (size_t k = 0; k < S; k++) {
+				columns[k][r] = m.element(r, k);
+				absolute[k][r] = math::abs(m.element(r, k));
+			}
+		}
+		if constexpr (simd::is_accelerated<T, S>::value) {
+			using P = simd::pack<T, S>;
+			typename P::type linear[S], positive[S];
+			for (size_t k = 0; k < S; k++) {
+				linear[k] = P::load(columns[k]);
+				positive[k] = P::load(absolute[k]);
+			}
+			auto const translation = P::load(offset);
+			for (size_t i = 0; i < count; i++) {
+				if (input[i].empty()) {
+					output[i] = input[i];
+					continue;
+				}
+				auto const center = input[i].center(), extent = input[i].extent();
+				auto c = translation, e = P::broadcast(T(0));
+				for (size_t k = 0; k < S; k++) {
+					c = P::add(c, P::mul(linear[k], P::broadcast(center.element(k))));
+					e = P::add(e, P::mul(positive[k], P::broadcast(extent.element(k))));
+				}
+				P::store(output[i].minimum().begin(), P::sub(c, e));
+				P::store(output[i].maximum().begin(), P::add(c, e));
+			}
+		} else
+			for (size_t i = 0; i < count; i++) {
+				if (input[i].empty()) {
+					output[i] = input[i];
+					continue;
+				}
+				auto const center = input[i].center(), extent = input[i].extent();
+				basic_vector<T, S> c, e;
+				for (size_t r = 0; r < S; r++) {
+					c.element(r) = offset[r];
+					for (size_t k = 0; k < S; k++) {
+						c.element(r) += columns[k][r] * center.element(k);
+						e.element(r) += absolute[k][r] * extent.element(k);
+					}
+				}
+				output[i] = basic_aabb<T, S>::from_center(c, e);
+			}
+	}
+
+	class aabb2f : public basic_aabb<float, 2u> { public: using basic_aabb::basic_aabb; };
+	class aabb3f : public basic_aabb<float, 3u> { public: using basic_aabb::basic_aabb; };
+	class aabb2d : public basic_aabb<double, 2u> { public: using basic_aabb::basic_aabb; };
+	class aabb3d : public basic_aabb<double, 3u> { public: using basic_aabb::basic_aabb; };
+
+	class aabb : public aabb3f { public: using aabb3f::aabb3f; };
+}
\ No newline at end of file
@@ -0,0 +1,146 @@
+#pragma once
+#include "mml/transformation.hpp"
+
+namespace mml {
+	// Affine transformation stored without its constant last row (0, ..., 0, 1), so it takes
+	// S x (S + 1) elements. Composition and transforms skip that row; to_transformation()
+	// promotes it to the homogeneous form, e.g. to apply a projection.
+	template <typename T, size_t S>
+	class affine_transformation : public basic_matrix<T, S, S + 1> {
+	protected:
+		using basic_matrix<T, S, S + 1>::data;
+
+		constexpr void transform_rows(basic_matrix<T, S + 1, S + 1> const& m) {
+			MMLCount(products, 1);
+			MMLCount(flops, 2 * S * S * (S + 1));
+			T rows[S][S + 1] = {};
+			for (size_t r = 0; r < S; r++)
+				for (size_t k = 0; k < S; k++)
+					for (size_t c = 0; c < S + 1; c++)
+						rows[r][c] += m.element(r, k) * data[k].element(c);
+			for (size_t r = 0; r < S; r++)
+				for (size_t c = 0; c < S + 1; c++)
+					data[r].element(c) = rows[r][c];
+		}
+	public:
+		using basic_matrix<T, S, S + 1>::basic_matrix;
+
+		constexpr basic_transformation<T, S> to_transformation() const {
+			basic_transformation<T, S> res;
+			for (size_t r = 0; r < S; r++)
+				for (size_t c = 0; c < S + 1; c++)
+					res.element(r, c) = data[r].element(c);
+			return res;
+		}
+
+		template <typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
+		constexpr affine_transformation<T, S> translate(basic_vector<T_O, S> const& direction) {
+			for (size_t r = 0; r < S; r++)
+				data[r].element(S) += dot(data[r], direction);
+			return *this;
+		}
+		template <typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
+		constexpr affine_transformation<T, S> scale(basic_vector<T_O, S> const& direction) {
+			for (size_t r = 0; r < S; r++)
+				data[r] *= direction;
+			return *this;
+		}
+		template <typename T_O, size_t S_ = S, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type, typename = typename std::enable_if<S_ == 2>::type>
+		constexpr affine_transformation<T, S> rotate(T_O const& angle) {
+			transform_rows(rotation<T>(angle));
+			return *this;
+		}
+		template <typename T_O, typename T_OO, size_t S_ = S, typename = typename std::enable_if<std::is_convertible<T, T_O>::value>::type,
+			typename = typename std::enable_if<std::is_convertible<T, T_OO>::value>::type, typename = typename std::enable_if<S_ == 3>::type>
+		constexpr affine_transformation<T, S> rotate(T_O const& angle, basic_vector<T_OO, S> const& axis) {
+			transform_rows(rotation<T>(angle, axis));
+			return *this;
+		}
+
+		constexpr basic_vector<T, S> transform_point(basic_vector<T, S> const& point) const {
+			basic_vector<T, S> res;
+			for (size_t r = 0; r < S; r++) {
+				for (size_t c = 0; c < S; c++)
+					res.element(r) += data[r].element(c) * point.element(c);
+				res.element(r) += data[r].element(S);
+			}
+			return res;
+		}
+		constexpr basic_vector<T, S> transform_direction(basic_vector<T, S> const& direction) const {
+			basic_vector<T, S> res;
+			for (size_t r = 0; r < S; r++)
+				for (size_t c = 0; c < S; c++)
+					res.element(r) += data[r].element(c) * direction.element(c);
+			return res;
+		}
+		// The linear block is inverted in closed form and the translation mapped back through it.
+		template<typename T_ = T, typename = typename std::enable_if<std::is_floating_point<T_>::value>::type>
+		constexpr affine_transformation<T, S> inverse() const {
+			auto const linear = basic_matrix<T, S, S>(*this).inverse();
+			affine_transformation<T, S> res;
+			for (size_t r = 0; r < S; r++)
+				for (size_t c = 0; c < S; c++) {
+					res.element(r, c) = linear.element(r, c);
+					res.element(r, S) -= linear.element(r, c) * data[c].element(S);
+				}
+			return res;
+		}
+
+		constexpr affine_transformation<T, S> const& operator*=(affine_transformation<T, S> const& other) {
+			MMLCount(products, 1);
+			MMLCount(flops, 2 * S * S * (S + 1));
+			if constexpr (S == 3 && simd::is_accelerated<T, 4>::value)
+				if (!MMLIsConstantEvaluated()) {
+					simd::matrix_kernel<T>::affine_multiply(this->begin(), this->begin(), other.begin());
+					return *this;
+				}
+			T rows[S][S + 1] = {};
+			for (size_t r = 0; r < S; r++) {
+				for (size_t k = 0; k < S; k++)
+					for (size_t c = 0; c < S + 1; c++)
+						rows[r][c] += data[r].element(k) * other.element(k, c);
+				rows[r][S] += data[r].element(S);
+			}
+			for (size_t r = 0; r < S; r++)
+				for (size_t c = 0; c < S + 1; c++)
+					data[r].element(c) = rows[r][c];
+			return *this;
+		}
+	};
+
+	template <typename T, size_t S>
+	constexpr affine_transformation<T, S> operator*(affine_transformation<T, S> const& a1, affine_transformation<T, S> const& a2) {
+		affine_transformation<T, S> res(a1);
+		res *= a2;
+		return res;
+	}
+	// Homogeneous matrix, e.g. a projection, times an affine transformation.
+	template <typename T, size_t S>
+	constexpr basic_matrix<T, S + 1, S + 1> operator*(basic_matrix<T, S + 1, S + 1> const& m, affine_transformation<T, S> const& a) {
+		basic_matrix<T, S + 1, S + 1> res(ZeroMatrix);
+		for (size_t r = 0; r < S + 1; r++) {
+			for (size_t k = 0; k < S; k++)
+				for (size_t c = 0; c < S + 1; c++)
+					res.element(r, c) += m.element(r, k) * a.element(k, c);
+			res.element(r, S) += m.element(r, S);
+		}
+		return res;
+	}
+
+	// Batched points and directions; outputs may alias inputs.
+	template <typename T, size_t S, typename V, typename V_O>
+	void transform_points(affine_transformation<T, S> const& a, V const* input, size_t count, V_O* output) {
+		for (size_t i = 0; i < count; i++)
+			static_cast<basic_vector<T, S>&>(output[i]) = a.transform_point(input[i]);
+	}
+	template <typename T, size_t S, typename V, typename V_O>
+	void transform_directions(affine_transformation<T, S> const& a, V const* input, size_t count, V_O* output) {
+		for (size_t i = 0; i < count; i++)
+			static_cast<basic_vector<T, S>&>(output[i]) = a.transform_direction(input[i]);
+	}
+
+	class affine_transformation2f : public affine_transformation<float, 2u> { public: using affine_transformation::affine_transformation; };
+	class affine_transformation3f : public affine_transformation<float, 3u> { public: using affine_transformation::affine_transformation; };
+	class affine_transformation2d : public affine_transformation<double, 2u> { public: using affine_transformation::affine_transformation; };
+	class affine_transformation3d : public affine_transformation<double, 3u> { public: using affine_transformation::affine_transformation; };
+}
\ No newline at end of file
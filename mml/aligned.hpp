@@ -0,0 +1,61 @@
+#pragma once
+#include <type_traits>
+#include <vector>
+
+#include "mml/aligned_allocator.hpp"
+#include "mml/matrix.hpp"
+
+namespace mml {
+	// Opt-in over-aligned variants. The alignment also pads the size to a multiple of it, so
+	// an aligned_vector<float, 3> takes 16 bytes, like a vec3 in a std140 buffer, and arrays of
+	// them never split an element across cache lines. The padding is never read or written.
+	template<typename T, size_t S, size_t Alignment = 16>
+	class alignas(Alignment) aligned_vector : public basic_vector<T, S> {
+	public:
+		using basic_vector<T, S>::basic_vector;
+		using basic_vector<T, S>::operator=;
+		constexpr aligned_vector() : basic_vector<T, S>() {}
+		constexpr aligned_vector(basic_vector<T, S> const& other) : basic_vector<T, S>(other) {}
+	};
+	template<typename T, size_t R, size_t C, size_t Alignment = 16>
+	class alignas(Alignment) aligned_matrix : public basic_matrix<T, R, C> {
+	public:
+		using basic_matrix<T, R, C>::basic_matrix;
+		using basic_matrix<T, R, C>::operator=;
+		constexpr aligned_matrix(MatrixValue mv = IdentityMatrix) : basic_matrix<T, R, C>(mv) {}
+		constexpr aligned_matrix(basic_matrix<T, R, C> const& other) : basic_matrix<T, R, C>(other) {}
+	};
+
+	// Containers of over-aligned elements; the storage starts on a cache line at least.
+	template<typename V>
+	using aligned_buffer = std::vector<V, aligned_allocator<V, (alignof(V) > 64 ? alignof(V) : 64)>>;
+
+	// Types whose arrays can be copied with memcpy, e.g. into mapped GPU upload buffers.
+	template<typename V>
+	struct is_memcpy_layout : std::integral_constant<bool, std::is_trivially_copyable<V>::value && std::is_standard_layout<V>::value> {};
+
+	class aligned_vector3f : public aligned_vector<float, 3u> { public: using aligned_vector::aligned_vector; using aligned_vector::operator=; };
+	class aligned_vector4f : public aligned_vector<float, 4u> { public: using aligned_vector::aligned_vector; using aligned_vector::operator=; };
+	class aligned_vector3d : public aligned_vector<double, 3u, 32u> { public: using aligned_vector::aligned_vector; using aligned_vector::operator=; };
+	class aligned_vector4d : public aligned_vector<double, 4u, 32u> { public: using aligned_vector::aligned_vector; using aligned_vector::operator=; };
+
+	class aligned_matrix3f : public aligned_matrix<float, 3u, 3u> { public: using aligned_matrix::aligned_matrix; using aligned_matrix::operator=; };
+	class aligned_matrix4f : public aligned_matrix<float, 4u, 4u, 32u> { public: using aligned_matrix::aligned_matrix; using aligned_matrix::operator=; };
+	class aligned_matrix4d : public aligned_matrix<double, 4u, 4u, 32u> { public: using aligned_matrix::aligned_matrix; using aligned_matrix::operator=; };
+
+	static_assert(sizeof(aligned_vector3f) == 16 && alignof(aligned_vector3f) == 16, "aligned_vector3f has to be padded to four floats.");
+	static_assert(sizeof(aligned_vector4f) == 16 && alignof(aligned_vector4f) == 16, "aligned_vector4f has to fit one SSE register.");
+	static_assert(sizeof(aligned_vector3d) == 32 && alignof(aligned_vector3d) == 32, "aligned_vector3d has to be padded to four doubles.");
+	static_assert(sizeof(aligned_vector4d) == 32 && alignof(aligned_vector4d) == 32, "aligned_vector4d has to fit one AVX register.");
+	static_assert(sizeof(aligned_matrix3f) == 48 && alignof(aligned_matrix3f) == 16, "aligned_matrix3f has to be padded to 48 bytes.");
+	static_assert(sizeof(aligned_matrix4f) == 64 && alignof(aligned_matrix4f) == 32, "aligned_matrix4f has to be 32-byte aligned.");
+	static_assert(sizeof(aligned_matrix4d) == 128 && alignof(aligned_matrix4d) == 32, "aligned_matrix4d has to be 32-byte aligned.");
+
+	// Instrumented builds count copies, so their vectors and matrices are not trivially copyable.
+#if !MML_INSTRUMENTATION
+	static_assert(is_memcpy_layout<vector3f>::value && is_memcpy_layout<vector4f>::value && is_memcpy_layout<matrix4f>::value, "Vectors and matrices have to be trivially copyable.");
+	static_assert(is_memcpy_layout<aligned_vector3f>::value && is_memcpy_layout<aligned_vector4f>::value, "Aligned vectors have to be trivially copyable.");
+	static_assert(is_memcpy_layout<aligned_vector3d>::value && is_memcpy_layout<aligned_vector4d>::value, "Aligned vectors have to be trivially copyable.");
+	static_assert(is_memcpy_layout<aligned_matrix3f>::value && is_memcpy_layout<aligned_matrix4f>::value && is_memcpy_layout<aligned_matrix4d>::value, "Aligned matrices have to be trivially copyable.");
+#endif
+}
\ No newline at end of file
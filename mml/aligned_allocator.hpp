@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <limits>
+#include <new>
+
+namespace mml {
+	// Standard allocator returning storage aligned to Alignment bytes (a cache line by default).
+	template<typename T, size_t Alignment = 64>
+	class aligned_allocator {
+		static_assert(Alignment >= alignof(T) && (Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two no smaller than alignof(T).");
+	public:
+		using value_type = T;
+		static const size_t alignment = Alignment;
+		template<typename U> struct rebind { using other = aligned_allocator<U, Alignment>; };
+
+		aligned_allocator() noexcept {}
+		template<typename U>
+		aligned_allocator(aligned_allocator<U, Alignment> const&) noexcept {}
+
+		T* allocate(size_t count) {
+			if (count > std::numeric_limits<size_t>::max() / sizeof(T))
+				throw std::bad_array_new_length();
+			return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(Alignment)));
+		}
+		void deallocate(T* pointer, size_t) noexcept {
+			::operator delete(pointer, std::align_val_t(Alignment));
+		}
+	};
+	template<typename T, typename U, size_t Alignment>
+	bool operator==(aligned_allocator<T, Alignment> const&, aligned_allocator<U, Alignment> const&) {
+		return true;
+	}
+	template<typename T, typename U, size_t Alignment>
+	bool operator!=(aligned_allocator<T, Alignment> const&, aligned_allocator<U, Alignment> const&) {
+		return false;
+	}
+}
\ No newline at end of file
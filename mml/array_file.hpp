@@ -0,0 +1,340 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "mml/matrix.hpp"
+#include "mml/storage.hpp"
+
+#include "mml/exceptions.hpp"
+DefineNewMMLException(ArrayFileError);
+DefineNewMMLException(ArrayIndexOutOfBounds);
+
+namespace mml {
+	enum class scalar_code : uint32_t {
+		float32 = 1, float64 = 2,
+		int8 = 3, uint8 = 4, int16 = 5, uint16 = 6, int32 = 7, uint32 = 8, int64 = 9, uint64 = 10,
+		float16 = 11, unorm8 = 12, snorm8 = 13, unorm16 = 14, snorm16 = 15
+	};
+	template<typename T> struct scalar_code_of;
+	template<> struct scalar_code_of<float> : std::integral_constant<scalar_code, scalar_code::float32> {};
+	template<> struct scalar_code_of<double> : std::integral_constant<scalar_code, scalar_code::float64> {};
+	template<> struct scalar_code_of<int8_t> : std::integral_constant<scalar_code, scalar_code::int8> {};
+	template<> struct scalar_code_of<uint8_t> : std::integral_constant<scalar_code, scalar_code::uint8> {};
+	template<> struct scalar_code_of<int16_t> : std::integral_constant<scalar_code, scalar_code::int16> {};
+	template<> struct scalar_code_of<uint16_t> : std::integral_constant<scalar_code, scalar_code::uint16> {};
+	template<> struct scalar_code_of<int32_t> : std::integral_constant<scalar_code, scalar_code::int32> {};
+	template<> struct scalar_code_of<uint32_t> : std::integral_constant<scalar_code, scalar_code::uint32> {};
+	template<> struct scalar_code_of<int64_t> : std::integral_constant<scalar_code, scalar_code::int64> {};
+	template<> struct scalar_code_of<uint64_t> : std::integral_constant<scalar_code, scalar_code::uint64> {};
+	template<> struct scalar_code_of<half> : std::integral_constant<scalar_code, scalar_code::float16> {};
+	template<> struct scalar_code_of<unorm8> : std::integral_constant<scalar_code, scalar_code::unorm8> {};
+	template<> struct scalar_code_of<snorm8> : std::integral_constant<scalar_code, scalar_code::snorm8> {};
+	template<> struct scalar_code_of<unorm16> : std::integral_constant<scalar_code, scalar_code::unorm16> {};
+	template<> struct scalar_code_of<snorm16> : std::integral_constant<scalar_code, scalar_code::snorm16> {};
+
+	// Shape of the elements of an array file: a vector is stored as a single column.
+	template<typename V, typename = void>
+	struct array_element_traits;
+	template<typename V>
+	struct array_element_traits<V, typename std::enable_if<is_matrix<V>::value>::type> {
+		using scalar_type = typename V::row_type::value_type;
+		static const uint32_t rows = uint32_t(V::size_value);
+		static const uint32_t columns = uint32_t(V::row_type::size_value);
+	};
+	template<typename V>
+	struct array_element_traits<V, typename std::enable_if<is_vector<V>::value && !is_matrix<V>::value>::type> {
+		using scalar_type = typename V::value_type;
+		static const uint32_t rows = uint32_t(V::size_value);
+		static const uint32_t columns = 1;
+	};
+
+	// Version 1 layout: this 64-byte header in the byte order of the writer, then count
+	// elements of element_size bytes each, starting at data_offset, which is a multiple of both
+	// the element alignment and 64. Elements are stored exactly as they are in memory,
+	// including the padding of the aligned variants.
+	struct array_file_header {
+		static const uint32_t current_version = 1;
+		static const uint32_t byte_order_mark = 0x01020304;
+
+		char magic[8];
+		uint32_t version;
+		uint32_t byte_order;
+		scalar_code scalar;
+		uint32_t rows;
+		uint32_t columns;
+		uint32_t element_size;
+		uint32_t alignment;
+		uint32_t reserved0;
+		uint64_t count;
+		uint64_t data_offset;
+		uint64_t reserved1;
+
+		template<typename V>
+		static array_file_header describe(uint64_t count = 0) {
+			using traits = array_element_traits<V>;
+			array_file_header res{};
+			std::memcpy(res.magic, "MMLARRAY", 8);
+			res.version = current_version;
+			res.byte_order = byte_order_mark;
+			res.scalar = scalar_code_of<typename traits::scalar_type>::value;
+			res.rows = traits::rows;
+			res.columns = traits::columns;
+			res.element_size = uint32_t(sizeof(V));
+			res.alignment = uint32_t(alignof(V));
+			res.count = count;
+			res.data_offset = alignof(V) > 64 ? alignof(V) : 64;
+			return res;
+		}
+		// Throws unless the header is valid and describes elements of type V.
+		template<typename V>
+		void check(uint64_t file_size) const {
+			auto const expected = describe<V>();
+			if (std::memcmp(magic, expected.magic, 8) != 0)
+				throw Exceptions::ArrayFileError("Not an array file.");
+			if (byte_order != byte_order_mark)
+				throw Exceptions::ArrayFileError("Array file was written with a different byte order.");
+			if (version != current_version)
+				throw Exceptions::ArrayFileError("Unsupported array file version " + std::to_string(version) + ".");
+			if (scalar != expected.scalar || rows != expected.rows || columns != expected.columns || element_size != expected.element_size)
+				throw Exceptions::ArrayFileError("Array file elements do not match the requested type.");
+			if (data_offset < sizeof(array_file_header) || data_offset % alignof(V) != 0)
+				throw Exceptions::ArrayFileError("Array file data is misaligned.");
+			if (file_size < data_offset || (file_size - data_offset) / element_size < count)
+				throw Exceptions::ArrayFileError("Array file is truncated.");
+		}
+	};
+	static_assert(sizeof(array_file_header) == 64 && std::is_standard_layout<array_file_header>::value, "The array file header has to be 64 bytes.");
+
+	template<typename V>
+	class array_span {
+	protected:
+		V* pointer;
+		size_t count;
+	public:
+		using value_type = typename std::remove_const<V>::type;
+
+		constexpr array_span() : pointer(nullptr), count(0) {}
+		constexpr array_span(V* pointer, size_t count) : pointer(pointer), count(count) {}
+
+		constexpr V* data() const {
+			return pointer;
+		}
+		constexpr size_t size() const {
+			return count;
+		}
+		constexpr bool empty() const {
+			return count == 0;
+		}
+		constexpr V* begin() const {
+			return pointer;
+		}
+		constexpr V* end() const {
+			return pointer + count;
+		}
+		constexpr V& operator[](size_t index) const noexcept(MML_BOUNDS_NOEXCEPT) {
+			CheckMMLBounds(index < count, ArrayIndexOutOfBounds);
+			return pointer[index];
+		}
+		constexpr array_span subspan(size_t first, size_t length) const noexcept(MML_BOUNDS_NOEXCEPT) {
+			CheckMMLBounds(first <= count && length <= count - first, ArrayIndexOutOfBounds);
+			return array_span(pointer + first, length);
+		}
+	};
+
+	// Appends elements in chunks of any size, so arrays larger than memory can be written. The
+	// element count in the header is only filled in by close(), so an interrupted write leaves
+	// a valid, empty file.
+	template<typename V>
+	class array_writer {
+		static_assert(std::is_standard_layout<V>::value, "Array elements have to be standard layout.");
+	protected:
+		std::FILE* file;
+		array_file_header header;
+
+		void write_bytes(void const* bytes, size_t size) {
+			if (size && std::fwrite(bytes, 1, size, file) != size)
+				throw Exceptions::ArrayFileError("Writing the array file failed.");
+		}
+	public:
+		explicit array_writer(std::string const& path) : file(std::fopen(path.c_str(), "wb")), header(array_file_header::describe<V>()) {
+			if (!file)
+				throw Exceptions::ArrayFileError("Cannot create " + path + ".");
+			char const zeros[64] = {};
+			write_bytes(&header, sizeof(header));
+			for (size_t offset = sizeof(header); offset < header.data_offset; offset += sizeof(zeros))
+				write_bytes(zeros, std::min<size_t>(sizeof(zeros), size_t(header.data_offset) - offset));
+		}
+		array_writer(array_writer const&) = delete;
+		array_writer& operator=(array_writer const&) = delete;
+		~array_writer() {
+			if (file) {
+				try {
+					close();
+				} catch (...) {}
+			}
+		}
+
+		void write(V const* elements, size_t count) {
+			write_bytes(elements, count * sizeof(V));
+			header.count += count;
+		}
+		void write(V const& element) {
+			write(&element, 1);
+		}
+		void write(array_span<V const> elements) {
+			write(elements.data(), elements.size());
+		}
+		uint64_t size() const {
+			return header.count;
+		}
+
+		// Does nothing once the file is closed.
+		void close() {
+			if (!file)
+				return;
+			std::FILE* const f = file;
+			file = nullptr;
+			bool const ok = std::fseek(f, 0, SEEK_SET) == 0 && std::fwrite(&header, sizeof(header), 1, f) == 1;
+			if (std::fclose(f) != 0 || !ok)
+				throw Exceptions::ArrayFileError("Finishing the array file failed.");
+		}
+	};
+
+	// Maps an array file read-only and exposes its elements in place, without copying them.
+	template<typename V>
+	class mapped_array {
+		static_assert(std::is_standard_layout<V>::value, "Array elements have to be standard layout.");
+	protected:
+		void const* mapping;
+		uint64_t mapped_size;
+		array_file_header header_data;
+#if defined(_WIN32)
+		HANDLE file_handle;
+		HANDLE mapping_handle;
+#endif
+
+		void unmap() {
+#if defined(_WIN32)
+			if (mapping)
+				UnmapViewOfFile(mapping);
+			if (mapping_handle)
+				CloseHandle(mapping_handle);
+			if (file_handle != INVALID_HANDLE_VALUE)
+				CloseHandle(file_handle);
+			mapping_handle = nullptr;
+			file_handle = INVALID_HANDLE_VALUE;
+#else
+			if (mapping)
+				munmap(const_cast<void*>(mapping), size_t(mapped_size));
+#endif
+			mapping = nullptr;
+			mapped_size = 0;
+		}
+		void map(std::string const& path) {
+#if defined(_WIN32)
+			file_handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			LARGE_INTEGER size;
+			if (file_handle == INVALID_HANDLE_VALUE || !GetFileSizeEx(file_handle, &size))
+				throw Exceptions::ArrayFileError("Cannot open " + path + ".");
+			mapped_size = uint64_t(size.QuadPart);
+			if (mapped_size < sizeof(array_file_header))
+				throw Exceptions::ArrayFileError(path + " is not an array file.");
+			mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mapping_handle)
+				mapping = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+			if (!mapping)
+				throw Exceptions::ArrayFileError("Cannot map " + path + ".");
+#else
+			int const descriptor = open(path.c_str(), O_RDONLY);
+			struct stat status;
+			if (descriptor < 0 || fstat(descriptor, &status) != 0) {
+				if (descriptor >= 0)
+					::close(descriptor);
+				throw Exceptions::ArrayFileError("Cannot open " + path + ".");
+			}
+			if (uint64_t(status.st_size) < sizeof(array_file_header)) {
+				::close(descriptor);
+				throw Exceptions::ArrayFileError(path + " is not an array file.");
+			}
+			void* const address = mmap(nullptr, size_t(status.st_size), PROT_READ, MAP_SHARED, descriptor, 0);
+			::close(descriptor);
+			if (address == MAP_FAILED)
+				throw Exceptions::ArrayFileError("Cannot map " + path + ".");
+			mapping = address;
+			mapped_size = uint64_t(status.st_size);
+#endif
+		}
+	public:
+		explicit mapped_array(std::string const& path) : mapping(nullptr), mapped_size(0), header_data{}
+#if defined(_WIN32)
+			, file_handle(INVALID_HANDLE_VALUE), mapping_handle(nullptr)
+#endif
+		{
+			try {
+				map(path);
+				std::memcpy(&header_data, mapping, sizeof(header_data));
+				header_data.template check<V>(mapped_size);
+			} catch (...) {
+				unmap();
+				throw;
+			}
+		}
+		mapped_array(mapped_array const&) = delete;
+		mapped_array& operator=(mapped_array const&) = delete;
+		~mapped_array() {
+			unmap();
+		}
+
+		array_file_header const& header() const {
+			return header_data;
+		}
+		size_t size() const {
+			return size_t(header_data.count);
+		}
+		V const* data() const {
+			return reinterpret_cast<V const*>(static_cast<char const*>(mapping) + header_data.data_offset);
+		}
+		V const* begin() const {
+			return data();
+		}
+		V const* end() const {
+			return data() + size();
+		}
+		V const& operator[](size_t index) const noexcept(MML_BOUNDS_NOEXCEPT) {
+			CheckMMLBounds(index < size(), ArrayIndexOutOfBounds);
+			return data()[index];
+		}
+		array_span<V const> span() const {
+			return array_span<V const>(data(), size());
+		}
+		array_span<V const> span(size_t first, size_t count) const {
+			return span().subspan(first, count);
+		}
+	};
+
+	template<typename V>
+	void write_array(std::string const& path, V const* elements, size_t count) {
+		array_writer<V> writer(path);
+		writer.write(elements, count);
+		writer.close();
+	}
+}
\ No newline at end of file
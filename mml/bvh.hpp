@@ -0,0 +1,374 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "mml/aligned.hpp"
+#include "mml/geometry.hpp"
+#include "mml/parallel.hpp"
+
+#include "mml/exceptions.hpp"
+DefineNewMMLException(BVHTooManyPrimitives);
+
+namespace mml {
+	// Bounding volume hierarchy over points (basic_vector<T, 3>), spheres or triangles, or any
+	// primitive with bounds() and squared_distance() overloads, and intersect() for ray casts.
+	// It is built top-down with a binned surface area heuristic; subtrees of more than
+	// parallel_grain primitives are built by the pool. The nodes form one flat array in which
+	// the two children of a node are adjacent, so both of their boxes share a cache line for
+	// float trees. The primitives are copied in leaf order and queries return the index of a
+	// primitive in the input array.
+	template<typename P>
+	class basic_bvh {
+	public:
+		using primitive_type = P;
+		using box_type = decltype(bounds(std::declval<P const&>()));
+		using value_type = typename box_type::value_type;
+		using vector_type = basic_vector<value_type, 3>;
+		static const size_t npos = size_t(-1);
+		static const size_t bins = 16;
+		static const size_t parallel_grain = 4096;
+
+		// Leaves have a non-zero count of primitives starting at offset; interior nodes have
+		// their children at offset and offset + 1.
+		struct alignas(sizeof(value_type) * 8) node {
+			box_type bounds;
+			uint32_t offset;
+			uint32_t count;
+
+			bool leaf() const {
+				return count != 0;
+			}
+		};
+		static_assert(64 % sizeof(node) == 0 || sizeof(node) == 64, "Nodes have to tile cache lines.");
+
+		// Ray hits and neighbours: the input index of the primitive and its distance, along the
+		// ray or from the query point. index is npos when there is none.
+		struct hit {
+			size_t index;
+			value_type distance;
+
+			explicit operator bool() const {
+				return index != npos;
+			}
+		};
+	protected:
+		using T = value_type;
+		// Deep enough for the depth limit of build(), after which ranges are halved.
+		static const size_t stack_size = 128;
+		static const size_t sah_depth = 64;
+
+		aligned_buffer<node> nodes;
+		std::vector<P> primitives;
+		std::vector<uint32_t> indices;
+		size_t leaf_size = 4;
+
+		struct build_state {
+			std::vector<box_type> boxes;
+			std::vector<vector_type> centroids;
+			std::atomic<size_t> next;
+			thread_pool& pool;
+
+			explicit build_state(thread_pool& pool) : pool(pool) {}
+		};
+
+		static T half_area(box_type const& box) {
+			vector_type const e = box.maximum() - box.minimum();
+			return e.element(0) * e.element(1) + e.element(1) * e.element(2) + e.element(2) * e.element(0);
+		}
+
+		// Returns the end of the left half of [first, last), which is never empty.
+		size_t split(size_t first, size_t last, box_type const& centroid_bounds, size_t depth, build_state& s) {
+			vector_type const lower = centroid_bounds.minimum(), extent = centroid_bounds.maximum() - centroid_bounds.minimum();
+			size_t axis = 0;
+			for (size_t k = 1; k < 3; k++)
+				if (extent.element(k) > extent.element(axis))
+					axis = k;
+			auto const median = [&] {
+				size_t const middle = first + (last - first) / 2;
+				if (extent.element(axis) > T(0))
+					std::nth_element(indices.begin() + first, indices.begin() + middle, indices.begin() + last,
+						[&](uint32_t a, uint32_t b) { return s.centroids[a].element(axis) < s.centroids[b].element(axis); });
+				return middle;
+			};
+			if (depth >= sah_depth || !(extent.element(axis) > T(0)))
+				return median();
+
+			T best_cost = std::numeric_limits<T>::max();
+			size_t best_axis = 0, best_bin = 0;
+			for (size_t k = 0; k < 3; k++) {
+				if (!(extent.element(k) > T(0)))
+					continue;
+				T const scale = T(bins) * (T(1) - T(1e-4)) / extent.element(k);
+				box_type boxes[bins];
+				size_t counts[bins] = {};
+				for (size_t i = first; i < last; i++) {
+					size_t const b = std::min(size_t((s.centroids[indices[i]].element(k) - lower.element(k)) * scale), bins - 1);
+					counts[b]++;
+					boxes[b].expand(s.boxes[indices[i]]);
+				}
+				T right_areas[bins];
+				size_t right_counts[bins];
+				box_type right;
+				size_t right_count = 0;
+				for (size_t b = bins; b-- > 1;) {
+					right.expand(boxes[b]);
+					right_count += counts[b];
+					right_areas[b] = right_count ? half_area(right) : T(0);
+					right_counts[b] = right_count;
+				}
+				box_type left;
+				size_t left_count = 0;
+				for (size_t b = 1; b < bins; b++) {
+					left.expand(boxes[b - 1]);
+					left_count += counts[b - 1];
+					if (!left_count || !right_counts[b])
+						continue;
+					T const cost = T(left_count) * half_area(left) + T(right_counts[b]) * right_areas[b];
+					if (cost < best_cost) {
+						best_cost = cost;
+						best_axis = k;
+						best_bin = b;
+					}
+				}
+			}
+			if (best_bin == 0)
+				return median();
+			T const scale = T(bins) * (T(1) - T(1e-4)) / extent.element(best_axis);
+			auto const middle = std::partition(indices.begin() + first, indices.begin() + last, [&](uint32_t i) {
+				return std::min(size_t((s.centroids[i].element(best_axis) - lower.element(best_axis)) * scale), bins - 1) < best_bin;
+			});
+			return size_t(middle - indices.begin());
+		}
+		void build_node(size_t index, size_t first, size_t last, size_t depth, build_state& s) {
+			box_type box, centroid_bounds;
+			for (size_t i = first; i < last; i++) {
+				box.expand(s.boxes[indices[i]]);
+				centroid_bounds.expand(s.centroids[indices[i]]);
+			}
+			node& n = nodes[index];
+			n.bounds = box;
+			if (last - first <= leaf_size) {
+				n.offset = uint32_t(first);
+				n.count = uint32_t(last - first);
+				return;
+			}
+			size_t const middle = split(first, last, centroid_bounds, depth, s);
+			size_t const child = s.next.fetch_add(2);
+			n.offset = uint32_t(child);
+			n.count = 0;
+			if (last - first > parallel_grain && s.pool.size() > 1)
+				s.pool.parallel_for(2, 1, [&](size_t c, size_t) {
+					if (c == 0)
+						build_node(child, first, middle, depth + 1, s);
+					else
+						build_node(child + 1, middle, last, depth + 1, s);
+				});
+			else {
+				build_node(child, first, middle, depth + 1, s);
+				build_node(child + 1, middle, last, depth + 1, s);
+			}
+		}
+
+		// Entry distance of the ray into the box within [0, limit], or infinity. Zero direction
+		// components produce NaNs on the slabs, which the comparisons ignore. Hits are only
+		// taken strictly before the current distance, so boxes entered at it are skipped too.
+		static T entry(box_type const& box, basic_ray<T> const& ray, vector_type const& inverse, T limit) {
+			T start = T(0), stop = limit;
+			for (size_t k = 0; k < 3; k++) {
+				T t0 = (box.minimum().element(k) - ray.origin.element(k)) * inverse.element(k);
+				T t1 = (box.maximum().element(k) - ray.origin.element(k)) * inverse.element(k);
+				if (t0 > t1)
+					std::swap(t0, t1);
+				start = t0 > start ? t0 : start;
+				stop = t1 < stop ? t1 : stop;
+			}
+			return start <= stop ? start : std::numeric_limits<T>::infinity();
+		}
+	public:
+		basic_bvh() {}
+		basic_bvh(P const* input, size_t count, size_t leaf_size = 4, thread_pool& pool = default_thread_pool()) {
+			build(input, count, leaf_size, pool);
+		}
+		explicit basic_bvh(std::vector<P> const& input, size_t leaf_size = 4, thread_pool& pool = default_thread_pool()) {
+			build(input.data(), input.size(), leaf_size, pool);
+		}
+
+		void build(P const* input, size_t count, size_t leaf_size = 4, thread_pool& pool = default_thread_pool()) {
+			if (count >= size_t(std::numeric_limits<uint32_t>::max()))
+				throw Exceptions::BVHTooManyPrimitives("Node offsets are 32 bit.");
+			this->leaf_size = std::max<size_t>(leaf_size, 1);
+			build_state s(pool);
+			s.boxes.resize(count);
+			s.centroids.resize(count);
+			indices.resize(count);
+			pool.parallel_for(count, default_chunk_size<box_type>(), [&](size_t first, size_t last) {
+				for (size_t i = first; i < last; i++) {
+					s.boxes[i] = bounds(input[i]);
+					s.centroids[i] = s.boxes[i].center();
+					indices[i] = uint32_t(i);
+				}
+			});
+			// The root is alone in the first pair, so every later pair starts a cache line.
+			nodes.assign(std::max<size_t>(count * 2, 2), node());
+			s.next = 2;
+			if (count)
+				build_node(0, 0, count, 0, s);
+			else
+				nodes[0].count = 0;
+			nodes.resize(count ? s.next.load() : 1);
+			primitives.resize(count);
+			pool.parallel_for(count, default_chunk_size<P>(), [&](size_t first, size_t last) {
+				for (size_t i = first; i < last; i++)
+					primitives[i] = input[indices[i]];
+			});
+		}
+
+		size_t size() const {
+			return primitives.size();
+		}
+		bool empty() const {
+			return primitives.empty();
+		}
+		size_t node_count() const {
+			return nodes.size();
+		}
+		node const* data() const {
+			return nodes.data();
+		}
+		box_type bounding_box() const {
+			return empty() ? box_type() : nodes[0].bounds;
+		}
+
+		// The closest primitive the ray hits before max_distance.
+		hit cast(basic_ray<T> const& ray, T max_distance = std::numeric_limits<T>::infinity()) const {
+			hit res{npos, max_distance};
+			if (empty())
+				return res;
+			vector_type inverse;
+			for (size_t k = 0; k < 3; k++)
+				inverse.element(k) = T(1) / ray.direction.element(k);
+			std::pair<uint32_t, T> stack[stack_size];
+			size_t top = 0;
+			T const root = entry(nodes[0].bounds, ray, inverse, max_distance);
+			if (root < max_distance)
+				stack[top++] = {0, root};
+			while (top) {
+				auto const [index, start] = stack[--top];
+				if (start >= res.distance)
+					continue;
+				node const& n = nodes[index];
+				if (n.leaf()) {
+					for (size_t i = n.offset; i < n.offset + n.count; i++) {
+						T const t = intersect(ray, primitives[i]);
+						if (t < res.distance) {
+							res.distance = t;
+							res.index = indices[i];
+						}
+					}
+					continue;
+				}
+				T const t0 = entry(nodes[n.offset].bounds, ray, inverse, res.distance);
+				T const t1 = entry(nodes[n.offset + 1].bounds, ray, inverse, res.distance);
+				bool const swap = t1 < t0;
+				std::pair<uint32_t, T> const first{n.offset + (swap ? 1 : 0), swap ? t1 : t0}, second{n.offset + (swap ? 0 : 1), swap ? t0 : t1};
+				if (second.second < res.distance)
+					stack[top++] = second;
+				if (first.second < res.distance)
+					stack[top++] = first;
+			}
+			if (res.index == npos)
+				res.distance = max_distance;
+			return res;
+		}
+
+		// Appends the input indices of all primitives within radius of center, in tree order.
+		void within(vector_type const& center, T radius, std::vector<size_t>& out) const {
+			if (empty())
+				return;
+			T const limit = radius * radius;
+			uint32_t stack[stack_size];
+			size_t top = 0;
+			stack[top++] = 0;
+			while (top) {
+				node const& n = nodes[stack[--top]];
+				if (squared_distance(center, n.bounds) > limit)
+					continue;
+				if (n.leaf()) {
+					for (size_t i = n.offset; i < n.offset + n.count; i++)
+						if (squared_distance(center, primitives[i]) <= limit)
+							out.push_back(indices[i]);
+				} else {
+					stack[top++] = n.offset + 1;
+					stack[top++] = n.offset;
+				}
+			}
+		}
+		std::vector<size_t> within(vector_type const& center, T radius) const {
+			std::vector<size_t> res;
+			within(center, radius, res);
+			return res;
+		}
+
+		// The k primitives closest to point within max_distance, nearest first. Nodes are
+		// visited nearest child first and skipped once they are farther than the k-th hit.
+		void nearest(vector_type const& point, size_t k, std::vector<hit>& out, T max_distance = std::numeric_limits<T>::infinity()) const {
+			out.clear();
+			if (empty() || k == 0)
+				return;
+			auto const farther = [](hit const& a, hit const& b) { return a.distance < b.distance; };
+			T limit = max_distance * max_distance;
+			std::pair<uint32_t, T> stack[stack_size];
+			size_t top = 0;
+			stack[top++] = {0, squared_distance(point, nodes[0].bounds)};
+			while (top) {
+				auto const [index, d] = stack[--top];
+				if (d > limit)
+					continue;
+				node const& n = nodes[index];
+				if (n.leaf()) {
+					for (size_t i = n.offset; i < n.offset + n.count; i++) {
+						T const distance = squared_distance(point, primitives[i]);
+						if (distance > limit || (out.size() == k && distance >= limit))
+							continue;
+						if (out.size() == k) {
+							std::pop_heap(out.begin(), out.end(), farther);
+							out.back() = {indices[i], distance};
+						} else
+							out.push_back({indices[i], distance});
+						std::push_heap(out.begin(), out.end(), farther);
+						if (out.size() == k)
+							limit = out.front().distance;
+					}
+					continue;
+				}
+				T const d0 = squared_distance(point, nodes[n.offset].bounds);
+				T const d1 = squared_distance(point, nodes[n.offset + 1].bounds);
+				bool const swap = d1 < d0;
+				std::pair<uint32_t, T> const first{n.offset + (swap ? 1 : 0), swap ? d1 : d0}, second{n.offset + (swap ? 0 : 1), swap ? d0 : d1};
+				if (second.second <= limit)
+					stack[top++] = second;
+				if (first.second <= limit)
+					stack[top++] = first;
+			}
+			std::sort_heap(out.begin(), out.end(), farther);
+			for (auto& h : out)
+				h.distance = T(std::sqrt(h.distance));
+		}
+		std::vector<hit> nearest(vector_type const& point, size_t k, T max_distance = std::numeric_limits<T>::infinity()) const {
+			std::vector<hit> res;
+			nearest(point, k, res, max_distance);
+			return res;
+		}
+	};
+
+	class point_bvh3f : public basic_bvh<basic_vector<float, 3>> { public: using basic_bvh::basic_bvh; };
+	class point_bvh3d : public basic_bvh<basic_vector<double, 3>> { public: using basic_bvh::basic_bvh; };
+	class sphere_bvh3f : public basic_bvh<basic_sphere<float>> { public: using basic_bvh::basic_bvh; };
+	class sphere_bvh3d : public basic_bvh<basic_sphere<double>> { public: using basic_bvh::basic_bvh; };
+	class triangle_bvh3f : public basic_bvh<basic_triangle<float>> { public: using basic_bvh::basic_bvh; };
+	class triangle_bvh3d : public basic_bvh<basic_triangle<double>> { public: using basic_bvh::basic_bvh; };
+}
\ No newline at end of file
@@ -0,0 +1,289 @@
+#pragma once
+#include "mml/matrix.hpp"
+
+#include "mml/exceptions.hpp"
+DefineNewMMLException(MatrixNotPositiveDefinite);
+
+namespace mml {
+	// P A = L U with partial pivoting. L (with a unit diagonal) and U share one matrix, and
+	// row i of P A is row permutation(i) of A. The factorization can be reused for any
+	// number of right-hand sides.
+	template<typename T, size_t S>
+	class lu_decomposition {
+		static_assert(std::is_floating_point<T>::value, "Only floating point matrices can be decomposed.");
+	protected:
+		basic_matrix<T, S, S> factors;
+		size_t order[S];
+		bool odd;
+	public:
+		constexpr lu_decomposition(basic_matrix<T, S, S> const& m) : factors(m), order{}, odd(false) {
+			for (size_t i = 0; i < S; i++)
+				order[i] = i;
+			for (size_t k = 0; k < S; k++) {
+				size_t p = k;
+				for (size_t r = k + 1; r < S; r++)
+					if (math::abs(factors.element(r, k)) > math::abs(factors.element(p, k)))
+						p = r;
+				if (factors.element(p, k) == T(0))
+					throw Exceptions::MatrixIsSingular("Matrix is not invertible.");
+				if (p != k) {
+					for (size_t c = 0; c < S; c++) {
+						T const t = factors.element(k, c);
+						factors.element(k, c) = factors.element(p, c);
+						factors.element(p, c) = t;
+					}
+					size_t const t = order[k];
+					order[k] = order[p];
+					order[p] = t;
+					odd = !odd;
+				}
+				for (size_t r = k + 1; r < S; r++) {
+					T const f = factors.element(r, k) /= factors.element(k, k);
+					for (size_t c = k + 1; c < S; c++)
+						factors.element(r, c) -= f * factors.element(k, c);
+				}
+			}
+		}
+
+		constexpr basic_matrix<T, S, S> const& packed() const {
+			return factors;
+		}
+		constexpr size_t permutation(size_t i) const {
+			return order[i];
+		}
+		constexpr basic_matrix<T, S, S> lower() const {
+			basic_matrix<T, S, S> res;
+			for (size_t r = 1; r < S; r++)
+				for (size_t c = 0; c < r; c++)
+					res.element(r, c) = factors.element(r, c);
+			return res;
+		}
+		constexpr basic_matrix<T, S, S> upper() const {
+			basic_matrix<T, S, S> res(ZeroMatrix);
+			for (size_t r = 0; r < S; r++)
+				for (size_t c = r; c < S; c++)
+					res.element(r, c) = factors.element(r, c);
+			return res;
+		}
+		constexpr T determinant() const {
+			T res = odd ? T(-1) : T(1);
+			for (size_t i = 0; i < S; i++)
+				res *= factors.element(i, i);
+			return res;
+		}
+
+		template<size_t C>
+		constexpr basic_matrix<T, S, C> solve(basic_matrix<T, S, C> const& b) const {
+			basic_matrix<T, S, C> x(ZeroMatrix);
+			for (size_t r = 0; r < S; r++)
+				for (size_t c = 0; c < C; c++)
+					x.element(r, c) = b.element(order[r], c);
+			for (size_t r = 1; r < S; r++)
+				for (size_t k = 0; k < r; k++)
+					for (size_t c = 0; c < C; c++)
+						x.element(r, c) -= factors.element(r, k) * x.element(k, c);
+			for (size_t r = S; r-- > 0;) {
+				for (size_t k = r + 1; k < S; k++)
+					for (size_t c = 0; c < C; c++)
+						x.element(r, c) -= factors.element(r, k) * x.element(k, c);
+				for (size_t c = 0; c < C; c++)
+					x.element(r, c) /= factors.element(r, r);
+			}
+			return x;
+		}
+		constexpr basic_vector<T, S> solve(basic_vector<T, S> const& b) const {
+			basic_matrix<T, S, 1> column(ZeroMatrix);
+			for (size_t i = 0; i < S; i++)
+				column.element(i, 0) = b.element(i);
+			auto x = solve(column);
+			basic_vector<T, S> res;
+			for (size_t i = 0; i < S; i++)
+				res.element(i) = x.element(i, 0);
+			return res;
+		}
+		constexpr basic_matrix<T, S, S> inverse() const {
+			return solve(basic_matrix<T, S, S>(IdentityMatrix));
+		}
+	};
+
+	// A = Q R by Householder reflections, for R >= C. R is stored on and above the diagonal and
+	// the reflectors below it, each with an implicit leading one. solve() returns the least
+	// squares solution of overdetermined systems.
+	template<typename T, size_t R, size_t C>
+	class qr_decomposition {
+		static_assert(std::is_floating_point<T>::value, "Only floating point matrices can be decomposed.");
+		static_assert(R >= C, "QR decomposition needs at least as many rows as columns.");
+	protected:
+		basic_matrix<T, R, C> factors;
+		T tau[C];
+	public:
+		constexpr qr_decomposition(basic_matrix<T, R, C> const& m) : factors(m), tau{} {
+			for (size_t k = 0; k < C; k++) {
+				T const alpha = factors.element(k, k);
+				T sigma = T(0);
+				for (size_t r = k + 1; r < R; r++)
+					sigma += factors.element(r, k) * factors.element(r, k);
+				if (sigma == T(0))
+					continue;
+				T const norm = math::sqrt(alpha * alpha + sigma);
+				T const beta = alpha > T(0) ? -norm : norm;
+				tau[k] = (beta - alpha) / beta;
+				T const f = T(1) / (alpha - beta);
+				for (size_t r = k + 1; r < R; r++)
+					factors.element(r, k) *= f;
+				factors.element(k, k) = beta;
+				for (size_t c = k + 1; c < C; c++) {
+					T s = factors.element(k, c);
+					for (size_t r = k + 1; r < R; r++)
+						s += factors.element(r, k) * factors.element(r, c);
+					s *= tau[k];
+					factors.element(k, c) -= s;
+					for (size_t r = k + 1; r < R; r++)
+						factors.element(r, c) -= s * factors.element(r, k);
+				}
+			}
+		}
+
+		constexpr basic_matrix<T, R, C> const& packed() const {
+			return factors;
+		}
+		// Applies Q^T to the columns of b.
+		template<size_t C_O>
+		constexpr basic_matrix<T, R, C_O> transposed_q_times(basic_matrix<T, R, C_O> b) const {
+			for (size_t k = 0; k < C; k++) {
+				if (tau[k] == T(0))
+					continue;
+				for (size_t c = 0; c < C_O; c++) {
+					T s = b.element(k, c);
+					for (size_t r = k + 1; r < R; r++)
+						s += factors.element(r, k) * b.element(r, c);
+					s *= tau[k];
+					b.element(k, c) -= s;
+					for (size_t r = k + 1; r < R; r++)
+						b.element(r, c) -= s * factors.element(r, k);
+				}
+			}
+			return b;
+		}
+		constexpr basic_matrix<T, R, R> q() const {
+			basic_matrix<T, R, R> res;
+			for (size_t k = C; k-- > 0;) {
+				if (tau[k] == T(0))
+					continue;
+				for (size_t c = k; c < R; c++) {
+					T s = res.element(k, c);
+					for (size_t r = k + 1; r < R; r++)
+						s += factors.element(r, k) * res.element(r, c);
+					s *= tau[k];
+					res.element(k, c) -= s;
+					for (size_t r = k + 1; r < R; r++)
+						res.element(r, c) -= s * factors.element(r, k);
+				}
+			}
+			return res;
+		}
+		constexpr basic_matrix<T, C, C> r() const {
+			basic_matrix<T, C, C> res(ZeroMatrix);
+			for (size_t i = 0; i < C; i++)
+				for (size_t j = i; j < C; j++)
+					res.element(i, j) = factors.element(i, j);
+			return res;
+		}
+
+		template<size_t C_O>
+		constexpr basic_matrix<T, C, C_O> solve(basic_matrix<T, R, C_O> const& b) const {
+			auto const y = transposed_q_times(b);
+			basic_matrix<T, C, C_O> x(ZeroMatrix);
+			for (size_t i = C; i-- > 0;) {
+				if (factors.element(i, i) == T(0))
+					throw Exceptions::MatrixIsSingular("Matrix does not have full column rank.");
+				for (size_t c = 0; c < C_O; c++) {
+					T s = y.element(i, c);
+					for (size_t k = i + 1; k < C; k++)
+						s -= factors.element(i, k) * x.element(k, c);
+					x.element(i, c) = s / factors.element(i, i);
+				}
+			}
+			return x;
+		}
+		constexpr basic_vector<T, C> solve(basic_vector<T, R> const& b) const {
+			basic_matrix<T, R, 1> column(ZeroMatrix);
+			for (size_t i = 0; i < R; i++)
+				column.element(i, 0) = b.element(i);
+			auto x = solve(column);
+			basic_vector<T, C> res;
+			for (size_t i = 0; i < C; i++)
+				res.element(i) = x.element(i, 0);
+			return res;
+		}
+	};
+
+	// A = L L^T for symmetric positive definite A. Only the lower triangle of A is read.
+	template<typename T, size_t S>
+	class cholesky_decomposition {
+		static_assert(std::is_floating_point<T>::value, "Only floating point matrices can be decomposed.");
+	protected:
+		basic_matrix<T, S, S> factor;
+	public:
+		constexpr cholesky_decomposition(basic_matrix<T, S, S> const& m) : factor(ZeroMatrix) {
+			for (size_t j = 0; j < S; j++) {
+				T d = m.element(j, j);
+				for (size_t k = 0; k < j; k++)
+					d -= factor.element(j, k) * factor.element(j, k);
+				if (!(d > T(0)))
+					throw Exceptions::MatrixNotPositiveDefinite("Matrix is not positive definite.");
+				T const l = math::sqrt(d);
+				factor.element(j, j) = l;
+				for (size_t r = j + 1; r < S; r++) {
+					T s = m.element(r, j);
+					for (size_t k = 0; k < j; k++)
+						s -= factor.element(r, k) * factor.element(j, k);
+					factor.element(r, j) = s / l;
+				}
+			}
+		}
+
+		constexpr basic_matrix<T, S, S> const& lower() const {
+			return factor;
+		}
+		constexpr T determinant() const {
+			T res = T(1);
+			for (size_t i = 0; i < S; i++)
+				res *= factor.element(i, i);
+			return res * res;
+		}
+
+		template<size_t C>
+		constexpr basic_matrix<T, S, C> solve(basic_matrix<T, S, C> const& b) const {
+			basic_matrix<T, S, C> x(b);
+			for (size_t r = 0; r < S; r++) {
+				for (size_t k = 0; k < r; k++)
+					for (size_t c = 0; c < C; c++)
+						x.element(r, c) -= factor.element(r, k) * x.element(k, c);
+				for (size_t c = 0; c < C; c++)
+					x.element(r, c) /= factor.element(r, r);
+			}
+			for (size_t r = S; r-- > 0;) {
+				for (size_t k = r + 1; k < S; k++)
+					for (size_t c = 0; c < C; c++)
+						x.element(r, c) -= factor.element(k, r) * x.element(k, c);
+				for (size_t c = 0; c < C; c++)
+					x.element(r, c) /= factor.element(r, r);
+			}
+			return x;
+		}
+		constexpr basic_vector<T, S> solve(basic_vector<T, S> const& b) const {
+			basic_matrix<T, S, 1> column(ZeroMatrix);
+			for (size_t i = 0; i < S; i++)
+				column.element(i, 0) = b.element(i);
+			auto x = solve(column);
+			basic_vector<T, S> res;
+			for (size_t i = 0; i < S; i++)
+				res.element(i) = x.element(i, 0);
+			return res;
+		}
+		constexpr basic_matrix<T, S, S> inverse() const {
+			return solve(basic_matrix<T, S, S>(IdentityMatrix));
+		}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,381 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+
+#include "mml/decomposition.hpp"
+#include "mml/dynamic_matrix.hpp"
+
+namespace mml {
+	// Blocked triangular solves on strided blocks. Each diagonal block is solved directly and
+	// the rows below it are updated with one multiply_add, so most of the work runs in the
+	// packed product kernel.
+	template<typename T>
+	struct triangular_kernel {
+		static const size_t block = 64;
+
+		// Solves L X = B in place, L being the lower triangle of the n x n block f and X n x m.
+		static void solve_lower(bool unit, size_t n, size_t m, T const* f, size_t frs, size_t fcs, T* x, size_t xrs, size_t xcs, thread_pool& pool) {
+			for (size_t k0 = 0; k0 < n; k0 += block) {
+				size_t const k1 = std::min(n, k0 + block);
+				for (size_t i = k0; i < k1; i++) {
+					for (size_t j = k0; j < i; j++) {
+						T const l = f[i * frs + j * fcs];
+						if (l != T(0))
+							for (size_t c = 0; c < m; c++)
+								x[i * xrs + c * xcs] -= l * x[j * xrs + c * xcs];
+					}
+					if (!unit)
+						for (size_t c = 0; c < m; c++)
+							x[i * xrs + c * xcs] /= f[i * frs + i * fcs];
+				}
+				multiply_add(n - k1, m, k1 - k0, T(-1), f + k1 * frs + k0 * fcs, frs, fcs, x + k0 * xrs, xrs, xcs, x + k1 * xrs, xrs, xcs, pool);
+			}
+		}
+		// Solves U X = B in place, U being the upper triangle of the n x n block f and X n x m.
+		static void solve_upper(bool unit, size_t n, size_t m, T const* f, size_t frs, size_t fcs, T* x, size_t xrs, size_t xcs, thread_pool& pool) {
+			for (size_t k1 = n; k1 > 0;) {
+				size_t const k0 = k1 > block ? k1 - block : 0;
+				for (size_t i = k1; i-- > k0;) {
+					for (size_t j = i + 1; j < k1; j++) {
+						T const u = f[i * frs + j * fcs];
+						if (u != T(0))
+							for (size_t c = 0; c < m; c++)
+								x[i * xrs + c * xcs] -= u * x[j * xrs + c * xcs];
+					}
+					if (!unit)
+						for (size_t c = 0; c < m; c++)
+							x[i * xrs + c * xcs] /= f[i * frs + i * fcs];
+				}
+				multiply_add(k0, m, k1 - k0, T(-1), f + k0 * fcs, frs, fcs, x + k0 * xrs, xrs, xcs, x, xrs, xcs, pool);
+				k1 = k0;
+			}
+		}
+	};
+
+	// Runtime-sized counterpart of lu_decomposition. The matrix is factorized in place, so
+	// passing an rvalue avoids the copy. Panels of triangular_kernel<T>::block columns are
+	// factorized directly and the trailing matrix is updated by multiply_add.
+	template<typename T>
+	class dynamic_lu {
+		static_assert(std::is_floating_point<T>::value, "Only floating point matrices can be decomposed.");
+		using K = triangular_kernel<T>;
+	protected:
+		dynamic_matrix<T> factors;
+		std::vector<size_t> order;
+		bool odd;
+	public:
+		explicit dynamic_lu(dynamic_matrix<T> m, thread_pool& pool = default_thread_pool()) : factors(std::move(m)), order(factors.rows()), odd(false) {
+			size_t const n = factors.rows();
+			if (factors.columns() != n)
+				throw Exceptions::MatrixSizeMismatch("Only square matrices have an LU decomposition.");
+			for (size_t i = 0; i < n; i++)
+				order[i] = i;
+			size_t const rs = factors.row_stride(), cs = factors.column_stride();
+			T* a = factors.begin();
+			for (size_t k0 = 0; k0 < n; k0 += K::block) {
+				size_t const k1 = std::min(n, k0 + K::block);
+				for (size_t k = k0; k < k1; k++) {
+					size_t p = k;
+					for (size_t r = k + 1; r < n; r++)
+						if (math::abs(a[r * rs + k * cs]) > math::abs(a[p * rs + k * cs]))
+							p = r;
+					if (a[p * rs + k * cs] == T(0))
+						throw Exceptions::MatrixIsSingular("Matrix is not invertible.");
+					if (p != k) {
+						for (size_t c = 0; c < n; c++)
+							std::swap(a[k * rs + c * cs], a[p * rs + c * cs]);
+						std::swap(order[k], order[p]);
+						odd = !odd;
+					}
+					for (size_t r = k + 1; r < n; r++) {
+						T const f = a[r * rs + k * cs] /= a[k * rs + k * cs];
+						if (f != T(0))
+							for (size_t c = k + 1; c < k1; c++)
+								a[r * rs + c * cs] -= f * a[k * rs + c * cs];
+					}
+				}
+				if (k1 < n) {
+					K::solve_lower(true, k1 - k0, n - k1, a + k0 * rs + k0 * cs, rs, cs, a + k0 * rs + k1 * cs, rs, cs, pool);
+					multiply_add(n - k1, n - k1, k1 - k0, T(-1), a + k1 * rs + k0 * cs, rs, cs, a + k0 * rs + k1 * cs, rs, cs, a + k1 * rs + k1 * cs, rs, cs, pool);
+				}
+			}
+		}
+
+		size_t size() const {
+			return factors.rows();
+		}
+		dynamic_matrix<T> const& packed() const {
+			return factors;
+		}
+		size_t permutation(size_t i) const {
+			return order[i];
+		}
+		dynamic_matrix<T> lower() const {
+			dynamic_matrix<T> res(size(), size(), IdentityMatrix, factors.layout());
+			for (size_t r = 1; r < size(); r++)
+				for (size_t c = 0; c < r; c++)
+					res.element(r, c) = factors.element(r, c);
+			return res;
+		}
+		dynamic_matrix<T> upper() const {
+			dynamic_matrix<T> res(size(), size(), ZeroMatrix, factors.layout());
+			for (size_t r = 0; r < size(); r++)
+				for (size_t c = r; c < size(); c++)
+					res.element(r, c) = factors.element(r, c);
+			return res;
+		}
+		T determinant() const {
+			T res = odd ? T(-1) : T(1);
+			for (size_t i = 0; i < size(); i++)
+				res *= factors.element(i, i);
+			return res;
+		}
+
+		// Solves A X = B for all columns of B at once.
+		dynamic_matrix<T> solve(dynamic_matrix<T> const& b, thread_pool& pool = default_thread_pool()) const {
+			if (b.rows() != size())
+				throw Exceptions::MatrixSizeMismatch("Right-hand side has a different number of rows.");
+			dynamic_matrix<T> x(b.rows(), b.columns(), ZeroMatrix, b.layout());
+			for (size_t r = 0; r < b.rows(); r++)
+				for (size_t c = 0; c < b.columns(); c++)
+					x.element(r, c) = b.element(order[r], c);
+			K::solve_lower(true, size(), x.columns(), factors.begin(), factors.row_stride(), factors.column_stride(), x.begin(), x.row_stride(), x.column_stride(), pool);
+			K::solve_upper(false, size(), x.columns(), factors.begin(), factors.row_stride(), factors.column_stride(), x.begin(), x.row_stride(), x.column_stride(), pool);
+			return x;
+		}
+		std::vector<T> solve(std::vector<T> const& b, thread_pool& pool = default_thread_pool()) const {
+			dynamic_matrix<T> column(b.size(), 1, ZeroMatrix);
+			std::copy(b.begin(), b.end(), column.begin());
+			auto x = solve(column, pool);
+			return std::vector<T>(x.begin(), x.end());
+		}
+		dynamic_matrix<T> inverse(thread_pool& pool = default_thread_pool()) const {
+			return solve(dynamic_matrix<T>(size(), size(), IdentityMatrix, factors.layout()), pool);
+		}
+	};
+
+	// Runtime-sized counterpart of cholesky_decomposition, blocked like dynamic_lu. Only the
+	// lower triangle of the matrix is read.
+	template<typename T>
+	class dynamic_cholesky {
+		static_assert(std::is_floating_point<T>::value, "Only floating point matrices can be decomposed.");
+		using K = triangular_kernel<T>;
+	protected:
+		dynamic_matrix<T> factor;
+	public:
+		explicit dynamic_cholesky(dynamic_matrix<T> m, thread_pool& pool = default_thread_pool()) : factor(std::move(m)) {
+			size_t const n = factor.rows();
+			if (factor.columns() != n)
+				throw Exceptions::MatrixSizeMismatch("Only square matrices have a Cholesky decomposition.");
+			size_t const rs = factor.row_stride(), cs = factor.column_stride();
+			T* a = factor.begin();
+			for (size_t k0 = 0; k0 < n; k0 += K::block) {
+				size_t const k1 = std::min(n, k0 + K::block);
+				for (size_t j = k0; j < k1; j++) {
+					T d = a[j * rs + j * cs];
+					for (size_t k = k0; k < j; k++)
+						d -= a[j * rs + k * cs] * a[j * rs + k * cs];
+					if (!(d > T(0)))
+						throw Exceptions::MatrixNotPositiveDefinite("Matrix is not positive definite.");
+					T const l = math::sqrt(d);
+					a[j * rs + j * cs] = l;
+					for (size_t r = j + 1; r < k1; r++) {
+						T s = a[r * rs + j * cs];
+						for (size_t k = k0; k < j; k++)
+							s -= a[r * rs + k * cs] * a[j * rs + k * cs];
+						a[r * rs + j * cs] = s / l;
+					}
+				}
+				if (k1 < n) {
+					T* l21 = a + k1 * rs + k0 * cs;
+					K::solve_lower(false, k1 - k0, n - k1, a + k0 * rs + k0 * cs, rs, cs, l21, cs, rs, pool);
+					multiply_add(n - k1, n - k1, k1 - k0, T(-1), l21, rs, cs, l21, cs, rs, a + k1 * rs + k1 * cs, rs, cs, pool);
+				}
+			}
+			for (size_t r = 0; r < n; r++)
+				for (size_t c = r + 1; c < n; c++)
+					a[r * rs + c * cs] = T(0);
+		}
+
+		size_t size() const {
+			return factor.rows();
+		}
+		dynamic_matrix<T> const& lower() const {
+			return factor;
+		}
+		T determinant() const {
+			T res = T(1);
+			for (size_t i = 0; i < size(); i++)
+				res *= factor.element(i, i);
+			return res * res;
+		}
+
+		dynamic_matrix<T> solve(dynamic_matrix<T> const& b, thread_pool& pool = default_thread_pool()) const {
+			if (b.rows() != size())
+				throw Exceptions::MatrixSizeMismatch("Right-hand side has a different number of rows.");
+			dynamic_matrix<T> x(b);
+			size_t const rs = factor.row_stride(), cs = factor.column_stride();
+			K::solve_lower(false, size(), x.columns(), factor.begin(), rs, cs, x.begin(), x.row_stride(), x.column_stride(), pool);
+			K::solve_upper(false, size(), x.columns(), factor.begin(), cs, rs, x.begin(), x.row_stride(), x.column_stride(), pool);
+			return x;
+		}
+		std::vector<T> solve(std::vector<T> const& b, thread_pool& pool = default_thread_pool()) const {
+			dynamic_matrix<T> column(b.size(), 1, ZeroMatrix);
+			std::copy(b.begin(), b.end(), column.begin());
+			auto x = solve(column, pool);
+			return std::vector<T>(x.begin(), x.end());
+		}
+		dynamic_matrix<T> inverse(thread_pool& pool = default_thread_pool()) const {
+			return solve(dynamic_matrix<T>(size(), size(), IdentityMatrix, factor.layout()), pool);
+		}
+	};
+
+	// Runtime-sized counterpart of qr_decomposition. Reflectors are built one panel at a time
+	// and applied to the trailing columns together as I - V T V^T, so the update is two
+	// matrix products.
+	template<typename T>
+	class dynamic_qr {
+		static_assert(std::is_floating_point<T>::value, "Only floating point matrices can be decomposed.");
+		using K = triangular_kernel<T>;
+	protected:
+		dynamic_matrix<T> factors;
+		std::vector<T> tau;
+
+		// Applies the reflectors k0 ... k1 - 1 as a block to rows [k0, m) of the columns of x;
+		// as Q^T when transposed is set, as Q otherwise.
+		void apply_block(size_t k0, size_t k1, bool transposed, size_t columns, T* x, size_t xrs, size_t xcs, thread_pool& pool) const {
+			size_t const m = factors.rows(), kb = k1 - k0, mb = m - k0;
+			dynamic_matrix<T> v(mb, kb, ZeroMatrix), t(kb, kb, ZeroMatrix), w(kb, columns, ZeroMatrix);
+			std::vector<T> products(kb);
+			for (size_t j = 0; j < kb; j++) {
+				v.element(j, j) = T(1);
+				for (size_t r = j + 1; r < mb; r++)
+					v.element(r, j) = factors.element(k0 + r, k0 + j);
+			}
+			for (size_t i = 0; i < kb; i++) {
+				t.element(i, i) = tau[k0 + i];
+				for (size_t j = 0; j < i; j++) {
+					T s = T(0);
+					for (size_t r = i; r < mb; r++)
+						s += v.element(r, j) * v.element(r, i);
+					products[j] = -tau[k0 + i] * s;
+				}
+				for (size_t j = 0; j < i; j++) {
+					T s = T(0);
+					for (size_t l = j; l < i; l++)
+						s += t.element(j, l) * products[l];
+					t.element(j, i) = s;
+				}
+			}
+			multiply_add(kb, columns, mb, T(1), v.begin(), size_t(1), kb, x + k0 * xrs, xrs, xcs, w.begin(), columns, size_t(1), pool);
+			if (transposed)
+				for (size_t i = kb; i-- > 0;)
+					for (size_t c = 0; c < columns; c++) {
+						T s = T(0);
+						for (size_t l = 0; l <= i; l++)
+							s += t.element(l, i) * w.element(l, c);
+						w.element(i, c) = s;
+					}
+			else
+				for (size_t i = 0; i < kb; i++)
+					for (size_t c = 0; c < columns; c++) {
+						T s = T(0);
+						for (size_t l = i; l < kb; l++)
+							s += t.element(i, l) * w.element(l, c);
+						w.element(i, c) = s;
+					}
+			multiply_add(mb, columns, kb, T(-1), v.begin(), kb, size_t(1), w.begin(), columns, size_t(1), x + k0 * xrs, xrs, xcs, pool);
+		}
+	public:
+		explicit dynamic_qr(dynamic_matrix<T> m, thread_pool& pool = default_thread_pool()) : factors(std::move(m)), tau(factors.columns(), T(0)) {
+			size_t const rows = factors.rows(), n = factors.columns();
+			if (rows < n)
+				throw Exceptions::MatrixSizeMismatch("QR decomposition needs at least as many rows as columns.");
+			size_t const rs = factors.row_stride(), cs = factors.column_stride();
+			T* a = factors.begin();
+			for (size_t k0 = 0; k0 < n; k0 += K::block) {
+				size_t const k1 = std::min(n, k0 + K::block);
+				for (size_t k = k0; k < k1; k++) {
+					T const alpha = a[k * rs + k * cs];
+					T sigma = T(0);
+					for (size_t r = k + 1; r < rows; r++)
+						sigma += a[r * rs + k * cs] * a[r * rs + k * cs];
+					if (sigma == T(0))
+						continue;
+					T const norm = math::sqrt(alpha * alpha + sigma);
+					T const beta = alpha > T(0) ? -norm : norm;
+					tau[k] = (beta - alpha) / beta;
+					T const f = T(1) / (alpha - beta);
+					for (size_t r = k + 1; r < rows; r++)
+						a[r * rs + k * cs] *= f;
+					a[k * rs + k * cs] = beta;
+					for (size_t c = k + 1; c < k1; c++) {
+						T s = a[k * rs + c * cs];
+						for (size_t r = k + 1; r < rows; r++)
+							s += a[r * rs + k * cs] * a[r * rs + c * cs];
+						s *= tau[k];
+						a[k * rs + c * cs] -= s;
+						for (size_t r = k + 1; r < rows; r++)
+							a[r * rs + c * cs] -= s * a[r * rs + k * cs];
+					}
+				}
+				if (k1 < n)
+					apply_block(k0, k1, true, n - k1, a + k1 * cs, rs, cs, pool);
+			}
+		}
+
+		size_t rows() const {
+			return factors.rows();
+		}
+		size_t columns() const {
+			return factors.columns();
+		}
+		dynamic_matrix<T> const& packed() const {
+			return factors;
+		}
+		dynamic_matrix<T> transposed_q_times(dynamic_matrix<T> b, thread_pool& pool = default_thread_pool()) const {
+			if (b.rows() != rows())
+				throw Exceptions::MatrixSizeMismatch("Right-hand side has a different number of rows.");
+			for (size_t k0 = 0; k0 < columns(); k0 += K::block)
+				apply_block(k0, std::min(columns(), k0 + K::block), true, b.columns(), b.begin(), b.row_stride(), b.column_stride(), pool);
+			return b;
+		}
+		// The first columns() columns of Q.
+		dynamic_matrix<T> q(thread_pool& pool = default_thread_pool()) const {
+			dynamic_matrix<T> res(rows(), columns(), IdentityMatrix, factors.layout());
+			size_t k0 = (columns() + K::block - 1) / K::block * K::block;
+			while (k0 > 0) {
+				k0 -= K::block;
+				apply_block(k0, std::min(columns(), k0 + K::block), false, columns(), res.begin(), res.row_stride(), res.column_stride(), pool);
+			}
+			return res;
+		}
+		dynamic_matrix<T> r() const {
+			dynamic_matrix<T> res(columns(), columns(), ZeroMatrix, factors.layout());
+			for (size_t i = 0; i < columns(); i++)
+				for (size_t j = i; j < columns(); j++)
+					res.element(i, j) = factors.element(i, j);
+			return res;
+		}
+
+		// Least squares solution of A X = B for all columns of B at once.
+		dynamic_matrix<T> solve(dynamic_matrix<T> const& b, thread_pool& pool = default_thread_pool()) const {
+			for (size_t i = 0; i < columns(); i++)
+				if (factors.element(i, i) == T(0))
+					throw Exceptions::MatrixIsSingular("Matrix does not have full column rank.");
+			auto y = transposed_q_times(b, pool);
+			K::solve_upper(false, columns(), y.columns(), factors.begin(), factors.row_stride(), factors.column_stride(), y.begin(), y.row_stride(), y.column_stride(), pool);
+			dynamic_matrix<T> x(columns(), y.columns(), ZeroMatrix, b.layout());
+			for (size_t r = 0; r < columns(); r++)
+				for (size_t c = 0; c < y.columns(); c++)
+					x.element(r, c) = y.element(r, c);
+			return x;
+		}
+		std::vector<T> solve(std::vector<T> const& b, thread_pool& pool = default_thread_pool()) const {
+			dynamic_matrix<T> column(b.size(), 1, ZeroMatrix);
+			std::copy(b.begin(), b.end(), column.begin());
+			auto x = solve(column, pool);
+			return std::vector<T>(x.begin(), x.end());
+		}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,320 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+
+#include "mml/aligned_allocator.hpp"
+#include "mml/matrix.hpp"
+#include "mml/parallel.hpp"
+
+#include "mml/exceptions.hpp"
+DefineNewMMLException(MatrixSizeMismatch);
+
+namespace mml {
+	enum MatrixLayout { RowMajor = 0, ColumnMajor = 1 };
+
+	// Heap-backed matrix with sizes chosen at run time, stored contiguously and cache-line
+	// aligned in either row-major or column-major order.
+	template<typename T>
+	class dynamic_matrix {
+	protected:
+		size_t row_count;
+		size_t column_count;
+		MatrixLayout order;
+		std::vector<T, aligned_allocator<T>> data;
+
+		size_t index(size_t r, size_t c) const {
+			return r * row_stride() + c * column_stride();
+		}
+	public:
+		using value_type = T;
+
+		dynamic_matrix() : row_count(0), column_count(0), order(RowMajor) {}
+		dynamic_matrix(size_t rows, size_t columns, MatrixValue mv = IdentityMatrix, MatrixLayout layout = RowMajor)
+			: row_count(rows), column_count(columns), order(layout), data(rows * columns, T(0)) {
+			if (mv == IdentityMatrix)
+				for (size_t i = 0; i < std::min(rows, columns); i++)
+					element(i, i) = T(1);
+		}
+		dynamic_matrix(size_t rows, size_t columns, MatrixLayout layout) : dynamic_matrix(rows, columns, IdentityMatrix, layout) {}
+		template<typename T_O, size_t R, size_t C, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
+		dynamic_matrix(basic_matrix<T_O, R, C> const& other, MatrixLayout layout = RowMajor) : dynamic_matrix(R, C, ZeroMatrix, layout) {
+			for (size_t r = 0; r < R; r++)
+				for (size_t c = 0; c < C; c++)
+					element(r, c) = T(other.element(r, c));
+		}
+		template<typename T_O, size_t R, size_t C, typename = typename std::enable_if<std::is_convertible<T, T_O>::value>::type>
+		explicit operator basic_matrix<T_O, R, C>() const {
+			basic_matrix<T_O, R, C> res(ZeroMatrix);
+			for (size_t r = 0; r < std::min(R, row_count); r++)
+				for (size_t c = 0; c < std::min(C, column_count); c++)
+					res.element(r, c) = T_O(element(r, c));
+			return res;
+		}
+
+		size_t rows() const {
+			return row_count;
+		}
+		size_t columns() const {
+			return column_count;
+		}
+		size_t size() const {
+			return data.size();
+		}
+		MatrixLayout layout() const {
+			return order;
+		}
+		size_t row_stride() const {
+			return order == RowMajor ? column_count : 1;
+		}
+		size_t column_stride() const {
+			return order == RowMajor ? 1 : row_count;
+		}
+		T const* begin() const {
+			return data.data();
+		}
+		T* begin() {
+			return data.data();
+		}
+		T const* end() const {
+			return data.data() + data.size();
+		}
+		T* end() {
+			return data.data() + data.size();
+		}
+
+		T const& at(size_t r, size_t c) const noexcept(MML_BOUNDS_NOEXCEPT) {
+			CheckMMLBounds(r < row_count && c < column_count, MatrixIndexOutOfBounds);
+			return data[index(r, c)];
+		}
+		T& at(size_t r, size_t c) noexcept(MML_BOUNDS_NOEXCEPT) {
+			CheckMMLBounds(r < row_count && c < column_count, MatrixIndexOutOfBounds);
+			return data[index(r, c)];
+		}
+		T const& operator()(size_t r, size_t c) const noexcept(MML_BOUNDS_NOEXCEPT) {
+			return at(r, c);
+		}
+		T& operator()(size_t r, size_t c) noexcept(MML_BOUNDS_NOEXCEPT) {
+			return at(r, c);
+		}
+		T const& element(size_t r, size_t c) const noexcept {
+			return data[index(r, c)];
+		}
+		T& element(size_t r, size_t c) noexcept {
+			return data[index(r, c)];
+		}
+
+		void fill(T const& value) {
+			std::fill(data.begin(), data.end(), value);
+		}
+		dynamic_matrix<T> transposed() const {
+			dynamic_matrix<T> res(*this);
+			std::swap(res.row_count, res.column_count);
+			res.order = order == RowMajor ? ColumnMajor : RowMajor;
+			return res;
+		}
+		dynamic_matrix<T> with_layout(MatrixLayout layout) const {
+			if (layout == order)
+				return *this;
+			dynamic_matrix<T> res(row_count, column_count, ZeroMatrix, layout);
+			for (size_t r = 0; r < row_count; r++)
+				for (size_t c = 0; c < column_count; c++)
+					res.element(r, c) = element(r, c);
+			return res;
+		}
+
+		template<typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
+		dynamic_matrix<T>& operator+=(dynamic_matrix<T_O> const& other) {
+			if (row_count != other.rows() || column_count != other.columns())
+				throw Exceptions::MatrixSizeMismatch("Matrices have different sizes.");
+			for (size_t r = 0; r < row_count; r++)
+				for (size_t c = 0; c < column_count; c++)
+					element(r, c) += T(other.element(r, c));
+			return *this;
+		}
+		template<typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
+		dynamic_matrix<T>& operator-=(dynamic_matrix<T_O> const& other) {
+			if (row_count != other.rows() || column_count != other.columns())
+				throw Exceptions::MatrixSizeMismatch("Matrices have different sizes.");
+			for (size_t r = 0; r < row_count; r++)
+				for (size_t c = 0; c < column_count; c++)
+					element(r, c) -= T(other.element(r, c));
+			return *this;
+		}
+		template<typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
+		dynamic_matrix<T>& operator*=(T_O const& q) {
+			for (auto& value : data)
+				value *= T(q);
+			return *this;
+		}
+		template<typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
+		dynamic_matrix<T>& operator/=(T_O const& q) {
+			for (auto& value : data)
+				value /= T(q);
+			return *this;
+		}
+		dynamic_matrix<T> operator-() const {
+			dynamic_matrix<T> res(*this);
+			for (auto& value : res.data)
+				value = -value;
+			return res;
+		}
+	};
+
+	template<typename T, typename T_O>
+	bool operator==(dynamic_matrix<T> const& m1, dynamic_matrix<T_O> const& m2) {
+		if (m1.rows() != m2.rows() || m1.columns() != m2.columns())
+			return false;
+		for (size_t r = 0; r < m1.rows(); r++)
+			for (size_t c = 0; c < m1.columns(); c++)
+				if (m1.element(r, c) != m2.element(r, c))
+					return false;
+		return true;
+	}
+	template<typename T, typename T_O>
+	bool operator!=(dynamic_matrix<T> const& m1, dynamic_matrix<T_O> const& m2) {
+		return !(m1 == m2);
+	}
+	template<typename T, typename T_O>
+	dynamic_matrix<T> operator+(dynamic_matrix<T> const& m1, dynamic_matrix<T_O> const& m2) {
+		dynamic_matrix<T> res(m1);
+		return res += m2;
+	}
+	template<typename T, typename T_O>
+	dynamic_matrix<T> operator-(dynamic_matrix<T> const& m1, dynamic_matrix<T_O> const& m2) {
+		dynamic_matrix<T> res(m1);
+		return res -= m2;
+	}
+	template<typename T, typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
+	dynamic_matrix<T> operator*(dynamic_matrix<T> const& m, T_O const& q) {
+		dynamic_matrix<T> res(m);
+		return res *= q;
+	}
+	template<typename T, typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
+	dynamic_matrix<T> operator*(T_O const& q, dynamic_matrix<T> const& m) {
+		dynamic_matrix<T> res(m);
+		return res *= q;
+	}
+	template<typename T, typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
+	dynamic_matrix<T> operator/(dynamic_matrix<T> const& m, T_O const& q) {
+		dynamic_matrix<T> res(m);
+		return res /= q;
+	}
+
+	// Blocked product after Goto and van de Geijn. Panels of B (kc x nr) and of A (mr x kc)
+	// are packed contiguously, and an mr x nr tile of C is accumulated in registers.
+	template<typename T>
+	struct gemm_kernel {
+		using L = simd::lanes<T>;
+		static constexpr size_t mr = 6;
+		static constexpr size_t nr = L::accelerated ? 2 * L::width : 4;
+		static constexpr size_t kc = 256;
+		static constexpr size_t mc = 72;
+		static constexpr size_t nc = 2048;
+
+		// Copies an m x k block of A into mr-row panels, each stored column by column.
+		static void pack_a(T* out, T const* a, size_t rs, size_t cs, size_t m, size_t k) {
+			for (size_t i = 0; i < m; i += mr)
+				for (size_t p = 0; p < k; p++)
+					for (size_t ii = 0; ii < mr; ii++)
+						*out++ = i + ii < m ? a[(i + ii) * rs + p * cs] : T(0);
+		}
+		// Copies a k x n (n <= nr) panel of B row by row, padded to nr columns.
+		static void pack_b(T* out, T const* b, size_t rs, size_t cs, size_t k, size_t n) {
+			for (size_t p = 0; p < k; p++)
+				for (size_t j = 0; j < nr; j++)
+					*out++ = j < n ? b[p * rs + j * cs] : T(0);
+		}
+		static void tile(T* res, T const* a, T const* b, size_t k) {
+			if constexpr (L::accelerated) {
+				typename L::type acc[mr][2];
+				for (size_t i = 0; i < mr; i++)
+					acc[i][0] = acc[i][1] = L::broadcast(T(0));
+				for (size_t p = 0; p < k; p++) {
+					auto b0 = L::load(b + p * nr), b1 = L::load(b + p * nr + L::width);
+					for (size_t i = 0; i < mr; i++) {
+						auto factor = L::broadcast(a[p * mr + i]);
+						acc[i][0] = L::add(acc[i][0], L::mul(factor, b0));
+						acc[i][1] = L::add(acc[i][1], L::mul(factor, b1));
+					}
+				}
+				for (size_t i = 0; i < mr; i++) {
+					L::store(res + i * nr, acc[i][0]);
+					L::store(res + i * nr + L::width, acc[i][1]);
+				}
+			} else {
+				for (size_t i = 0; i < mr * nr; i++)
+					res[i] = T(0);
+				for (size_t p = 0; p < k; p++)
+					for (size_t i = 0; i < mr; i++)
+						for (size_t j = 0; j < nr; j++)
+							res[i * nr + j] += a[p * mr + i] * b[p * nr + j];
+			}
+		}
+	};
+
+	// C += alpha * A * B for an m x k block of A, a k x n block of B and an m x n block of C,
+	// each given by a pointer to its first element and its row and column strides. Row blocks
+	// of C are distributed over the pool. Every element is summed in the same order whatever
+	// the thread count, so results are reproducible.
+	template<typename T>
+	void multiply_add(size_t m, size_t n, size_t k, T const& alpha, T const* pa, size_t ars, size_t acs, T const* pb, size_t brs, size_t bcs,
+					  T* pc, size_t crs, size_t ccs, thread_pool& pool = default_thread_pool()) {
+		using K = gemm_kernel<T>;
+		if (m == 0 || n == 0 || k == 0)
+			return;
+		std::vector<T, aligned_allocator<T>> packed_b(std::min(K::kc, k) * ((std::min(K::nc, n) + K::nr - 1) / K::nr) * K::nr);
+
+		for (size_t jc = 0; jc < n; jc += K::nc) {
+			size_t const nb = std::min(K::nc, n - jc);
+			size_t const panels = (nb + K::nr - 1) / K::nr;
+			for (size_t p0 = 0; p0 < k; p0 += K::kc) {
+				size_t const kb = std::min(K::kc, k - p0);
+				pool.parallel_for(panels, 16, [&](size_t first, size_t last) {
+					for (size_t j = first; j < last; j++)
+						K::pack_b(packed_b.data() + j * K::nr * kb, pb + p0 * brs + (jc + j * K::nr) * bcs, brs, bcs, kb, std::min(K::nr, nb - j * K::nr));
+				});
+				pool.parallel_for((m + K::mc - 1) / K::mc, 1, [&](size_t first, size_t last) {
+					static thread_local std::vector<T, aligned_allocator<T>> packed_a;
+					packed_a.resize(K::mc * K::kc);
+					alignas(64) T res[K::mr * K::nr];
+					for (size_t block = first; block < last; block++) {
+						size_t const ic = block * K::mc, mb = std::min(K::mc, m - ic);
+						K::pack_a(packed_a.data(), pa + ic * ars + p0 * acs, ars, acs, mb, kb);
+						for (size_t jr = 0; jr < nb; jr += K::nr)
+							for (size_t ir = 0; ir < mb; ir += K::mr) {
+								K::tile(res, packed_a.data() + ir * kb, packed_b.data() + jr * kb, kb);
+								size_t const rows = std::min(K::mr, mb - ir), columns = std::min(K::nr, nb - jr);
+								for (size_t i = 0; i < rows; i++)
+									for (size_t j = 0; j < columns; j++)
+										pc[(ic + ir + i) * crs + (jc + jr + j) * ccs] += alpha * res[i * K::nr + j];
+							}
+					}
+				});
+			}
+		}
+	}
+	// C = A * B, keeping the layout of C.
+	template<typename T>
+	void multiply(dynamic_matrix<T> const& a, dynamic_matrix<T> const& b, dynamic_matrix<T>& c, thread_pool& pool = default_thread_pool()) {
+		if (a.columns() != b.rows())
+			throw Exceptions::MatrixSizeMismatch("Inner dimensions differ.");
+		if (&c == &a || &c == &b) {
+			dynamic_matrix<T> res(0, 0, ZeroMatrix, c.layout());
+			multiply(a, b, res, pool);
+			c = std::move(res);
+			return;
+		}
+		c = dynamic_matrix<T>(a.rows(), b.columns(), ZeroMatrix, c.layout());
+		multiply_add(a.rows(), b.columns(), a.columns(), T(1), a.begin(), a.row_stride(), a.column_stride(), b.begin(), b.row_stride(), b.column_stride(),
+					 c.begin(), c.row_stride(), c.column_stride(), pool);
+	}
+	template<typename T>
+	dynamic_matrix<T> operator*(dynamic_matrix<T> const& m1, dynamic_matrix<T> const& m2) {
+		dynamic_matrix<T> res;
+		multiply(m1, m2, res);
+		return res;
+	}
+
+	class dynamic_matrixf : public dynamic_matrix<float> { public: using dynamic_matrix::dynamic_matrix; };
+	class dynamic_matrixd : public dynamic_matrix<double> { public: using dynamic_matrix::dynamic_matrix; };
+}
\ No newline at end of file
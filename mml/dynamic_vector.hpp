@@ -0,0 +1,346 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <vector>
+
+#include "mml/aligned_allocator.hpp"
+#include "mml/parallel.hpp"
+
+#include "mml/exceptions.hpp"
+DefineNewMMLException(VectorSizeMismatch);
+
+namespace mml {
+	// Kernels of the dynamic_vector operations on raw arrays. A reduction sums each block of
+	// at most block elements in four interleaved SIMD accumulators, adds those and then their
+	// lanes pairwise and the scalar remainder last; the block sums are combined by a pairwise
+	// tree in block order. The order only depends on the length, so results are the same for
+	// any thread count or chunk size (though not for another SIMD width).
+	template<typename T>
+	struct dynamic_vector_kernel {
+		using L = simd::lanes<T>;
+		static const size_t block = 4096;
+
+		static T fma(T const& a, T const& b, T const& c) {
+#if defined(MML_FMA)
+			return std::fma(a, b, c);
+#else
+			return a * b + c;
+#endif
+		}
+
+		static T dot(T const* x, T const* y, size_t count) {
+			size_t i = 0;
+			T res = T(0);
+			if constexpr (L::accelerated) {
+				if (count >= 4 * L::width) {
+					typename L::type sums[4] = {L::broadcast(T(0)), L::broadcast(T(0)), L::broadcast(T(0)), L::broadcast(T(0))};
+					for (; i + 4 * L::width <= count; i += 4 * L::width)
+						for (size_t k = 0; k < 4; k++)
+							sums[k] = L::add(sums[k], L::mul(L::load(x + i + k * L::width), L::load(y + i + k * L::width)));
+					T lanes[L::width];
+					L::store(lanes, L::add(L::add(sums[0], sums[1]), L::add(sums[2], sums[3])));
+					res = tree(lanes, L::width);
+				}
+			}
+			T rest = T(0);
+			for (; i < count; i++)
+				rest += x[i] * y[i];
+			return res + rest;
+		}
+		// Sums values[0, count) pairwise, overwriting them.
+		static T tree(T* values, size_t count) {
+			if (count == 0)
+				return T(0);
+			for (size_t step = 1; step < count; step *= 2)
+				for (size_t i = 0; i + step < count; i += 2 * step)
+					values[i] += values[i + step];
+			return values[0];
+		}
+
+		// y += a * x
+		static void axpy(T const& a, T const* x, T* y, size_t count) {
+			size_t i = 0;
+			if constexpr (L::accelerated) {
+				auto const factor = L::broadcast(a);
+				for (; i + L::width <= count; i += L::width)
+					L::store(y + i, L::add(L::load(y + i), L::mul(factor, L::load(x + i))));
+			}
+			for (; i < count; i++)
+				y[i] += a * x[i];
+		}
+		// z = x * y + z, element by element.
+		static void fma(T const* x, T const* y, T* z, size_t count) {
+			size_t i = 0;
+			if constexpr (L::accelerated)
+				for (; i + L::width <= count; i += L::width)
+					L::store(z + i, L::fma(L::load(x + i), L::load(y + i), L::load(z + i)));
+			for (; i < count; i++)
+				z[i] = fma(x[i], y[i], z[i]);
+		}
+		static void scale(T const& a, T* x, size_t count) {
+			size_t i = 0;
+			if constexpr (L::accelerated) {
+				auto const factor = L::broadcast(a);
+				for (; i + L::width <= count; i += L::width)
+					L::store(x + i, L::mul(L::load(x + i), factor));
+			}
+			for (; i < count; i++)
+				x[i] *= a;
+		}
+		static void divide(T const& a, T* x, size_t count) {
+			size_t i = 0;
+			if constexpr (L::accelerated) {
+				auto const divisor = L::broadcast(a);
+				for (; i + L::width <= count; i += L::width)
+					L::store(x + i, L::div(L::load(x + i), divisor));
+			}
+			for (; i < count; i++)
+				x[i] /= a;
+		}
+		static void add(T const* x, T* y, size_t count) {
+			size_t i = 0;
+			if constexpr (L::accelerated)
+				for (; i + L::width <= count; i += L::width)
+					L::store(y + i, L::add(L::load(y + i), L::load(x + i)));
+			for (; i < count; i++)
+				y[i] += x[i];
+		}
+		static void subtract(T const* x, T* y, size_t count) {
+			size_t i = 0;
+			if constexpr (L::accelerated)
+				for (; i + L::width <= count; i += L::width)
+					L::store(y + i, L::sub(L::load(y + i), L::load(x + i)));
+			for (; i < count; i++)
+				y[i] -= x[i];
+		}
+
+		// Runs f(first, last) over chunks of [0, count) that start on a SIMD step.
+		template<typename F>
+		static void apply(size_t count, thread_pool& pool, F const& f) {
+			pool.parallel_for(count, std::max<size_t>(default_chunk_size<T>() / L::width * L::width, 1), f);
+		}
+		// Sums f(first, last) over the blocks of [0, count) in the fixed tree order.
+		template<typename F>
+		static T sum(size_t count, thread_pool& pool, F const& f) {
+			size_t const blocks = (count + block - 1) / block;
+			std::vector<T> sums(blocks);
+			pool.parallel_for(blocks, std::max<size_t>(default_chunk_size<T>() / block, 1), [&](size_t first, size_t last) {
+				for (size_t b = first; b < last; b++)
+					sums[b] = f(b * block, std::min(count, (b + 1) * block));
+			});
+			return tree(sums.data(), blocks);
+		}
+	};
+
+	// Heap-backed vector with its length chosen at run time, stored contiguously and cache-line
+	// aligned. The element-wise operations and reductions are split over a thread pool; see
+	// dynamic_vector_kernel for the summation order of dot() and length().
+	template<typename T>
+	class dynamic_vector {
+	protected:
+		std::vector<T, aligned_allocator<T>> data;
+	public:
+		using value_type = T;
+
+		dynamic_vector() {}
+		explicit dynamic_vector(size_t size, T const& value = T(0)) : data(size, value) {}
+		dynamic_vector(std::initializer_list<T> list) : data(list) {}
+		template<typename T_O, size_t S, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
+		dynamic_vector(basic_vector<T_O, S> const& other) : data(S) {
+			for (size_t i = 0; i < S; i++)
+				data[i] = T(other.element(i));
+		}
+		template<typename T_O, size_t S, typename = typename std::enable_if<std::is_convertible<T, T_O>::value>::type>
+		explicit operator basic_vector<T_O, S>() const {
+			basic_vector<T_O, S> res;
+			for (size_t i = 0; i < std::min(S, data.size()); i++)
+				res.element(i) = T_O(data[i]);
+			return res;
+		}
+
+		size_t size() const {
+			return data.size();
+		}
+		bool empty() const {
+			return data.empty();
+		}
+		void resize(size_t size, T const& value = T(0)) {
+			data.resize(size, value);
+		}
+		T const* begin() const {
+			return data.data();
+		}
+		T* begin() {
+			return data.data();
+		}
+		T const* end() const {
+			return data.data() + data.size();
+		}
+		T* end() {
+			return data.data() + data.size();
+		}
+
+		T const& at(size_t index) const noexcept(MML_BOUNDS_NOEXCEPT) {
+			CheckMMLBounds(index < data.size(), VectorIndexOutOfBounds);
+			return data[index];
+		}
+		T& at(size_t index) noexcept(MML_BOUNDS_NOEXCEPT) {
+			CheckMMLBounds(index < data.size(), VectorIndexOutOfBounds);
+			return data[index];
+		}
+		T const& operator[](size_t index) const noexcept(MML_BOUNDS_NOEXCEPT) {
+			return at(index);
+		}
+		T& operator[](size_t index) noexcept(MML_BOUNDS_NOEXCEPT) {
+			return at(index);
+		}
+		T const& element(size_t index) const noexcept {
+			return data[index];
+		}
+		T& element(size_t index) noexcept {
+			return data[index];
+		}
+
+		void fill(T const& value) {
+			std::fill(data.begin(), data.end(), value);
+		}
+		T length(thread_pool& pool = default_thread_pool()) const;
+		template<typename T_ = T, typename = typename std::enable_if<std::is_floating_point<T_>::value>::type>
+		void normalize(thread_pool& pool = default_thread_pool()) {
+			T const l = length(pool);
+			dynamic_vector_kernel<T>::apply(size(), pool, [&](size_t first, size_t last) {
+				dynamic_vector_kernel<T>::divide(l, begin() + first, last - first);
+			});
+		}
+		template<typename T_ = T, typename = typename std::enable_if<std::is_floating_point<T_>::value>::type>
+		dynamic_vector<T> normalized(thread_pool& pool = default_thread_pool()) const {
+			dynamic_vector<T> res(*this);
+			res.normalize(pool);
+			return res;
+		}
+
+		dynamic_vector<T>& operator+=(dynamic_vector<T> const& other);
+		dynamic_vector<T>& operator-=(dynamic_vector<T> const& other);
+		dynamic_vector<T>& operator*=(T const& q);
+		dynamic_vector<T>& operator/=(T const& q);
+		dynamic_vector<T> operator-() const {
+			dynamic_vector<T> res(*this);
+			for (auto& value : res.data)
+				value = -value;
+			return res;
+		}
+	};
+
+	template<typename T>
+	T dot(dynamic_vector<T> const& v1, dynamic_vector<T> const& v2, thread_pool& pool = default_thread_pool()) {
+		if (v1.size() != v2.size())
+			throw Exceptions::VectorSizeMismatch("Vectors have different sizes.");
+		return dynamic_vector_kernel<T>::sum(v1.size(), pool, [&](size_t first, size_t last) {
+			return dynamic_vector_kernel<T>::dot(v1.begin() + first, v2.begin() + first, last - first);
+		});
+	}
+	template<typename T>
+	T operator%(dynamic_vector<T> const& v1, dynamic_vector<T> const& v2) {
+		return dot(v1, v2);
+	}
+	template<typename T>
+	T dynamic_vector<T>::length(thread_pool& pool) const {
+		return T(std::sqrt(dot(*this, *this, pool)));
+	}
+
+	// y += a * x
+	template<typename T>
+	void axpy(typename dynamic_vector<T>::value_type const& a, dynamic_vector<T> const& x, dynamic_vector<T>& y, thread_pool& pool = default_thread_pool()) {
+		if (x.size() != y.size())
+			throw Exceptions::VectorSizeMismatch("Vectors have different sizes.");
+		dynamic_vector_kernel<T>::apply(x.size(), pool, [&](size_t first, size_t last) {
+			dynamic_vector_kernel<T>::axpy(a, x.begin() + first, y.begin() + first, last - first);
+		});
+	}
+	// z = x * y + z, element by element, with one rounding per element where the instruction
+	// set has fused multiply-adds (MML_FMA).
+	template<typename T>
+	void fma(dynamic_vector<T> const& x, dynamic_vector<T> const& y, dynamic_vector<T>& z, thread_pool& pool = default_thread_pool()) {
+		if (x.size() != y.size() || x.size() != z.size())
+			throw Exceptions::VectorSizeMismatch("Vectors have different sizes.");
+		dynamic_vector_kernel<T>::apply(x.size(), pool, [&](size_t first, size_t last) {
+			dynamic_vector_kernel<T>::fma(x.begin() + first, y.begin() + first, z.begin() + first, last - first);
+		});
+	}
+	// x *= a
+	template<typename T>
+	void scale(typename dynamic_vector<T>::value_type const& a, dynamic_vector<T>& x, thread_pool& pool = default_thread_pool()) {
+		dynamic_vector_kernel<T>::apply(x.size(), pool, [&](size_t first, size_t last) {
+			dynamic_vector_kernel<T>::scale(a, x.begin() + first, last - first);
+		});
+	}
+
+	template<typename T>
+	dynamic_vector<T>& dynamic_vector<T>::operator+=(dynamic_vector<T> const& other) {
+		if (size() != other.size())
+			throw Exceptions::VectorSizeMismatch("Vectors have different sizes.");
+		dynamic_vector_kernel<T>::apply(size(), default_thread_pool(), [&](size_t first, size_t last) {
+			dynamic_vector_kernel<T>::add(other.begin() + first, begin() + first, last - first);
+		});
+		return *this;
+	}
+	template<typename T>
+	dynamic_vector<T>& dynamic_vector<T>::operator-=(dynamic_vector<T> const& other) {
+		if (size() != other.size())
+			throw Exceptions::VectorSizeMismatch("Vectors have different sizes.");
+		dynamic_vector_kernel<T>::apply(size(), default_thread_pool(), [&](size_t first, size_t last) {
+			dynamic_vector_kernel<T>::subtract(other.begin() + first, begin() + first, last - first);
+		});
+		return *this;
+	}
+	template<typename T>
+	dynamic_vector<T>& dynamic_vector<T>::operator*=(T const& q) {
+		scale(q, *this);
+		return *this;
+	}
+	template<typename T>
+	dynamic_vector<T>& dynamic_vector<T>::operator/=(T const& q) {
+		dynamic_vector_kernel<T>::apply(size(), default_thread_pool(), [&](size_t first, size_t last) {
+			dynamic_vector_kernel<T>::divide(q, begin() + first, last - first);
+		});
+		return *this;
+	}
+
+	template<typename T>
+	bool operator==(dynamic_vector<T> const& v1, dynamic_vector<T> const& v2) {
+		return v1.size() == v2.size() && std::equal(v1.begin(), v1.end(), v2.begin());
+	}
+	template<typename T>
+	bool operator!=(dynamic_vector<T> const& v1, dynamic_vector<T> const& v2) {
+		return !(v1 == v2);
+	}
+	template<typename T>
+	dynamic_vector<T> operator+(dynamic_vector<T> const& v1, dynamic_vector<T> const& v2) {
+		dynamic_vector<T> res(v1);
+		return res += v2;
+	}
+	template<typename T>
+	dynamic_vector<T> operator-(dynamic_vector<T> const& v1, dynamic_vector<T> const& v2) {
+		dynamic_vector<T> res(v1);
+		return res -= v2;
+	}
+	template<typename T>
+	dynamic_vector<T> operator*(dynamic_vector<T> const& v, typename dynamic_vector<T>::value_type const& q) {
+		dynamic_vector<T> res(v);
+		return res *= q;
+	}
+	template<typename T>
+	dynamic_vector<T> operator*(typename dynamic_vector<T>::value_type const& q, dynamic_vector<T> const& v) {
+		dynamic_vector<T> res(v);
+		return res *= q;
+	}
+	template<typename T>
+	dynamic_vector<T> operator/(dynamic_vector<T> const& v, typename dynamic_vector<T>::value_type const& q) {
+		dynamic_vector<T> res(v);
+		return res /= q;
+	}
+
+	class dynamic_vectorf : public dynamic_vector<float> { public: using dynamic_vector::dynamic_vector; };
+	class dynamic_vectord : public dynamic_vector<double> { public: using dynamic_vector::dynamic_vector; };
+}
\ No newline at end of file
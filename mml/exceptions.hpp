@@ -1,8 +1,34 @@
 #pragma once
-#include <exception>
+#include <stdexcept>
+#include <string>
+#include "mml/instrumentation.hpp"
 namespace mml::Exceptions {
-	class MMLException : std::exception {
-	public: using std::exception::exception;
+	class MMLException : public std::runtime_error {
+	public:
+		explicit MMLException(std::string const& what) : std::runtime_error(what) {
+			MMLCount(exceptions, 1);
+		}
+		explicit MMLException(char const* what) : std::runtime_error(what) {
+			MMLCount(exceptions, 1);
+		}
+		MMLException() : MMLException("") {}
 	};
 }
-#define DefineNewMMLException(name) namespace mml::Exceptions {class name : public mml::Exceptions::MMLException {public: using MMLException::MMLException;};}
\ No newline at end of file
+#define DefineNewMMLException(name) namespace mml::Exceptions {class name : public mml::Exceptions::MMLException {public: using MMLException::MMLException;};}
+
+#define MML_UNCHECKED 0
+#define MML_ASSERTED 1
+#define MML_CHECKED 2
+#ifndef MML_BOUNDS_CHECKING
+#define MML_BOUNDS_CHECKING MML_CHECKED
+#endif
+
+#if MML_BOUNDS_CHECKING == MML_CHECKED
+#define CheckMMLBounds(condition, name) do { if (!(condition)) throw mml::Exceptions::name(); } while (false)
+#elif MML_BOUNDS_CHECKING == MML_ASSERTED
+#include <cassert>
+#define CheckMMLBounds(condition, name) assert(condition)
+#else
+#define CheckMMLBounds(condition, name) ((void) 0)
+#endif
+#define MML_BOUNDS_NOEXCEPT (MML_BOUNDS_CHECKING != MML_CHECKED)
\ No newline at end of file
@@ -0,0 +1,199 @@
+#pragma once
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+
+namespace mml {
+	template<typename T, size_t S> class basic_vector;
+	template<typename T, size_t R, size_t C> class basic_matrix;
+	template<typename Op, typename L, typename R> class vector_expression;
+	template<typename Op, typename L, typename R> class matrix_expression;
+
+	template<typename T, size_t S> std::true_type is_vector_test(basic_vector<T, S> const*);
+	std::false_type is_vector_test(...);
+	template<typename V> struct is_vector : decltype(is_vector_test(std::declval<V const*>())) {};
+	template<typename T, size_t R, size_t C> std::true_type is_matrix_test(basic_matrix<T, R, C> const*);
+	std::false_type is_matrix_test(...);
+	template<typename M> struct is_matrix : decltype(is_matrix_test(std::declval<M const*>())) {};
+
+	template<typename E> struct is_vector_expression : std::false_type {};
+	template<typename Op, typename L, typename R> struct is_vector_expression<vector_expression<Op, L, R>> : std::true_type {};
+	template<typename E> struct is_matrix_expression : std::false_type {};
+	template<typename Op, typename L, typename R> struct is_matrix_expression<matrix_expression<Op, L, R>> : std::true_type {};
+	// Arithmetic operations per element, which evaluating an expression counts as flops.
+	template<typename E> struct expression_operations : std::integral_constant<size_t, 0> {};
+	template<typename Op, typename L, typename R> struct expression_operations<vector_expression<Op, L, R>>
+		: std::integral_constant<size_t, vector_expression<Op, L, R>::operations> {};
+	template<typename Op, typename L, typename R> struct expression_operations<matrix_expression<Op, L, R>>
+		: std::integral_constant<size_t, matrix_expression<Op, L, R>::operations> {};
+
+	template<typename V> struct is_vector_operand
+		: std::integral_constant<bool, (is_vector<V>::value && !is_matrix<V>::value) || is_vector_expression<V>::value> {};
+	template<typename M> struct is_matrix_operand
+		: std::integral_constant<bool, is_matrix<M>::value || is_matrix_expression<M>::value> {};
+	template<typename Q> struct is_scalar_operand
+		: std::integral_constant<bool, !is_vector<Q>::value && !is_vector_expression<Q>::value && !is_matrix_expression<Q>::value> {};
+
+	template<typename X, bool = is_vector_operand<X>::value>
+	struct vector_operand_traits {
+		using value_type = X;
+		static const size_t size_value = 0;
+	};
+	template<typename X>
+	struct vector_operand_traits<X, true> {
+		using value_type = typename X::value_type;
+		static const size_t size_value = X::size_value;
+	};
+	template<typename X, bool = is_matrix<X>::value, bool = is_matrix_expression<X>::value>
+	struct matrix_operand_traits {
+		using value_type = X;
+		static const size_t rows_value = 0;
+		static const size_t columns_value = 0;
+	};
+	template<typename X>
+	struct matrix_operand_traits<X, true, false> {
+		using value_type = typename X::row_type::value_type;
+		static const size_t rows_value = X::size_value;
+		static const size_t columns_value = X::row_type::size_value;
+	};
+	template<typename X>
+	struct matrix_operand_traits<X, false, true> {
+		using value_type = typename X::value_type;
+		static const size_t rows_value = X::rows_value;
+		static const size_t columns_value = X::columns_value;
+	};
+
+	template<typename V, typename = void>
+	struct evaluated_type { using type = V; };
+	template<typename V>
+	struct evaluated_type<V, typename std::enable_if<is_vector_expression<V>::value>::type> {
+		using type = basic_vector<typename V::value_type, V::size_value>;
+	};
+
+	// Leaves bound to lvalues are referenced, so a lazy expression sees later changes to
+	// them until it is evaluated; temporaries, scalars and sub-expressions are stored by
+	// value, so an expression never outlives the operands it was built from.
+	template<typename X>
+	using expression_operand = typename std::conditional<std::is_lvalue_reference<X>::value
+		&& (is_vector<typename std::decay<X>::type>::value || is_matrix<typename std::decay<X>::type>::value),
+		typename std::decay<X>::type const&, typename std::decay<X>::type>::type;
+
+	struct expression_none {};
+	struct expression_identity {
+		template<typename A, typename B> static constexpr A apply(A const& a, B const&) { return a; }
+	};
+	struct expression_add {
+		template<typename A, typename B> static constexpr auto apply(A const& a, B const& b) { return a + b; }
+	};
+	struct expression_subtract {
+		template<typename A, typename B> static constexpr auto apply(A const& a, B const& b) { return a - b; }
+	};
+	struct expression_multiply {
+		template<typename A, typename B> static constexpr auto apply(A const& a, B const& b) { return a * b; }
+	};
+	struct expression_divide {
+		template<typename A, typename B> static constexpr auto apply(A const& a, B const& b) { return a / b; }
+	};
+	struct expression_divide_reversed {
+		template<typename A, typename B> static constexpr auto apply(A const& a, B const& b) { return b / a; }
+	};
+	struct expression_negate {
+		template<typename A, typename B> static constexpr A apply(A const& a, B const&) { return -a; }
+	};
+
+	// Operators on plain vectors and matrices return evaluated results, with the types and
+	// values of the eager operators, in a single pass over the elements. Once an operand is
+	// an expression, which lazy() makes of a vector or a matrix, the result stays lazy and the
+	// whole expression is fused into the assignment that finally evaluates it.
+	template<typename X> struct is_lazy_operand
+		: std::integral_constant<bool, is_vector_expression<typename std::decay<X>::type>::value || is_matrix_expression<typename std::decay<X>::type>::value> {};
+	template<bool Enabled, typename E, typename L, typename R>
+	struct expression_result {};
+	template<typename E, typename L, typename R>
+	struct expression_result<true, E, L, R> {
+		using type = typename std::conditional<is_lazy_operand<L>::value || is_lazy_operand<R>::value, E, typename E::result_type>::type;
+	};
+
+	template<typename X>
+	constexpr decltype(auto) vector_element(X const& x, size_t i) {
+		if constexpr (is_vector_expression<X>::value || is_vector<X>::value)
+			return x.element(i);
+		else
+			return (x);
+	}
+	template<typename X>
+	constexpr decltype(auto) matrix_element(X const& x, size_t r, size_t c) {
+		if constexpr (is_matrix_expression<X>::value || is_matrix<X>::value)
+			return x.element(r, c);
+		else
+			return (x);
+	}
+	template<typename X>
+	constexpr decltype(auto) evaluate(X const& x) {
+		if constexpr (is_vector_expression<X>::value || is_matrix_expression<X>::value)
+			return x.eval();
+		else
+			return (x);
+	}
+
+	// Lazy element-wise node. Operands of different sizes follow the eager operators:
+	// the result is as long as the longer one, a missing left element reads as zero
+	// and a missing right element leaves the left one unchanged.
+	template<typename Op, typename L, typename R>
+	class vector_expression {
+		using left_type = typename std::decay<L>::type;
+		using right_type = typename std::decay<R>::type;
+		static const bool right_is_scalar = !is_vector_operand<right_type>::value;
+		static const size_t left_size = vector_operand_traits<left_type>::size_value;
+		static const size_t right_size = right_is_scalar ? left_size : vector_operand_traits<right_type>::size_value;
+		using left_value = typename vector_operand_traits<left_type>::value_type;
+		using right_value = typename vector_operand_traits<right_type>::value_type;
+	public:
+		using value_type = typename evaluated_type<typename std::decay<decltype(Op::apply(std::declval<left_value>(), std::declval<right_value>()))>::type>::type;
+		static const size_t size_value = std::max(left_size, right_size);
+		using result_type = basic_vector<value_type, size_value>;
+		static const size_t operations = (std::is_same<Op, expression_identity>::value ? 0 : 1)
+			+ expression_operations<left_type>::value + expression_operations<right_type>::value;
+	protected:
+		expression_operand<L> left;
+		expression_operand<R> right;
+	public:
+		template<typename L_O, typename R_O>
+		constexpr vector_expression(L_O&& l, R_O&& r) : left(std::forward<L_O>(l)), right(std::forward<R_O>(r)) {}
+
+		constexpr value_type element(size_t i) const {
+			if constexpr (std::is_same<right_type, expression_none>::value)
+				return value_type(Op::apply(value_type(vector_element(left, i)), right));
+			else if constexpr (right_is_scalar)
+				return value_type(Op::apply(value_type(vector_element(left, i)), value_type(right)));
+			else {
+				if (i >= right_size)
+					return value_type(vector_element(left, i));
+				if (i >= left_size)
+					return value_type(Op::apply(value_type(0), value_type(vector_element(right, i))));
+				return value_type(Op::apply(value_type(vector_element(left, i)), value_type(vector_element(right, i))));
+			}
+		}
+		constexpr value_type operator[](size_t index) const noexcept(MML_BOUNDS_NOEXCEPT) {
+			CheckMMLBounds(index < size_value, VectorIndexOutOfBounds);
+			return element(index);
+		}
+		constexpr value_type at(size_t index) const noexcept(MML_BOUNDS_NOEXCEPT) {
+			return operator[](index);
+		}
+		constexpr size_t size() const {
+			return size_value;
+		}
+
+		constexpr basic_vector<value_type, size_value> eval() const {
+			return basic_vector<value_type, size_value>(*this);
+		}
+		constexpr value_type length() const {
+			return eval().length();
+		}
+		constexpr auto normalized() const {
+			return eval().normalized();
+		}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,177 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "mml/aabb.hpp"
+#include "mml/vector_batch.hpp"
+
+namespace mml {
+	// The six clip planes of a view-projection matrix (Gribb and Hartmann), for the column
+	// vectors and [-1, 1] depth range of perspective_projection and orthographic_projection.
+	// Every plane (a, b, c, d) is scaled to a unit normal pointing into the frustum, so that
+	// a * x + b * y + c * z + d is the signed distance of a point from it.
+	// The tests are conservative: an object is only rejected when it lies entirely behind one
+	// of the planes, so large objects near the edges of the frustum may pass.
+	template<typename T>
+	class basic_frustum {
+	public:
+		enum plane_index { left_plane, right_plane, bottom_plane, top_plane, near_plane, far_plane, plane_count };
+	protected:
+		basic_vector<T, 4> planes[plane_count];
+	public:
+		using value_type = T;
+
+		basic_frustum() {}
+		explicit basic_frustum(basic_matrix<T, 4, 4> const& view_projection) {
+			auto const& m = view_projection;
+			for (size_t i = 0; i < plane_count; i++) {
+				T const sign = i % 2 ? T(-1) : T(1);
+				for (size_t c = 0; c < 4; c++)
+					planes[i].element(c) = m.element(3, c) + sign * m.element(i / 2, c);
+				T const length = basic_vector<T, 3>(planes[i]).length();
+				if (length > T(0))
+					planes[i] /= length;
+			}
+		}
+
+		basic_vector<T, 4> const& plane(size_t index) const noexcept(MML_BOUNDS_NOEXCEPT) {
+			CheckMMLBounds(index < plane_count, VectorIndexOutOfBounds);
+			return planes[index];
+		}
+		// Summed in the same order as the lanes of the batch tests below.
+		T distance(size_t index, basic_vector<T, 3> const& point) const {
+			auto const& p = planes[index];
+			return p[0] * point[0] + p[1] * point[1] + p[2] * point[2] + p[3];
+		}
+
+		bool contains(basic_vector<T, 3> const& point) const {
+			for (size_t i = 0; i < plane_count; i++)
+				if (distance(i, point) < T(0))
+					return false;
+			return true;
+		}
+		bool intersects(basic_vector<T, 3> const& center, T const& radius) const {
+			for (size_t i = 0; i < plane_count; i++)
+				if (distance(i, center) < -radius)
+					return false;
+			return true;
+		}
+		// Tests the corner of the box furthest along the normal of each plane.
+		bool intersects(basic_vector<T, 3> const& minimum, basic_vector<T, 3> const& maximum) const {
+			for (size_t i = 0; i < plane_count; i++) {
+				basic_vector<T, 3> corner;
+				for (size_t c = 0; c < 3; c++)
+					corner[c] = planes[i][c] >= T(0) ? maximum[c] : minimum[c];
+				if (distance(i, corner) < T(0))
+					return false;
+			}
+			return true;
+		}
+		bool intersects(basic_aabb<T, 3> const& box) const {
+			return !box.empty() && intersects(box.minimum(), box.maximum());
+		}
+	};
+
+	// Visibility bitmasks: bit i % 64 of word i / 64 is set when object i may be visible.
+	inline size_t visibility_words(size_t count) {
+		return (count + 63) / 64;
+	}
+	inline bool is_visible(uint64_t const* visible, size_t index) {
+		return (visible[index / 64] >> (index % 64)) & 1u;
+	}
+	inline size_t visible_count(uint64_t const* visible, size_t count) {
+		size_t res = 0;
+		for (size_t i = 0; i < visibility_words(count); i++)
+			for (uint64_t word = visible[i]; word; word &= word - 1)
+				res++;
+		return res;
+	}
+
+	// Batch tests of structure-of-arrays spheres and boxes against all six planes, a SIMD group
+	// of objects at a time; every result matches the scalar test. All visibility_words(count)
+	// words are overwritten, so a range of objects starting at a multiple of 64 can be culled
+	// into its own words, e.g. by one task of a thread pool.
+	template<typename T>
+	void cull_spheres(basic_frustum<T> const& f, T const* x, T const* y, T const* z, T const* radii, size_t count, uint64_t* visible) {
+		using frustum = basic_frustum<T>;
+		std::fill(visible, visible + visibility_words(count), uint64_t(0));
+		size_t i = 0;
+		if constexpr (simd::lanes<T>::accelerated) {
+			using L = simd::lanes<T>;
+			typename L::type planes[frustum::plane_count][4];
+			for (size_t k = 0; k < frustum::plane_count; k++)
+				for (size_t c = 0; c < 4; c++)
+					planes[k][c] = L::broadcast(f.plane(k)[c]);
+			for (; i < count - count % L::width; i += L::width) {
+				auto const cx = L::load(x + i), cy = L::load(y + i), cz = L::load(z + i);
+				auto const limit = L::sub(L::broadcast(T(0)), L::load(radii + i));
+				int outside = 0;
+				for (size_t k = 0; k < frustum::plane_count; k++) {
+					auto const d = L::add(L::add(L::add(L::mul(planes[k][0], cx), L::mul(planes[k][1], cy)), L::mul(planes[k][2], cz)), planes[k][3]);
+					outside |= L::less_mask(d, limit);
+				}
+				visible[i / 64] |= uint64_t(~outside & ((1 << L::width) - 1)) << (i % 64);
+			}
+		}
+		for (; i < count; i++)
+			if (f.intersects(basic_vector<T, 3>(x[i], y[i], z[i]), radii[i]))
+				visible[i / 64] |= uint64_t(1) << (i % 64);
+	}
+	template<typename T>
+	void cull_boxes(basic_frustum<T> const& f, T const* const minima[3], T const* const maxima[3], size_t count, uint64_t* visible) {
+		using frustum = basic_frustum<T>;
+		std::fill(visible, visible + visibility_words(count), uint64_t(0));
+		size_t i = 0;
+		if constexpr (simd::lanes<T>::accelerated) {
+			using L = simd::lanes<T>;
+			typename L::type planes[frustum::plane_count][4];
+			bool positive[frustum::plane_count][3];
+			for (size_t k = 0; k < frustum::plane_count; k++) {
+				for (size_t c = 0; c < 4; c++)
+					planes[k][c] = L::broadcast(f.plane(k)[c]);
+				for (size_t c = 0; c < 3; c++)
+					positive[k][c] = f.plane(k)[c] >= T(0);
+			}
+			for (; i < count - count % L::width; i += L::width) {
+				typename L::type const low[3] = {L::load(minima[0] + i), L::load(minima[1] + i), L::load(minima[2] + i)};
+				typename L::type const high[3] = {L::load(maxima[0] + i), L::load(maxima[1] + i), L::load(maxima[2] + i)};
+				auto const zero = L::broadcast(T(0));
+				int outside = 0;
+				for (size_t k = 0; k < frustum::plane_count; k++) {
+					auto const& cx = positive[k][0] ? high[0] : low[0];
+					auto const& cy = positive[k][1] ? high[1] : low[1];
+					auto const& cz = positive[k][2] ? high[2] : low[2];
+					auto const d = L::add(L::add(L::add(L::mul(planes[k][0], cx), L::mul(planes[k][1], cy)), L::mul(planes[k][2], cz)), planes[k][3]);
+					outside |= L::less_mask(d, zero);
+				}
+				visible[i / 64] |= uint64_t(~outside & ((1 << L::width) - 1)) << (i % 64);
+			}
+		}
+		for (; i < count; i++)
+			if (f.intersects(basic_vector<T, 3>(minima[0][i], minima[1][i], minima[2][i]), basic_vector<T, 3>(maxima[0][i], maxima[1][i], maxima[2][i])))
+				visible[i / 64] |= uint64_t(1) << (i % 64);
+	}
+
+	template<typename T>
+	std::vector<uint64_t> cull_spheres(basic_frustum<T> const& f, vector_batch<T, 3> const& centers, std::vector<T> const& radii) {
+		if (centers.size() != radii.size())
+			throw Exceptions::VectorBatchSizeMismatch("There has to be one radius per center.");
+		std::vector<uint64_t> res(visibility_words(centers.size()));
+		cull_spheres(f, centers.x(), centers.y(), centers.z(), radii.data(), centers.size(), res.data());
+		return res;
+	}
+	template<typename T>
+	std::vector<uint64_t> cull_boxes(basic_frustum<T> const& f, vector_batch<T, 3> const& minima, vector_batch<T, 3> const& maxima) {
+		if (minima.size() != maxima.size())
+			throw Exceptions::VectorBatchSizeMismatch("Batches have different sizes.");
+		T const* const low[3] = {minima.x(), minima.y(), minima.z()};
+		T const* const high[3] = {maxima.x(), maxima.y(), maxima.z()};
+		std::vector<uint64_t> res(visibility_words(minima.size()));
+		cull_boxes(f, low, high, minima.size(), res.data());
+		return res;
+	}
+
+	class frustumf : public basic_frustum<float> { public: using basic_frustum::basic_frustum; };
+	class frustumd : public basic_frustum<double> { public: using basic_frustum::basic_frustum; };
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+#pragma once
+#include <cmath>
+#include <limits>
+
+#include "mml/aabb.hpp"
+
+namespace mml {
+	// Half-line origin + t * direction, t >= 0. The direction does not have to be unit length;
+	// distances along the ray are then measured in multiples of it.
+	template<typename T>
+	class basic_ray {
+	public:
+		basic_vector<T, 3> origin, direction;
+
+		constexpr basic_ray() {}
+		constexpr basic_ray(basic_vector<T, 3> const& origin, basic_vector<T, 3> const& direction) : origin(origin), direction(direction) {}
+		constexpr basic_vector<T, 3> at(T const& t) const {
+			basic_vector<T, 3> res;
+			for (size_t i = 0; i < 3; i++)
+				res[i] = origin[i] + direction[i] * t;
+			return res;
+		}
+	};
+	template<typename T>
+	class basic_sphere {
+	public:
+		basic_vector<T, 3> center;
+		T radius;
+
+		constexpr basic_sphere() : radius(T(0)) {}
+		constexpr basic_sphere(basic_vector<T, 3> const& center, T const& radius) : center(center), radius(radius) {}
+	};
+	template<typename T>
+	class basic_triangle {
+	public:
+		basic_vector<T, 3> a, b, c;
+
+		constexpr basic_triangle() {}
+		constexpr basic_triangle(basic_vector<T, 3> const& a, basic_vector<T, 3> const& b, basic_vector<T, 3> const& c) : a(a), b(b), c(c) {}
+	};
+
+	// Bounds, squared distances from a point and ray distances of the primitives, as used by
+	// basic_bvh. A ray that misses a primitive is infinitely far from it.
+	template<typename T, size_t S>
+	constexpr basic_aabb<T, S> bounds(basic_vector<T, S> const& point) {
+		return basic_aabb<T, S>(point, point);
+	}
+	template<typename T>
+	constexpr basic_aabb<T, 3> bounds(basic_sphere<T> const& sphere) {
+		return basic_aabb<T, 3>::from_center(sphere.center, basic_vector<T, 3>(sphere.radius, sphere.radius, sphere.radius));
+	}
+	template<typename T>
+	constexpr basic_aabb<T, 3> bounds(basic_triangle<T> const& triangle) {
+		return basic_aabb<T, 3>().expand(triangle.a).expand(triangle.b).expand(triangle.c);
+	}
+
+	template<typename T, size_t S>
+	constexpr T squared_distance(basic_vector<T, S> const& point, basic_vector<T, S> const& other) {
+		T res = T(0);
+		for (size_t i = 0; i < S; i++)
+			res += (point.element(i) - other.element(i)) * (point.element(i) - other.element(i));
+		return res;
+	}
+	template<typename T>
+	T squared_distance(basic_vector<T, 3> const& point, basic_sphere<T> const& sphere) {
+		T const d = T(std::sqrt(squared_distance(point, sphere.center))) - sphere.radius;
+		return d > T(0) ? d * d : T(0);
+	}
+	// Zero inside the box.
+	template<typename T, size_t S>
+	constexpr T squared_distance(basic_vector<T, S> const& point, basic_aabb<T, S> const& box) {
+		T res = T(0);
+		for (size_t i = 0; i < S; i++) {
+			T const d = std::max(std::max(box.minimum().element(i) - point.element(i), point.element(i) - box.maximum().element(i)), T(0));
+			res += d * d;
+		}
+		return res;
+	}
+	// The Voronoi region search of Ericson, Real-Time Collision Detection, 5.1.5.
+	template<typename T>
+	constexpr basic_vector<T, 3> closest_point(basic_vector<T, 3> const& p, basic_triangle<T> const& t) {
+		basic_vector<T, 3> const ab = t.b - t.a, ac = t.c - t.a, ap = p - t.a;
+		T const d1 = dot(ab, ap), d2 = dot(ac, ap);
+		if (d1 <= T(0) && d2 <= T(0))
+			return t.a;
+		basic_vector<T, 3> const bp = p - t.b;
+		T const d3 = dot(ab, bp), d4 = dot(ac, bp);
+		if (d3 >= T(0) && d4 <= d3)
+			return t.b;
+		T const vc = d1 * d4 - d3 * d2;
+		if (vc <= T(0) && d1 >= T(0) && d3 <= T(0))
+			return t.a + ab * (d1 / (d1 - d3));
+		basic_vector<T, 3> const cp = p - t.c;
+		T const d5 = dot(ab, cp), d6 = dot(ac, cp);
+		if (d6 >= T(0) && d5 <= d6)
+			return t.c;
+		T const vb = d5 * d2 - d1 * d6;
+		if (vb <= T(0) && d2 >= T(0) && d6 <= T(0))
+			return t.a + ac * (d2 / (d2 - d6));
+		T const va = d3 * d6 - d5 * d4;
+		if (va <= T(0) && d4 - d3 >= T(0) && d5 - d6 >= T(0))
+			return t.b + (t.c - t.b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+		T const denominator = T(1) / (va + vb + vc);
+		return t.a + ab * (vb * denominator) + ac * (vc * denominator);
+	}
+	template<typename T>
+	constexpr T squared_distance(basic_vector<T, 3> const& point, basic_triangle<T> const& triangle) {
+		return squared_distance(point, closest_point(point, triangle));
+	}
+
+	// The nearer intersection in front of the origin, or the farther one from inside.
+	template<typename T>
+	T intersect(basic_ray<T> const& ray, basic_sphere<T> const& sphere) {
+		basic_vector<T, 3> const offset = ray.origin - sphere.center;
+		T const a = dot(ray.direction, ray.direction), b = dot(ray.direction, offset);
+		T const discriminant = b * b - a * (dot(offset, offset) - sphere.radius * sphere.radius);
+		if (discriminant < T(0) || a == T(0))
+			return std::numeric_limits<T>::infinity();
+		T const root = T(std::sqrt(discriminant));
+		T t = (-b - root) / a;
+		if (t < T(0))
+			t = (-b + root) / a;
+		return t >= T(0) ? t : std::numeric_limits<T>::infinity();
+	}
+	// Möller and Trumbore; both sides of the triangle are hit and rays in its plane miss it.
+	template<typename T>
+	constexpr T intersect(basic_ray<T> const& ray, basic_triangle<T> const& triangle) {
+		basic_vector<T, 3> const e1 = triangle.b - triangle.a, e2 = triangle.c - triangle.a;
+		basic_vector<T, 3> const p = cross(ray.direction, e2);
+		T const determinant = dot(e1, p);
+		if (determinant == T(0))
+			return std::numeric_limits<T>::infinity();
+		T const inverse = T(1) / determinant;
+		basic_vector<T, 3> const s = ray.origin - triangle.a;
+		T const u = dot(s, p) * inverse;
+		if (u < T(0) || u > T(1))
+			return std::numeric_limits<T>::infinity();
+		basic_vector<T, 3> const q = cross(s, e1);
+		T const v = dot(ray.direction, q) * inverse;
+		if (v < T(0) || u + v > T(1))
+			return std::numeric_limits<T>::infinity();
+		T const t = dot(e2, q) * inverse;
+		return t >= T(0) ? t : std::numeric_limits<T>::infinity();
+	}
+
+	class ray3f : public basic_ray<float> { public: using basic_ray::basic_ray; };
+	class ray3d : public basic_ray<double> { public: using basic_ray::basic_ray; };
+	class sphere3f : public basic_sphere<float> { public: using basic_sphere::basic_sphere; };
+	class sphere3d : public basic_sphere<double> { public: using basic_sphere::basic_sphere; };
+	class triangle3f : public basic_triangle<float> { public: using basic_triangle::basic_triangle; };
+	class triangle3d : public basic_triangle<double> { public: using basic_triangle::basic_triangle; };
+}
\ No newline at end of file
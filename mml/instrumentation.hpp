@@ -0,0 +1,268 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "mml/math.hpp"
+
+// Opt-in instrumentation. With MML_INSTRUMENTATION defined to 1, vectors and matrices count
+// their constructions, copies and moves, products and other hot operations their flops, and
+// every MML exception counts itself, all in counters owned by the calling thread.
+// MMLInstrumentedRegion(name) times the rest of the enclosing scope. With the default of 0
+// the counting macros expand to nothing and the counted base classes are empty.
+#ifndef MML_INSTRUMENTATION
+#define MML_INSTRUMENTATION 0
+#endif
+
+#if MML_INSTRUMENTATION
+#if !defined(MML_CONSTANT_EVALUATION)
+#error "Instrumentation needs __builtin_is_constant_evaluated to keep vectors and matrices usable in constant expressions."
+#endif
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <string>
+#endif
+
+namespace mml::instrumentation {
+	enum counter {
+		vector_constructions, vector_copies, vector_moves,
+		matrix_constructions, matrix_copies, matrix_moves,
+		products, flops, exceptions, counter_count
+	};
+
+	// Region names are interned, so equal names share one address however they were built.
+	struct region_statistics {
+		char const* name;
+		uint64_t calls;
+		uint64_t nanoseconds;
+	};
+	struct snapshot {
+		uint64_t values[counter_count] = {};
+		std::vector<region_statistics> regions;
+
+		uint64_t operator[](counter c) const {
+			return values[c];
+		}
+		// Difference between two snapshots, e.g. the work done by one frame.
+		snapshot operator-(snapshot const& earlier) const {
+			snapshot res(*this);
+			for (size_t i = 0; i < counter_count; i++)
+				res.values[i] -= earlier.values[i];
+			for (auto& region : res.regions)
+				for (auto const& other : earlier.regions)
+					if (region.name == other.name) {
+						region.calls -= other.calls;
+						region.nanoseconds -= other.nanoseconds;
+					}
+			return res;
+		}
+		snapshot& operator+=(snapshot const& other) {
+			for (size_t i = 0; i < counter_count; i++)
+				values[i] += other.values[i];
+			for (auto const& region : other.regions) {
+				size_t i = 0;
+				while (i < regions.size() && regions[i].name != region.name)
+					i++;
+				if (i == regions.size())
+					regions.push_back({region.name, 0, 0});
+				regions[i].calls += region.calls;
+				regions[i].nanoseconds += region.nanoseconds;
+			}
+			return *this;
+		}
+	};
+
+	// thread: the counters of the calling thread. process: the sum over all threads, including
+	// the ones that have already exited.
+	enum class scope { thread, process };
+
+#if MML_INSTRUMENTATION
+	// Every thread registers its counters on first use. Only the owning thread writes them, so
+	// relaxed loads and stores suffice and snapshots of other threads are merely approximate.
+	class thread_counters {
+	protected:
+		std::atomic<uint64_t> values[counter_count];
+		std::mutex regions_lock;
+		std::vector<region_statistics> regions;
+	public:
+		thread_counters() {
+			reset();
+		}
+		void add(counter c, uint64_t n) {
+			values[c].store(values[c].load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+		}
+		void add_region(char const* name, uint64_t nanoseconds);
+		snapshot take() {
+			snapshot res;
+			for (size_t i = 0; i < counter_count; i++)
+				res.values[i] = values[i].load(std::memory_order_relaxed);
+			std::lock_guard<std::mutex> guard(regions_lock);
+			res.regions = regions;
+			return res;
+		}
+		void reset() {
+			for (auto& value : values)
+				value.store(0, std::memory_order_relaxed);
+			std::lock_guard<std::mutex> guard(regions_lock);
+			regions.clear();
+		}
+	};
+
+	class registry {
+	protected:
+		std::mutex lock;
+		std::vector<thread_counters*> threads;
+		snapshot retired;
+		std::mutex names_lock;
+		std::set<std::string> names;
+	public:
+		char const* intern(char const* name) {
+			std::lock_guard<std::mutex> guard(names_lock);
+			return names.insert(name).first->c_str();
+		}
+		void add(thread_counters* counters) {
+			std::lock_guard<std::mutex> guard(lock);
+			threads.push_back(counters);
+		}
+		void remove(thread_counters* counters) {
+			std::lock_guard<std::mutex> guard(lock);
+			retired += counters->take();
+			for (size_t i = 0; i < threads.size(); i++)
+				if (threads[i] == counters) {
+					threads.erase(threads.begin() + i);
+					break;
+				}
+		}
+		snapshot take() {
+			std::lock_guard<std::mutex> guard(lock);
+			snapshot res = retired;
+			for (auto counters : threads)
+				res += counters->take();
+			return res;
+		}
+		void reset() {
+			std::lock_guard<std::mutex> guard(lock);
+			retired = snapshot();
+			for (auto counters : threads)
+				counters->reset();
+		}
+	};
+	// Never destroyed, as threads of static thread pools may exit after static destruction.
+	inline registry& global_registry() {
+		static registry* r = new registry;
+		return *r;
+	}
+
+	// The name is compared by its characters, as literals of different translation units and
+	// names built at runtime have their own addresses, and interned the first time it is seen.
+	inline void thread_counters::add_region(char const* name, uint64_t nanoseconds) {
+		std::lock_guard<std::mutex> guard(regions_lock);
+		for (auto& region : regions)
+			if (region.name == name || std::strcmp(region.name, name) == 0) {
+				region.calls++;
+				region.nanoseconds += nanoseconds;
+				return;
+			}
+		regions.push_back({global_registry().intern(name), 1, nanoseconds});
+	}
+
+	class registered_counters : public thread_counters {
+	public:
+		registered_counters() {
+			global_registry().add(this);
+		}
+		~registered_counters() {
+			global_registry().remove(this);
+		}
+	};
+	inline thread_counters& local() {
+		static thread_local registered_counters counters;
+		return counters;
+	}
+	inline void count(counter c, uint64_t n) {
+		local().add(c, n);
+	}
+
+	inline snapshot take(scope s = scope::thread) {
+		return s == scope::thread ? local().take() : global_registry().take();
+	}
+	inline void reset(scope s = scope::thread) {
+		if (s == scope::thread)
+			local().reset();
+		else
+			global_registry().reset();
+	}
+
+	class scoped_region {
+	protected:
+		char const* name;
+		std::chrono::steady_clock::time_point start;
+	public:
+		explicit scoped_region(char const* name) : name(name), start(std::chrono::steady_clock::now()) {}
+		scoped_region(scoped_region const&) = delete;
+		scoped_region& operator=(scoped_region const&) = delete;
+		~scoped_region() {
+			auto const elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+			local().add_region(name, uint64_t(elapsed.count()));
+		}
+	};
+
+	// Empty base of the vector and matrix classes that counts how they are created. The owner
+	// only makes the type distinct for every class, so that the base never prevents the empty
+	// base optimization or a standard layout. An object made of Rows vectors, which are
+	// constructed, copied, moved and assigned along with it, takes back their counts, so that
+	// a matrix counts once as a matrix and never as its rows.
+	template<counter Constructions, typename Owner, size_t Rows = 0>
+	struct counted {
+	protected:
+		static void count_as(size_t kind) {
+			count(counter(Constructions + kind), 1);
+			if constexpr (Rows != 0)
+				count(counter(vector_constructions + kind), uint64_t(0) - uint64_t(Rows));
+		}
+	public:
+		constexpr counted() {
+			if (!MMLIsConstantEvaluated())
+				count_as(0);
+		}
+		constexpr counted(counted const&) {
+			if (!MMLIsConstantEvaluated())
+				count_as(1);
+		}
+		constexpr counted(counted&&) {
+			if (!MMLIsConstantEvaluated())
+				count_as(2);
+		}
+		constexpr counted& operator=(counted const&) {
+			if (!MMLIsConstantEvaluated())
+				count_as(1);
+			return *this;
+		}
+		constexpr counted& operator=(counted&&) {
+			if (!MMLIsConstantEvaluated())
+				count_as(2);
+			return *this;
+		}
+	};
+#else
+	inline snapshot take(scope = scope::thread) {
+		return snapshot();
+	}
+	inline void reset(scope = scope::thread) {}
+
+	template<counter Constructions, typename Owner, size_t Rows = 0>
+	struct counted {};
+#endif
+}
+
+#if MML_INSTRUMENTATION
+#define MMLInstrumentationConcatenate(a, b) a##b
+#define MMLInstrumentationName(line) MMLInstrumentationConcatenate(mml_instrumented_region_, line)
+#define MMLCount(name, n) do { if (!MMLIsConstantEvaluated()) mml::instrumentation::count(mml::instrumentation::name, uint64_t(n)); } while (false)
+#define MMLInstrumentedRegion(name) mml::instrumentation::scoped_region MMLInstrumentationName(__LINE__)(name)
+#else
+#define MMLCount(name, n) ((void) 0)
+#define MMLInstrumentedRegion(name) ((void) 0)
+#endif
\ No newline at end of file
@@ -1,3 +1,22 @@
 #include "vector.hpp"
 #include "matrix.hpp"
-#include "transformation.hpp"
\ No newline at end of file
+#include "transformation.hpp"
+#include "vector_batch.hpp"
+#include "parallel.hpp"
+#include "aligned_allocator.hpp"
+#include "dynamic_matrix.hpp"
+#include "decomposition.hpp"
+#include "dynamic_decomposition.hpp"
+#include "quaternion.hpp"
+#include "affine_transformation.hpp"
+#include "transform_tree.hpp"
+#include "aligned.hpp"
+#include "instrumentation.hpp"
+#include "array_file.hpp"
+#include "storage.hpp"
+#include "frustum.hpp"
+#include "aabb.hpp"
+#include "geometry.hpp"
+#include "bvh.hpp"
+#include "sparse_matrix.hpp"
+#include "dynamic_vector.hpp"
\ No newline at end of file
@@ -0,0 +1,183 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include "mml/simd.hpp"
+
+// With MML_FAST_TRIGONOMETRY defined to 1, math::sincos, and with it every rotation builder,
+// uses the polynomial approximation of math::fast_sincos instead of the C library.
+#ifndef MML_FAST_TRIGONOMETRY
+#define MML_FAST_TRIGONOMETRY 0
+#endif
+
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define MML_CONSTANT_EVALUATION
+#endif
+#endif
+#if !defined(MML_CONSTANT_EVALUATION) && ((defined(__GNUC__) && __GNUC__ >= 9) || (defined(_MSC_VER) && _MSC_VER >= 1925))
+#define MML_CONSTANT_EVALUATION
+#endif
+
+#if defined(MML_CONSTANT_EVALUATION)
+#define MMLIsConstantEvaluated() __builtin_is_constant_evaluated()
+#else
+#define MMLIsConstantEvaluated() false
+#endif
+
+namespace mml::math {
+	template<typename T> constexpr T pi = T(3.141592653589793238462643383279502884L);
+
+	// Constant-expression fallbacks. They are only picked during constant evaluation, where
+	// they agree with the C library to within an ulp for arguments up to a few thousand radians.
+	template<typename T>
+	constexpr T constexpr_sqrt(T x) {
+		if (x != x || x < T(0))
+			return std::numeric_limits<T>::quiet_NaN();
+		if (x == T(0) || x == std::numeric_limits<T>::infinity())
+			return x;
+		long double current = x > T(1) ? x : T(1), previous = current * 2;
+		while (current < previous) {
+			previous = current;
+			current = (current + x / current) / 2;
+		}
+		return T(previous);
+	}
+	template<typename T>
+	constexpr long double constexpr_reduce(T x) {
+		long double const two_pi = 2 * pi<long double>;
+		long double r = x;
+		long double turns = r / two_pi;
+		long long k = (long long) (turns < 0 ? turns - 0.5L : turns + 0.5L);
+		return r - k * two_pi;
+	}
+	template<typename T>
+	constexpr T constexpr_sin(T x) {
+		long double r = constexpr_reduce(x), sum = r, term = r;
+		for (int n = 1; n < 40 && term != 0; n++) {
+			term *= -r * r / ((2 * n) * (2 * n + 1));
+			sum += term;
+		}
+		return T(sum);
+	}
+	template<typename T>
+	constexpr T constexpr_cos(T x) {
+		long double r = constexpr_reduce(x), sum = 1, term = 1;
+		for (int n = 1; n < 40 && term != 0; n++) {
+			term *= -r * r / ((2 * n - 1) * (2 * n));
+			sum += term;
+		}
+		return T(sum);
+	}
+
+	template<typename T>
+	constexpr T abs(T x) {
+		return x < T(0) ? -x : x;
+	}
+	template<typename T>
+	constexpr auto sqrt(T x) {
+		using result_type = typename std::conditional<std::is_integral<T>::value, double, T>::type;
+		if (MMLIsConstantEvaluated())
+			return constexpr_sqrt(result_type(x));
+		return result_type(std::sqrt(x));
+	}
+	template<typename T>
+	constexpr T sin(T x) {
+		if (MMLIsConstantEvaluated())
+			return constexpr_sin(x);
+		return std::sin(x);
+	}
+	template<typename T>
+	constexpr T cos(T x) {
+		if (MMLIsConstantEvaluated())
+			return constexpr_cos(x);
+		return std::cos(x);
+	}
+
+	template<typename T>
+	struct sine_cosine {
+		T sin;
+		T cos;
+	};
+
+	// Reduction by pi / 2 in three parts (Cody-Waite) and the single precision minimax
+	// polynomials of Cephes on [-pi / 4, pi / 4]. For |x| <= 8192 the absolute error is below
+	// 1e-7 in float, about one ulp, and 3e-9 in double. Larger arguments, where the reduction
+	// loses its accuracy and the quadrant its integer range, infinities and NaN go to sin and
+	// cos. Also usable in constant expressions.
+	template<typename T>
+	struct fast_trigonometry {
+		static constexpr T limit = T(8192);
+		static constexpr T two_over_pi = T(0.636619772367581343075535053490057448L);
+		static constexpr T half_pi_1 = T(1.5703125L);
+		static constexpr T half_pi_2 = T(4.837512969970703125e-4L);
+		static constexpr T half_pi_3 = T(7.54978995489188216e-8L);
+		static constexpr T sin_1 = T(-1.6666654611e-1L);
+		static constexpr T sin_2 = T(8.3321608736e-3L);
+		static constexpr T sin_3 = T(-1.9515295891e-4L);
+		static constexpr T cos_1 = T(4.166664568298827e-2L);
+		static constexpr T cos_2 = T(-1.388731625493765e-3L);
+		static constexpr T cos_3 = T(2.443315711809948e-5L);
+	};
+	template<typename T>
+	constexpr sine_cosine<T> fast_sincos(T x) {
+		using F = fast_trigonometry<T>;
+		if (!(x >= -F::limit && x <= F::limit))
+			return {sin(x), cos(x)};
+		T const turns = x * F::two_over_pi;
+		int32_t const quadrant = int32_t(turns < T(0) ? turns - T(0.5) : turns + T(0.5));
+		T const q = T(quadrant);
+		T const r = ((x - q * F::half_pi_1) - q * F::half_pi_2) - q * F::half_pi_3;
+		T const r2 = r * r;
+		T const s = r + r * r2 * (F::sin_1 + r2 * (F::sin_2 + r2 * F::sin_3));
+		T const c = (r2 * r2 * (F::cos_1 + r2 * (F::cos_2 + r2 * F::cos_3)) - T(0.5) * r2) + T(1);
+		sine_cosine<T> res = {quadrant & 1 ? c : s, quadrant & 1 ? s : c};
+		if (quadrant & 2)
+			res.sin = -res.sin;
+		if ((quadrant + 1) & 2)
+			res.cos = -res.cos;
+		return res;
+	}
+
+	// Both functions of one angle, in one C library call where the library has one.
+	template<typename T>
+	constexpr sine_cosine<T> sincos(T x) {
+#if MML_FAST_TRIGONOMETRY
+		if constexpr (std::is_same<T, float>::value || std::is_same<T, double>::value)
+			return fast_sincos(x);
+#endif
+		if (MMLIsConstantEvaluated())
+			return {constexpr_sin(x), constexpr_cos(x)};
+#if defined(__GLIBC__)
+		sine_cosine<T> res = {};
+		if constexpr (std::is_same<T, float>::value) {
+			::sincosf(x, &res.sin, &res.cos);
+			return res;
+		} else if constexpr (std::is_same<T, double>::value) {
+			::sincos(x, &res.sin, &res.cos);
+			return res;
+		}
+#endif
+		return {std::sin(x), std::cos(x)};
+	}
+	// sincos of count angles. In fast trigonometry mode the kernel of simd.hpp handles all but
+	// the last few, with the same results as the scalar function.
+	template<typename T>
+	void sincos(T const* x, T* sines, T* cosines, size_t count) {
+		size_t i = 0;
+#if MML_FAST_TRIGONOMETRY
+		using K = simd::trigonometry_kernel<T>;
+		if constexpr (K::accelerated)
+			for (; i + K::width <= count; i += K::width)
+				K::template sincos<fast_trigonometry<T>>(sines + i, cosines + i, x + i);
+#endif
+		for (; i < count; i++) {
+			auto const res = sincos(x[i]);
+			sines[i] = res.sin;
+			cosines[i] = res.cos;
+		}
+	}
+}
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include "mml/exceptions.hpp"
 DefineNewMMLException(MatrixIndexOutOfBounds);
+DefineNewMMLException(MatrixIsSingular);
 
 namespace mml {
 	enum MatrixValue { ZeroMatrix = 0, IdentityMatrix = 1 };
@@ -15,10 +16,10 @@ namespace mml {
 		using base_type::data;
 	protected:
 		template <typename... Tail>
-		void set_values(size_t r, size_t c) {}
+		constexpr void set_values(size_t r, size_t c) {}
 		template <typename... Tail>
-		void set_values(size_t r, size_t c, typename std::enable_if<sizeof...(Tail) + 1 <= R * C, T>::type const& head, Tail ...tail) {
-			data[r][c] = head;
+		constexpr void set_values(size_t r, size_t c, typename std::enable_if<sizeof...(Tail) + 1 <= R * C, T>::type const& head, Tail ...tail) {
+			data[r].element(c) = head;
 			if (++c == C) {
 				++r;
 				c = 0u;
@@ -27,66 +28,73 @@ namespace mml {
 		}
 
 		template <typename... Tail>
-		void set_rows(size_t r) {}
+		constexpr void set_rows(size_t r) {}
 		template <typename... Tail>
-		void set_rows(size_t r, typename std::enable_if<sizeof...(Tail) + 1 <= R, row_type>::type const& head, Tail ...tail) {
-			data[r] = head;
-			set_rows(++r, row_type(tail)...);
+		constexpr void set_rows(size_t r, typename std::enable_if<sizeof...(Tail) + 1 <= R, row_type>::type const& head, Tail ...tail) {
+			for (size_t c = 0; c < C; c++)
+				data[r].element(c) = head.element(c);
+			set_rows(++r, tail...);
 		}
 	public:
-		basic_matrix(MatrixValue mv = IdentityMatrix) : basic_vector<basic_vector<T, C>, R>() {
+		constexpr basic_matrix(MatrixValue mv = IdentityMatrix) : basic_vector<basic_vector<T, C>, R>() {
 			if (mv == IdentityMatrix)
 			for (size_t i = 0; i < std::min(R, C); i++)
-				data[i][i] = T(1);
+				data[i].element(i) = T(1);
 		}
-		basic_matrix(basic_matrix<T, R, C> const& other) : basic_vector<basic_vector<T, C>, R>(other) {}
-		basic_matrix(basic_matrix<T, R, C> &&other) : basic_vector<basic_vector<T, C>, R>(other) {}
+		constexpr basic_matrix(basic_matrix<T, R, C> const& other) = default;
+		constexpr basic_matrix(basic_matrix<T, R, C> &&other) = default;
 		template <typename... Tail>
-		basic_matrix(typename std::enable_if<sizeof...(Tail) + 1 <= R * C, T>::type const& head = T(0), Tail... tail) : basic_vector<basic_vector<T, C>, R>() {
+		constexpr basic_matrix(typename std::enable_if<sizeof...(Tail) + 1 <= R * C, T>::type const& head = T(0), Tail... tail) : basic_vector<basic_vector<T, C>, R>() {
 			set_values(0, 0, head, tail...);
 		}
 		template <typename... Tail>
-		basic_matrix(typename std::enable_if<sizeof...(Tail) + 1 <= R, row_type>::type const& head = row_type(0), Tail... tail) : basic_vector<basic_vector<T, C>, R>() {
+		constexpr basic_matrix(typename std::enable_if<sizeof...(Tail) + 1 <= R, row_type>::type const& head = row_type(0), Tail... tail) : basic_vector<basic_vector<T, C>, R>() {
 			set_rows(0, head, tail...);
 		}
-		basic_matrix(std::initializer_list<std::initializer_list<T>> const& list) : basic_vector<basic_vector<T, C>, R>() {
+		constexpr basic_matrix(std::initializer_list<std::initializer_list<T>> const& list) : basic_vector<basic_vector<T, C>, R>() {
 			if (list.size() > R)
 				throw Exceptions::MatrixIndexOutOfBounds("Too many inputs.");
 			size_t r = 0;
 			for (auto &it : list) {
 				if (it.size() > C)
 					throw Exceptions::MatrixIndexOutOfBounds("Too many inputs.");
-				data[r++] = row_type(it);
+				size_t c = 0;
+				for (auto const& value : it)
+					data[r].element(c++) = value;
+				r++;
 			}
 		}
-		basic_matrix(std::initializer_list<std::initializer_list<T>> &&list) : basic_vector<basic_vector<T, C>, R>() {
+		constexpr basic_matrix(std::initializer_list<std::initializer_list<T>> &&list) : basic_vector<basic_vector<T, C>, R>() {
 			if (list.size() > R)
 				throw Exceptions::MatrixIndexOutOfBounds("Too many inputs.");
 			size_t r = 0;
 			for (auto &it : list) {
 				if (it.size() > C)
 					throw Exceptions::MatrixIndexOutOfBounds("Too many inputs.");
-				data[r++] = row_type(it);
+				size_t c = 0;
+				for (auto const& value : it)
+					data[r].element(c++) = value;
+				r++;
 			}
 		}
-		basic_matrix(std::initializer_list<T> const& list) : basic_vector<basic_vector<T, C>, R>() {
+		constexpr basic_matrix(std::initializer_list<T> const& list) : basic_vector<basic_vector<T, C>, R>() {
 			if (list.size() > R)
 				throw Exceptions::MatrixIndexOutOfBounds("Too many inputs.");
 			size_t r = 0, c = 0;
 			for (auto &it : list) {
-				data[r][c] = it;
+				data[r].element(c) = it;
 				if (++c == C) {
 					++r;
 					c = 0;
 				}
 			}
 		}
-		basic_matrix(std::initializer_list<T> &&list) : basic_vector<basic_vector<T, C>, R>() {
+		constexpr basic_matrix(std::initializer_list<T> &&list) : basic_vector<basic_vector<T, C>, R>() {
 			if (list.size() > R * C)
 				throw Exceptions::MatrixIndexOutOfBounds("Too many inputs.");
 			size_t r = 0, c = 0;
 			for (auto &it : list) {
-				data[r][c] = it;
+				data[r].element(c) = it;
 				if (++c == C) {
 					++r;
 					c = 0;
@@ -95,222 +103,544 @@ namespace mml {
 		}
 
 		template<typename T_O, size_t R_O, size_t C_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-		basic_matrix(basic_matrix<T_O, R_O, C_O> const& other, typename std::enable_if<(R_O <= R && C_O <= C), void*>::type less = nullptr) : basic_vector<basic_vector<T, C>, R>() {
-			for (int r = 0; r < R_O; r++)
-				data[r] = basic_vector<T, C>{other[r]};
+		constexpr basic_matrix(basic_matrix<T_O, R_O, C_O> const& other, typename std::enable_if<(R_O <= R && C_O <= C), void*>::type less = nullptr) : basic_vector<basic_vector<T, C>, R>() {
+			for (size_t r = 0; r < R_O; r++)
+				for (size_t c = 0; c < C_O; c++)
+					data[r].element(c) = T(other.element(r, c));
 		}
 		template<typename T_O, size_t R_O, size_t C_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-		basic_matrix(basic_matrix<T_O, R_O, C_O> &&other, typename std::enable_if<(R_O <= R && C_O <= C), void*>::type less = nullptr) : basic_vector<basic_vector<T, C>, R>() {
-			for (int r = 0; r < R_O; r++)
-				data[r] = basic_vector<T, C>{other[r]};
+		constexpr basic_matrix(basic_matrix<T_O, R_O, C_O> &&other, typename std::enable_if<(R_O <= R && C_O <= C), void*>::type less = nullptr) : basic_vector<basic_vector<T, C>, R>() {
+			for (size_t r = 0; r < R_O; r++)
+				for (size_t c = 0; c < C_O; c++)
+					data[r].element(c) = T(other.element(r, c));
 		}
 		template<typename T_O, size_t R_O, size_t C_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-		explicit basic_matrix(basic_matrix<T_O, R_O, C_O> const& other, typename std::enable_if<(R_O > R || C_O > C), void*>::type more = nullptr) {
-			for (int r = 0; r < std::min(R, R_O); r++)
-				data[r] = row_type(other.row(r));
+		explicit constexpr basic_matrix(basic_matrix<T_O, R_O, C_O> const& other, typename std::enable_if<(R_O > R || C_O > C), void*>::type more = nullptr) {
+			for (size_t r = 0; r < std::min(R, R_O); r++)
+				for (size_t c = 0; c < std::min(C, C_O); c++)
+					data[r].element(c) = T(other.element(r, c));
 		}
 		template<typename T_O, size_t R_O, size_t C_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-		explicit basic_matrix(basic_matrix<T_O, R_O, C_O> &&other, typename std::enable_if<(R_O > R || C_O > C), void*>::type more = nullptr) {
-			for (int r = 0; r < std::min(R, R_O); r++)
-				data[r] = row_type(other.row(r));
-		}
-		basic_matrix<T, C, R> const& operator=(basic_matrix<T, C, R> const& other) {
-			std::copy(other.begin(), other.end(), data);
-			return *this;
-		}
-		basic_matrix<T, C, R> const& operator=(basic_matrix<T, C, R> &&other) {
-			std::move(other.begin(), other.end(), data);
+		explicit constexpr basic_matrix(basic_matrix<T_O, R_O, C_O> &&other, typename std::enable_if<(R_O > R || C_O > C), void*>::type more = nullptr) {
+			for (size_t r = 0; r < std::min(R, R_O); r++)
+				for (size_t c = 0; c < std::min(C, C_O); c++)
+					data[r].element(c) = T(other.element(r, c));
+		}
+		template<typename E, typename = typename std::enable_if<is_matrix_expression<E>::value && std::is_convertible<typename E::value_type, T>::value>::type>
+		constexpr basic_matrix(E const& other, typename std::enable_if<(E::rows_value <= R && E::columns_value <= C), void*>::type less = nullptr) : basic_vector<basic_vector<T, C>, R>() {
+			MMLCount(flops, E::operations * E::rows_value * E::columns_value);
+			for (size_t r = 0; r < E::rows_value; r++)
+				for (size_t c = 0; c < E::columns_value; c++)
+					data[r].element(c) = T(other.element(r, c));
+		}
+		template<typename E, typename = typename std::enable_if<is_matrix_expression<E>::value && std::is_convertible<typename E::value_type, T>::value>::type>
+		explicit constexpr basic_matrix(E const& other, typename std::enable_if<(E::rows_value > R || E::columns_value > C), void*>::type more = nullptr) : basic_vector<basic_vector<T, C>, R>() {
+			MMLCount(flops, E::operations * std::min(R, E::rows_value) * std::min(C, E::columns_value));
+			for (size_t r = 0; r < std::min(R, E::rows_value); r++)
+				for (size_t c = 0; c < std::min(C, E::columns_value); c++)
+					data[r].element(c) = T(other.element(r, c));
+		}
+		constexpr basic_matrix<T, R, C>& operator=(basic_matrix<T, R, C> const& other) = default;
+		constexpr basic_matrix<T, R, C>& operator=(basic_matrix<T, R, C> &&other) = default;
+		template<typename E>
+		constexpr auto operator=(E const& other) -> typename std::enable_if<is_matrix_expression<E>::value && (E::rows_value <= R && E::columns_value <= C), basic_matrix<T, R, C>&>::type {
+			MMLCount(flops, E::operations * E::rows_value * E::columns_value);
+			for (size_t r = 0; r < R; r++)
+				for (size_t c = 0; c < C; c++)
+					data[r].element(c) = r < E::rows_value && c < E::columns_value ? T(other.element(r, c)) : T(0);
 			return *this;
 		}
 
-		size_t size() const {
+		constexpr size_t size() const {
 			return C * R;
 		}
-		T const* begin() const {
+		constexpr T const* begin() const {
 			return base_type::begin()->begin();
 		}
-		T* begin() {
+		constexpr T* begin() {
 			return base_type::begin()->begin();
 		}
-		T const* end() const {
-			return base_type::end()->begin();
+		constexpr T const* end() const {
+			return begin() + R * C;
 		}
-		T* end() {
-			return base_type::end()->begin();
+		constexpr T* end() {
+			return begin() + R * C;
 		}
 
-		T const& at(size_t r, size_t c) const {
-			if (r >= R || c >= C)
-				throw Exceptions::MatrixIndexOutOfBounds();
-			return data[r][c];
+		constexpr T const& at(size_t r, size_t c) const noexcept(MML_BOUNDS_NOEXCEPT) {
+			CheckMMLBounds(r < R && c < C, MatrixIndexOutOfBounds);
+			return data[r].element(c);
 		}
-		T& at(size_t r, size_t c) {
-			if (r >= R || c >= C)
-				throw Exceptions::MatrixIndexOutOfBounds();
-			return data[r][c];
+		constexpr T& at(size_t r, size_t c) noexcept(MML_BOUNDS_NOEXCEPT) {
+			CheckMMLBounds(r < R && c < C, MatrixIndexOutOfBounds);
+			return data[r].element(c);
 		}
-		T const& operator()(size_t r, size_t c) const {
+		constexpr T const& operator()(size_t r, size_t c) const noexcept(MML_BOUNDS_NOEXCEPT) {
 			return at(r, c);
 		}
-		T& operator()(size_t r, size_t c) {
+		constexpr T& operator()(size_t r, size_t c) noexcept(MML_BOUNDS_NOEXCEPT) {
 			return at(r, c);
 		}
-		row_type const& operator[](size_t r) const {
-			if (r >= R)
-				throw Exceptions::MatrixIndexOutOfBounds();
-			return base_type::operator[](r);
+		constexpr T const& element(size_t r, size_t c) const noexcept {
+			return data[r].element(c);
+		}
+		constexpr T& element(size_t r, size_t c) noexcept {
+			return data[r].element(c);
 		}
-		row_type& operator[](size_t r) {
-			if (r >= R)
-				throw Exceptions::MatrixIndexOutOfBounds();
-			return base_type::operator[](r);
+		constexpr row_type const& operator[](size_t r) const noexcept(MML_BOUNDS_NOEXCEPT) {
+			CheckMMLBounds(r < R, MatrixIndexOutOfBounds);
+			return data[r];
 		}
-		basic_vector<T, C> const& row(size_t r) const {
+		constexpr row_type& operator[](size_t r) noexcept(MML_BOUNDS_NOEXCEPT) {
+			CheckMMLBounds(r < R, MatrixIndexOutOfBounds);
+			return data[r];
+		}
+		constexpr basic_vector<T, C> const& row(size_t r) const noexcept(MML_BOUNDS_NOEXCEPT) {
 			return operator[](r);
 		}
-		basic_vector<T, C>& row(size_t r) {
+		constexpr basic_vector<T, C>& row(size_t r) noexcept(MML_BOUNDS_NOEXCEPT) {
 			return operator[](r);
 		}
 
-		void fill(T const& value) {
+		constexpr void fill(T const& value) {
 			for (size_t r = 0; r < R; r++)
 				for (size_t c = 0; c < C; c++)
-					data[r][c] = value;
+					data[r].element(c) = value;
 		}
 
 		template<typename T_O, size_t R_O, size_t C_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type, typename = typename std::enable_if<(R_O <= R && C_O <= C)>::type>
-		basic_matrix<T, R, C> const& operator+=(basic_matrix<T_O, R_O, C_O> const& other) {
+		constexpr basic_matrix<T, R, C> const& operator+=(basic_matrix<T_O, R_O, C_O> const& other) {
+			MMLCount(flops, R_O * C_O);
 			for (size_t r = 0; r < std::min(R, R_O); r++)
 				for (size_t c = 0; c < std::min(C, C_O); c++)
-					data[r][c] += T(other(r, c));
+					data[r].element(c) += T(other.element(r, c));
 			return *this;
 		}
 		template<typename T_O, size_t R_O, size_t C_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type, typename = typename std::enable_if<(R_O <= R && C_O <= C)>::type>
-		basic_matrix<T, R, C> const& operator-=(basic_matrix<T_O, R_O, C_O> const& other) {
+		constexpr basic_matrix<T, R, C> const& operator-=(basic_matrix<T_O, R_O, C_O> const& other) {
+			MMLCount(flops, R_O * C_O);
 			for (size_t r = 0; r < std::min(R, R_O); r++)
 				for (size_t c = 0; c < std::min(C, C_O); c++)
-					data[r][c] -= T(other(r, c));
+					data[r].element(c) -= T(other.element(r, c));
+			return *this;
+		}
+		template<typename E>
+		constexpr auto operator+=(E const& other) -> typename std::enable_if<is_matrix_expression<E>::value && (E::rows_value <= R && E::columns_value <= C), basic_matrix<T, R, C> const&>::type {
+			MMLCount(flops, (E::operations + 1) * E::rows_value * E::columns_value);
+			for (size_t r = 0; r < E::rows_value; r++)
+				for (size_t c = 0; c < E::columns_value; c++)
+					data[r].element(c) += T(other.element(r, c));
+			return *this;
+		}
+		template<typename E>
+		constexpr auto operator-=(E const& other) -> typename std::enable_if<is_matrix_expression<E>::value && (E::rows_value <= R && E::columns_value <= C), basic_matrix<T, R, C> const&>::type {
+			MMLCount(flops, (E::operations + 1) * E::rows_value * E::columns_value);
+			for (size_t r = 0; r < E::rows_value; r++)
+				for (size_t c = 0; c < E::columns_value; c++)
+					data[r].element(c) -= T(other.element(r, c));
 			return *this;
 		}
-		template<typename T_O, size_t R, size_t C, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type, typename = typename std::enable_if<(R == C)>::type>
-		basic_matrix<T, R, C> const& operator*=(basic_matrix<T_O, R, C> const& other) {
+		template<typename T_O, size_t R_ = R, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type, typename = typename std::enable_if<(R_ == C)>::type>
+		constexpr basic_matrix<T, R, C> const& operator*=(basic_matrix<T_O, R, C> const& other) {
 			return (*this = *this * other);
 		}
 		template<typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-		basic_matrix<T, R, C> const& operator*=(T_O const& q) {
+		constexpr basic_matrix<T, R, C> const& operator*=(T_O const& q) {
+			MMLCount(flops, R * C);
 			for (size_t r = 0; r < R; r++)
 				for (size_t c = 0; c < C; c++)
-					data[r][c] *= T(q);
+					data[r].element(c) *= T(q);
 			return *this;
 		}
 		template<typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-		basic_matrix<T, R, C> const& operator/=(T_O const& q) {
+		constexpr basic_matrix<T, R, C> const& operator/=(T_O const& q) {
+			MMLCount(flops, R * C);
 			for (size_t r = 0; r < R; r++)
 				for (size_t c = 0; c < C; c++)
-					data[r][c] /= T(q);
+					data[r].element(c) /= T(q);
 			return *this;
 		}
 
-		basic_matrix<T, R, C> const operator-() const {
+		constexpr basic_matrix<T, R, C> const operator-() const {
 			basic_matrix<T, R, C> res;
-			for (size_t i = 0; i < R; i++)
-				res.data[i] = -data[i];
+			MMLCount(flops, R * C);
+			for (size_t r = 0; r < R; r++)
+				for (size_t c = 0; c < C; c++)
+					res.data[r].element(c) = -data[r].element(c);
+			return res;
+		}
+
+		template<size_t R_ = R, typename = typename std::enable_if<R_ == C>::type>
+		constexpr T determinant() const {
+			auto const a = [this](size_t r, size_t c) { return data[r].element(c); };
+			if constexpr (R == 1)
+				return a(0, 0);
+			else if constexpr (R == 2)
+				return a(0, 0) * a(1, 1) - a(0, 1) * a(1, 0);
+			else if constexpr (R == 3)
+				return a(0, 0) * (a(1, 1) * a(2, 2) - a(1, 2) * a(2, 1))
+					- a(0, 1) * (a(1, 0) * a(2, 2) - a(1, 2) * a(2, 0))
+					+ a(0, 2) * (a(1, 0) * a(2, 1) - a(1, 1) * a(2, 0));
+			else if constexpr (R == 4) {
+				T const s0 = a(0, 0) * a(1, 1) - a(1, 0) * a(0, 1), s1 = a(0, 0) * a(1, 2) - a(1, 0) * a(0, 2);
+				T const s2 = a(0, 0) * a(1, 3) - a(1, 0) * a(0, 3), s3 = a(0, 1) * a(1, 2) - a(1, 1) * a(0, 2);
+				T const s4 = a(0, 1) * a(1, 3) - a(1, 1) * a(0, 3), s5 = a(0, 2) * a(1, 3) - a(1, 2) * a(0, 3);
+				T const c0 = a(2, 0) * a(3, 1) - a(3, 0) * a(2, 1), c1 = a(2, 0) * a(3, 2) - a(3, 0) * a(2, 2);
+				T const c2 = a(2, 0) * a(3, 3) - a(3, 0) * a(2, 3), c3 = a(2, 1) * a(3, 2) - a(3, 1) * a(2, 2);
+				T const c4 = a(2, 1) * a(3, 3) - a(3, 1) * a(2, 3), c5 = a(2, 2) * a(3, 3) - a(3, 2) * a(2, 3);
+				return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+			} else {
+				// Gaussian elimination with partial pivoting, in double for integral matrices.
+				using F = typename std::conditional<std::is_floating_point<T>::value, T, double>::type;
+				basic_matrix<F, R, C> m(*this);
+				F det = F(1);
+				for (size_t k = 0; k < R; k++) {
+					size_t p = k;
+					for (size_t r = k + 1; r < R; r++)
+						if (math::abs(m.element(r, k)) > math::abs(m.element(p, k)))
+							p = r;
+					if (m.element(p, k) == F(0))
+						return T(0);
+					if (p != k) {
+						for (size_t c = k; c < C; c++) {
+							F const t = m.element(k, c);
+							m.element(k, c) = m.element(p, c);
+							m.element(p, c) = t;
+						}
+						det = -det;
+					}
+					det *= m.element(k, k);
+					for (size_t r = k + 1; r < R; r++) {
+						F const f = m.element(r, k) / m.element(k, k);
+						for (size_t c = k; c < C; c++)
+							m.element(r, c) -= f * m.element(k, c);
+					}
+				}
+				if constexpr (std::is_floating_point<T>::value)
+					return det;
+				else
+					return T(det < F(0) ? det - F(0.5) : det + F(0.5));
+			}
+		}
+		template<typename T_ = T, typename = typename std::enable_if<R == C && std::is_floating_point<T_>::value>::type>
+		constexpr basic_matrix<T, R, C> inverse() const {
+			basic_matrix<T, R, C> res(ZeroMatrix);
+			if constexpr (R == 4 && simd::inverse_kernel<T>::accelerated)
+				if (!MMLIsConstantEvaluated()) {
+					if (simd::inverse_kernel<T>::inverse(res.begin(), begin()) == T(0))
+						throw Exceptions::MatrixIsSingular("Matrix is not invertible.");
+					return res;
+				}
+			auto const a = [this](size_t r, size_t c) { return data[r].element(c); };
+			if constexpr (R <= 3) {
+				T const det = determinant();
+				if (det == T(0))
+					throw Exceptions::MatrixIsSingular("Matrix is not invertible.");
+				T const f = T(1) / det;
+				if constexpr (R == 1)
+					res.element(0, 0) = f;
+				else if constexpr (R == 2) {
+					res.element(0, 0) = a(1, 1) * f;
+					res.element(0, 1) = -a(0, 1) * f;
+					res.element(1, 0) = -a(1, 0) * f;
+					res.element(1, 1) = a(0, 0) * f;
+				} else {
+					res.element(0, 0) = (a(1, 1) * a(2, 2) - a(1, 2) * a(2, 1)) * f;
+					res.element(0, 1) = (a(0, 2) * a(2, 1) - a(0, 1) * a(2, 2)) * f;
+					res.element(0, 2) = (a(0, 1) * a(1, 2) - a(0, 2) * a(1, 1)) * f;
+					res.element(1, 0) = (a(1, 2) * a(2, 0) - a(1, 0) * a(2, 2)) * f;
+					res.element(1, 1) = (a(0, 0) * a(2, 2) - a(0, 2) * a(2, 0)) * f;
+					res.element(1, 2) = (a(0, 2) * a(1, 0) - a(0, 0) * a(1, 2)) * f;
+					res.element(2, 0) = (a(1, 0) * a(2, 1) - a(1, 1) * a(2, 0)) * f;
+					res.element(2, 1) = (a(0, 1) * a(2, 0) - a(0, 0) * a(2, 1)) * f;
+					res.element(2, 2) = (a(0, 0) * a(1, 1) - a(0, 1) * a(1, 0)) * f;
+				}
+			} else if constexpr (R == 4) {
+				T const s0 = a(0, 0) * a(1, 1) - a(1, 0) * a(0, 1), s1 = a(0, 0) * a(1, 2) - a(1, 0) * a(0, 2);
+				T const s2 = a(0, 0) * a(1, 3) - a(1, 0) * a(0, 3), s3 = a(0, 1) * a(1, 2) - a(1, 1) * a(0, 2);
+				T const s4 = a(0, 1) * a(1, 3) - a(1, 1) * a(0, 3), s5 = a(0, 2) * a(1, 3) - a(1, 2) * a(0, 3);
+				T const c0 = a(2, 0) * a(3, 1) - a(3, 0) * a(2, 1), c1 = a(2, 0) * a(3, 2) - a(3, 0) * a(2, 2);
+				T const c2 = a(2, 0) * a(3, 3) - a(3, 0) * a(2, 3), c3 = a(2, 1) * a(3, 2) - a(3, 1) * a(2, 2);
+				T const c4 = a(2, 1) * a(3, 3) - a(3, 1) * a(2, 3), c5 = a(2, 2) * a(3, 3) - a(3, 2) * a(2, 3);
+				T const det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+				if (det == T(0))
+					throw Exceptions::MatrixIsSingular("Matrix is not invertible.");
+				T const f = T(1) / det;
+				res.element(0, 0) = (a(1, 1) * c5 - a(1, 2) * c4 + a(1, 3) * c3) * f;
+				res.element(0, 1) = (-a(0, 1) * c5 + a(0, 2) * c4 - a(0, 3) * c3) * f;
+				res.element(0, 2) = (a(3, 1) * s5 - a(3, 2) * s4 + a(3, 3) * s3) * f;
+				res.element(0, 3) = (-a(2, 1) * s5 + a(2, 2) * s4 - a(2, 3) * s3) * f;
+				res.element(1, 0) = (-a(1, 0) * c5 + a(1, 2) * c2 - a(1, 3) * c1) * f;
+				res.element(1, 1) = (a(0, 0) * c5 - a(0, 2) * c2 + a(0, 3) * c1) * f;
+				res.element(1, 2) = (-a(3, 0) * s5 + a(3, 2) * s2 - a(3, 3) * s1) * f;
+				res.element(1, 3) = (a(2, 0) * s5 - a(2, 2) * s2 + a(2, 3) * s1) * f;
+				res.element(2, 0) = (a(1, 0) * c4 - a(1, 1) * c2 + a(1, 3) * c0) * f;
+				res.element(2, 1) = (-a(0, 0) * c4 + a(0, 1) * c2 - a(0, 3) * c0) * f;
+				res.element(2, 2) = (a(3, 0) * s4 - a(3, 1) * s2 + a(3, 3) * s0) * f;
+				res.element(2, 3) = (-a(2, 0) * s4 + a(2, 1) * s2 - a(2, 3) * s0) * f;
+				res.element(3, 0) = (-a(1, 0) * c3 + a(1, 1) * c1 - a(1, 2) * c0) * f;
+				res.element(3, 1) = (a(0, 0) * c3 - a(0, 1) * c1 + a(0, 2) * c0) * f;
+				res.element(3, 2) = (-a(3, 0) * s3 + a(3, 1) * s1 - a(3, 2) * s0) * f;
+				res.element(3, 3) = (a(2, 0) * s3 - a(2, 1) * s1 + a(2, 2) * s0) * f;
+			} else {
+				// Gauss-Jordan elimination with partial pivoting.
+				basic_matrix<T, R, C> m(*this);
+				res = basic_matrix<T, R, C>(IdentityMatrix);
+				for (size_t k = 0; k < R; k++) {
+					size_t p = k;
+					for (size_t r = k + 1; r < R; r++)
+						if (math::abs(m.element(r, k)) > math::abs(m.element(p, k)))
+							p = r;
+					if (m.element(p, k) == T(0))
+						throw Exceptions::MatrixIsSingular("Matrix is not invertible.");
+					if (p != k)
+						for (size_t c = 0; c < C; c++) {
+							T const t = m.element(k, c), u = res.element(k, c);
+							m.element(k, c) = m.element(p, c);
+							res.element(k, c) = res.element(p, c);
+							m.element(p, c) = t;
+							res.element(p, c) = u;
+						}
+					T const f = T(1) / m.element(k, k);
+					for (size_t c = 0; c < C; c++) {
+						m.element(k, c) *= f;
+						res.element(k, c) *= f;
+					}
+					for (size_t r = 0; r < R; r++)
+						if (r != k && m.element(r, k) != T(0)) {
+							T const g = m.element(r, k);
+							for (size_t c = 0; c < C; c++) {
+								m.element(r, c) -= g * m.element(k, c);
+								res.element(r, c) -= g * res.element(k, c);
+							}
+						}
+				}
+			}
 			return res;
 		}
+		template<typename T_ = T, typename = typename std::enable_if<R == C && std::is_floating_point<T_>::value>::type>
+		constexpr void invert() {
+			*this = inverse();
+		}
 	};
 	
+	template<typename Op, typename L, typename R>
+	class matrix_expression {
+		using left_type = typename std::decay<L>::type;
+		using right_type = typename std::decay<R>::type;
+		static const bool right_is_scalar = !is_matrix_operand<right_type>::value;
+		static const size_t left_rows = matrix_operand_traits<left_type>::rows_value;
+		static const size_t left_columns = matrix_operand_traits<left_type>::columns_value;
+		static const size_t right_rows = right_is_scalar ? left_rows : matrix_operand_traits<right_type>::rows_value;
+		static const size_t right_columns = right_is_scalar ? left_columns : matrix_operand_traits<right_type>::columns_value;
+		using left_value = typename matrix_operand_traits<left_type>::value_type;
+		using right_value = typename matrix_operand_traits<right_type>::value_type;
+	public:
+		using value_type = typename std::decay<decltype(Op::apply(std::declval<left_value>(), std::declval<right_value>()))>::type;
+		static const size_t rows_value = std::max(left_rows, right_rows);
+		static const size_t columns_value = std::max(left_columns, right_columns);
+		using result_type = basic_matrix<value_type, rows_value, columns_value>;
+		static const size_t operations = (std::is_same<Op, expression_identity>::value ? 0 : 1)
+			+ expression_operations<left_type>::value + expression_operations<right_type>::value;
+	protected:
+		expression_operand<L> left;
+		expression_operand<R> right;
+	public:
+		template<typename L_O, typename R_O>
+		constexpr matrix_expression(L_O&& l, R_O&& r) : left(std::forward<L_O>(l)), right(std::forward<R_O>(r)) {}
+
+		constexpr value_type element(size_t r, size_t c) const {
+			if constexpr (std::is_same<right_type, expression_none>::value)
+				return value_type(Op::apply(value_type(matrix_element(left, r, c)), right));
+			else if constexpr (right_is_scalar)
+				return value_type(Op::apply(value_type(matrix_element(left, r, c)), value_type(right)));
+			else {
+				if (r >= right_rows || c >= right_columns)
+					return value_type(matrix_element(left, r, c));
+				if (r >= left_rows || c >= left_columns)
+					return value_type(Op::apply(value_type(0), value_type(matrix_element(right, r, c))));
+				return value_type(Op::apply(value_type(matrix_element(left, r, c)), value_type(matrix_element(right, r, c))));
+			}
+		}
+		constexpr value_type at(size_t r, size_t c) const noexcept(MML_BOUNDS_NOEXCEPT) {
+			CheckMMLBounds(r < rows_value && c < columns_value, MatrixIndexOutOfBounds);
+			return element(r, c);
+		}
+		constexpr value_type operator()(size_t r, size_t c) const noexcept(MML_BOUNDS_NOEXCEPT) {
+			return at(r, c);
+		}
+		constexpr basic_vector<value_type, columns_value> operator[](size_t r) const noexcept(MML_BOUNDS_NOEXCEPT) {
+			CheckMMLBounds(r < rows_value, MatrixIndexOutOfBounds);
+			basic_vector<value_type, columns_value> res;
+			for (size_t c = 0; c < columns_value; c++)
+				res.element(c) = element(r, c);
+			return res;
+		}
+		constexpr basic_vector<value_type, columns_value> row(size_t r) const noexcept(MML_BOUNDS_NOEXCEPT) {
+			return operator[](r);
+		}
+		constexpr size_t size() const {
+			return rows_value * columns_value;
+		}
+
+		constexpr basic_matrix<value_type, rows_value, columns_value> eval() const {
+			return basic_matrix<value_type, rows_value, columns_value>(*this);
+		}
+	};
+
+	template<typename L, typename R>
+	struct matrix_operands : std::integral_constant<bool, is_matrix_operand<typename std::decay<L>::type>::value && is_matrix_operand<typename std::decay<R>::type>::value
+		&& std::is_convertible<typename matrix_operand_traits<typename std::decay<R>::type>::value_type, typename matrix_operand_traits<typename std::decay<L>::type>::value_type>::value> {};
+	template<typename M, typename Q>
+	struct matrix_scalar_operands : std::integral_constant<bool, is_matrix_operand<typename std::decay<M>::type>::value && is_scalar_operand<typename std::decay<Q>::type>::value
+		&& std::is_convertible<typename std::decay<Q>::type, typename matrix_operand_traits<typename std::decay<M>::type>::value_type>::value> {};
+	template<typename L, typename R>
+	struct matrix_expression_operands : std::integral_constant<bool, matrix_operands<L, R>::value
+		&& (is_matrix_expression<typename std::decay<L>::type>::value || is_matrix_expression<typename std::decay<R>::type>::value)> {};
+	template<typename L, typename R>
+	struct matrix_product_expression_operands : std::integral_constant<bool,
+		((is_matrix_operand<L>::value && (is_matrix_operand<R>::value || is_vector_operand<R>::value)) || (is_vector_operand<L>::value && is_matrix_operand<R>::value))
+		&& (is_matrix_expression<L>::value || is_matrix_expression<R>::value || is_vector_expression<L>::value || is_vector_expression<R>::value)> {};
+
 	template<typename T, size_t R, size_t C, typename T_O, size_t R_O, size_t C_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type, typename = typename std::enable_if<(R_O == R && C_O == C)>::type>
-	bool operator==(basic_matrix<T, R, C> const& v1, basic_matrix<T_O, R_O, C_O> const& v2) {
+	constexpr bool operator==(basic_matrix<T, R, C> const& v1, basic_matrix<T_O, R_O, C_O> const& v2) {
 		for (size_t i = 0; i < R; i++)
 			if (v1.row(i) != v2.row(i))
 				return false;
 		return true;
 	}
 	template<typename T, size_t R, size_t C, typename T_O, size_t R_O, size_t C_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type, typename = typename std::enable_if<(R_O == R && C_O == C)>::type>
-	bool operator!=(basic_matrix<T, R, C> const& v1, basic_matrix<T_O, R_O, C_O> const& v2) {
+	constexpr bool operator!=(basic_matrix<T, R, C> const& v1, basic_matrix<T_O, R_O, C_O> const& v2) {
 		return !(v1 == v2);
 	}
 
 	template<typename T, size_t R, size_t C, typename T_O, size_t R_O, size_t C_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type, typename = typename std::enable_if<(R_O == C)>::type>
-	auto const operator*(basic_matrix<T, R, C> const& v1, basic_matrix<T_O, R_O, C_O> const& v2) {
+	constexpr auto const operator*(basic_matrix<T, R, C> const& v1, basic_matrix<T_O, R_O, C_O> const& v2) {
 		basic_matrix<decltype(v1[0][0] * v2[0][0]), R, C_O> res(ZeroMatrix);
+		MMLCount(products, 1);
+		MMLCount(flops, 2 * R * C * C_O);
+		if constexpr (R == 4 && C == 4 && C_O == 4 && std::is_same<T, T_O>::value && simd::is_accelerated<T, 4>::value)
+			if (!MMLIsConstantEvaluated()) {
+				simd::matrix_kernel<T>::multiply(res.begin(), v1.begin(), v2.begin());
+				return res;
+			}
 		for (size_t i = 0; i < R; i++)
 			for (size_t k = 0; k < C_O; k++)
 				for (size_t j = 0; j < C; j++)
-					res[i][k] += v1[i][j] * v2[j][k];
+					res.element(i, k) += v1.element(i, j) * v2.element(j, k);
 		return res;
 	}
 	template<typename T, size_t R, size_t C, typename T_O, size_t S_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type, typename = typename std::enable_if<(S_O == C)>::type>
-	auto const operator*(basic_matrix<T, R, C> const& v1, basic_vector<T_O, S_O> const& v2) {
+	constexpr auto const operator*(basic_matrix<T, R, C> const& v1, basic_vector<T_O, S_O> const& v2) {
 		basic_vector<decltype(v1[0][0] * v2[0]), R> res;
+		MMLCount(flops, 2 * R * C);
+		if constexpr (R == 4 && C == 4 && std::is_same<T, T_O>::value && simd::is_accelerated<T, 4>::value)
+			if (!MMLIsConstantEvaluated()) {
+				simd::matrix_kernel<T>::transform(res.begin(), v1.begin(), v2.begin());
+				return res;
+			}
 		for (size_t i = 0; i < R; i++)
 			for (size_t j = 0; j < C; j++)
-				res[i] += v1[i][j] * v2[j];
+				res.element(i) += v1.element(i, j) * v2.element(j);
 		return res;
 	}
 	template<typename T, size_t R, size_t C, typename T_O, size_t S_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type, typename = typename std::enable_if<(S_O == R)>::type>
-	auto const operator*(basic_vector<T_O, S_O> const& v1, basic_matrix<T, R, C> const& v2) {
+	constexpr auto const operator*(basic_vector<T_O, S_O> const& v1, basic_matrix<T, R, C> const& v2) {
 		basic_vector<decltype(v1[0] * v2[0][0]), C> res;
+		MMLCount(flops, 2 * R * C);
+		if constexpr (R == 4 && C == 4 && std::is_same<T, T_O>::value && simd::is_accelerated<T, 4>::value)
+			if (!MMLIsConstantEvaluated()) {
+				simd::matrix_kernel<T>::transform_transposed(res.begin(), v1.begin(), v2.begin());
+				return res;
+			}
 		for (size_t i = 0; i < R; i++)
 			for (size_t j = 0; j < C; j++)
-				res[j] += v1[i] * v2[i][j];
+				res.element(j) += v1.element(i) * v2.element(i, j);
 		return res;
 	}
 
-	template<typename T, size_t R, size_t C, typename T_O, size_t R_O, size_t C_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-	auto const operator+(basic_matrix<T, R, C> const& v1, basic_matrix<T_O, R_O, C_O> const& v2) {
-		basic_matrix<decltype(v1[0][0] + v2[0][0]), std::max(R, R_O), std::max(C, C_O)> res{v1};
-		return res += v2;
+	// Batched versions over arrays of matrices, which may also be the named matrix classes.
+	// Output may alias input.
+	template<typename M, typename T>
+	auto determinant(M const* input, size_t count, T* output) -> typename std::enable_if<is_matrix<M>::value>::type {
+		for (size_t i = 0; i < count; i++)
+			output[i] = T(input[i].determinant());
 	}
-	template<typename T, size_t R, size_t C, typename T_O, size_t R_O, size_t C_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-	auto const operator-(basic_matrix<T, R, C> const& v1, basic_matrix<T_O, R_O, C_O> const& v2) {
-		basic_matrix<decltype(v1[0][0] - v2[0][0]), std::max(R, R_O), std::max(C, C_O)> res{v1};
-		return res -= v2;
+	template<typename M>
+	auto inverse(M const* input, size_t count, M* output) -> typename std::enable_if<is_matrix<M>::value>::type {
+		using base_type = basic_matrix<typename matrix_operand_traits<M>::value_type, matrix_operand_traits<M>::rows_value, matrix_operand_traits<M>::columns_value>;
+		for (size_t i = 0; i < count; i++)
+			static_cast<base_type&>(output[i]) = input[i].inverse();
 	}
-	
-	template<typename T, size_t R, size_t C, typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-	auto const operator*(basic_matrix<T, R, C> const& v, T_O const& q) {
-		basic_matrix<decltype(v[0][0] * q), R, C> res{v};
-		return res *= q;
+
+	template<typename L, typename R>
+	constexpr auto operator+(L&& v1, R&& v2) -> typename expression_result<matrix_operands<L, R>::value, matrix_expression<expression_add, L, R>, L, R>::type {
+		return matrix_expression<expression_add, L, R>(std::forward<L>(v1), std::forward<R>(v2));
 	}
-	template<typename T, size_t R, size_t C, typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-	auto const operator*(T_O const& q, basic_matrix<T, R, C> const& v) {
-		basic_matrix<decltype(v[0][0] * q), R, C> res{v};
-		return res *= q;
+	template<typename L, typename R>
+	constexpr auto operator-(L&& v1, R&& v2) -> typename expression_result<matrix_operands<L, R>::value, matrix_expression<expression_subtract, L, R>, L, R>::type {
+		return matrix_expression<expression_subtract, L, R>(std::forward<L>(v1), std::forward<R>(v2));
 	}
-	template<typename T, size_t R, size_t C, typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-	auto const operator/(basic_matrix<T, R, C> const& v, T_O const& q) {
-		basic_matrix<decltype(v[0][0] / q), R, C> res{v};
-		return res /= q;
+
+	template<typename M, typename Q>
+	constexpr auto operator*(M&& v, Q&& q) -> typename expression_result<matrix_scalar_operands<M, Q>::value, matrix_expression<expression_multiply, M, Q>, M, Q>::type {
+		return matrix_expression<expression_multiply, M, Q>(std::forward<M>(v), std::forward<Q>(q));
 	}
-	template<typename T, size_t R, size_t C, typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-	auto const operator/(T_O const& q, basic_matrix<T, R, C> const& v) {
-		basic_matrix<decltype(q / v[0][0]), R, C> res{v};
-		for (size_t r = 0; r < R; r++)
-			for (size_t c = 0; c < C; c++)
-				res.data[r][c] = q / v.data[r][c];
-		return res;
+	template<typename Q, typename M>
+	constexpr auto operator*(Q&& q, M&& v) -> typename expression_result<matrix_scalar_operands<M, Q>::value, matrix_expression<expression_multiply, M, Q>, M, Q>::type {
+		return matrix_expression<expression_multiply, M, Q>(std::forward<M>(v), std::forward<Q>(q));
+	}
+	template<typename M, typename Q>
+	constexpr auto operator/(M&& v, Q&& q) -> typename expression_result<matrix_scalar_operands<M, Q>::value, matrix_expression<expression_divide, M, Q>, M, Q>::type {
+		return matrix_expression<expression_divide, M, Q>(std::forward<M>(v), std::forward<Q>(q));
+	}
+	template<typename Q, typename M>
+	constexpr auto operator/(Q&& q, M&& v) -> typename expression_result<matrix_scalar_operands<M, Q>::value, matrix_expression<expression_divide_reversed, M, Q>, M, Q>::type {
+		return matrix_expression<expression_divide_reversed, M, Q>(std::forward<M>(v), std::forward<Q>(q));
+	}
+	template<typename E>
+	constexpr auto operator-(E&& e) -> typename std::enable_if<is_matrix_expression<typename std::decay<E>::type>::value, matrix_expression<expression_negate, E, expression_none>>::type {
+		return {std::forward<E>(e), expression_none{}};
+	}
+
+	template<typename M, typename = typename std::enable_if<is_matrix<typename std::decay<M>::type>::value>::type>
+	constexpr matrix_expression<expression_identity, M, expression_none> lazy(M&& m) {
+		return {std::forward<M>(m), expression_none{}};
+	}
+
+	template<typename L, typename R, typename = typename std::enable_if<matrix_product_expression_operands<L, R>::value>::type>
+	constexpr auto const operator*(L const& v1, R const& v2) {
+		return evaluate(v1) * evaluate(v2);
+	}
+	template<typename L, typename R>
+	constexpr auto operator==(L const& v1, R const& v2) -> typename std::enable_if<matrix_expression_operands<L, R>::value, bool>::type {
+		return evaluate(v1) == evaluate(v2);
+	}
+	template<typename L, typename R>
+	constexpr auto operator!=(L const& v1, R const& v2) -> typename std::enable_if<matrix_expression_operands<L, R>::value, bool>::type {
+		return evaluate(v1) != evaluate(v2);
 	}
 
-	class matrix2f : public basic_matrix<float, 2u, 2u> { public: using basic_matrix::basic_matrix; };
-	class matrix3f : public basic_matrix<float, 3u, 3u> { public: using basic_matrix::basic_matrix; };
-	class matrix4f : public basic_matrix<float, 4u, 4u> { public: using basic_matrix::basic_matrix; };
+	// The named types are initialized from the results of the operators, which are basic_matrices.
+	class matrix2f : public basic_matrix<float, 2u, 2u> { public: using basic_matrix::basic_matrix; constexpr matrix2f(basic_matrix const& other) : basic_matrix(other) {} };
+	class matrix3f : public basic_matrix<float, 3u, 3u> { public: using basic_matrix::basic_matrix; constexpr matrix3f(basic_matrix const& other) : basic_matrix(other) {} };
+	class matrix4f : public basic_matrix<float, 4u, 4u> { public: using basic_matrix::basic_matrix; constexpr matrix4f(basic_matrix const& other) : basic_matrix(other) {} };
 
-	class matrix2d : public basic_matrix<double, 2u, 2u> { public: using basic_matrix::basic_matrix; };
-	class matrix3d : public basic_matrix<double, 3u, 3u> { public: using basic_matrix::basic_matrix; };
-	class matrix4d : public basic_matrix<double, 4u, 4u> { public: using basic_matrix::basic_matrix; };
+	class matrix2d : public basic_matrix<double, 2u, 2u> { public: using basic_matrix::basic_matrix; constexpr matrix2d(basic_matrix const& other) : basic_matrix(other) {} };
+	class matrix3d : public basic_matrix<double, 3u, 3u> { public: using basic_matrix::basic_matrix; constexpr matrix3d(basic_matrix const& other) : basic_matrix(other) {} };
+	class matrix4d : public basic_matrix<double, 4u, 4u> { public: using basic_matrix::basic_matrix; constexpr matrix4d(basic_matrix const& other) : basic_matrix(other) {} };
 
-	class matrix2b : public basic_matrix<uint8_t, 2u, 2u> { public: using basic_matrix::basic_matrix; };
-	class matrix3b : public basic_matrix<uint8_t, 3u, 3u> { public: using basic_matrix::basic_matrix; };
-	class matrix4b : public basic_matrix<uint8_t, 4u, 4u> { public: using basic_matrix::basic_matrix; };
+	class matrix2b : public basic_matrix<uint8_t, 2u, 2u> { public: using basic_matrix::basic_matrix; constexpr matrix2b(basic_matrix const& other) : basic_matrix(other) {} };
+	class matrix3b : public basic_matrix<uint8_t, 3u, 3u> { public: using basic_matrix::basic_matrix; constexpr matrix3b(basic_matrix const& other) : basic_matrix(other) {} };
+	class matrix4b : public basic_matrix<uint8_t, 4u, 4u> { public: using basic_matrix::basic_matrix; constexpr matrix4b(basic_matrix const& other) : basic_matrix(other) {} };
 
-	class matrix2u : public basic_matrix<uint32_t, 2u, 2u> { public: using basic_matrix::basic_matrix; };
-	class matrix3u : public basic_matrix<uint32_t, 3u, 3u> { public: using basic_matrix::basic_matrix; };
-	class matrix4u : public basic_matrix<uint32_t, 4u, 4u> { public: using basic_matrix::basic_matrix; };
+	class matrix2u : public basic_matrix<uint32_t, 2u, 2u> { public: using basic_matrix::basic_matrix; constexpr matrix2u(basic_matrix const& other) : basic_matrix(other) {} };
+	class matrix3u : public basic_matrix<uint32_t, 3u, 3u> { public: using basic_matrix::basic_matrix; constexpr matrix3u(basic_matrix const& other) : basic_matrix(other) {} };
+	class matrix4u : public basic_matrix<uint32_t, 4u, 4u> { public: using basic_matrix::basic_matrix; constexpr matrix4u(basic_matrix const& other) : basic_matrix(other) {} };
 
-	class matrix2i : public basic_matrix<int32_t, 2u, 2u> { public: using basic_matrix::basic_matrix; };
-	class matrix3i : public basic_matrix<int32_t, 3u, 3u> { public: using basic_matrix::basic_matrix; };
-	class matrix4i : public basic_matrix<int32_t, 4u, 4u> { public: using basic_matrix::basic_matrix; };
+	class matrix2i : public basic_matrix<int32_t, 2u, 2u> { public: using basic_matrix::basic_matrix; constexpr matrix2i(basic_matrix const& other) : basic_matrix(other) {} };
+	class matrix3i : public basic_matrix<int32_t, 3u, 3u> { public: using basic_matrix::basic_matrix; constexpr matrix3i(basic_matrix const& other) : basic_matrix(other) {} };
+	class matrix4i : public basic_matrix<int32_t, 4u, 4u> { public: using basic_matrix::basic_matrix; constexpr matrix4i(basic_matrix const& other) : basic_matrix(other) {} };
 
-	class matrix : public matrix4f { public: using matrix4f::matrix4f; };
+	class matrix : public matrix4f { public: using matrix4f::matrix4f; constexpr matrix(basic_matrix<float, 4u, 4u> const& other) : matrix4f(other) {} };
 }
\ No newline at end of file
@@ -0,0 +1,266 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "mml/vector_batch.hpp"
+
+namespace mml {
+	// Work-stealing pool. A pool of n threads runs n - 1 workers; the thread that waits on
+	// a parallel_for is the n-th and executes chunks as well. Every thread owns a queue,
+	// takes its own work from the back and steals from the front of the others.
+	class thread_pool {
+	public:
+		using task = std::function<void()>;
+	protected:
+		struct queue {
+			std::mutex lock;
+			std::deque<task> tasks;
+		};
+		struct slot {
+			thread_pool* pool;
+			size_t index;
+		};
+		static slot& current() {
+			static thread_local slot s{nullptr, 0};
+			return s;
+		}
+
+		std::vector<queue> queues;
+		std::vector<std::thread> workers;
+		std::mutex sleep_lock;
+		std::condition_variable sleeping;
+		size_t pending = 0;
+		bool stopping = false;
+
+		size_t own_index() {
+			return current().pool == this ? current().index : 0;
+		}
+		bool pop(size_t index, task& t) {
+			std::lock_guard<std::mutex> guard(queues[index].lock);
+			if (queues[index].tasks.empty())
+				return false;
+			t = std::move(queues[index].tasks.back());
+			queues[index].tasks.pop_back();
+			return true;
+		}
+		bool steal(size_t index, task& t) {
+			std::lock_guard<std::mutex> guard(queues[index].lock);
+			if (queues[index].tasks.empty())
+				return false;
+			t = std::move(queues[index].tasks.front());
+			queues[index].tasks.pop_front();
+			return true;
+		}
+		bool run_one(size_t index) {
+			task t;
+			bool found = pop(index, t);
+			for (size_t i = 1; !found && i < queues.size(); i++)
+				found = steal((index + i) % queues.size(), t);
+			if (!found)
+				return false;
+			{
+				std::lock_guard<std::mutex> guard(sleep_lock);
+				pending--;
+			}
+			t();
+			return true;
+		}
+		void run(size_t index) {
+			current() = {this, index};
+			while (true) {
+				if (run_one(index))
+					continue;
+				std::unique_lock<std::mutex> guard(sleep_lock);
+				sleeping.wait(guard, [this] { return stopping || pending > 0; });
+				if (stopping && pending == 0)
+					return;
+			}
+		}
+		void push(size_t index, task t) {
+			{
+				std::lock_guard<std::mutex> guard(sleep_lock);
+				pending++;
+			}
+			{
+				std::lock_guard<std::mutex> guard(queues[index].lock);
+				queues[index].tasks.push_back(std::move(t));
+			}
+			sleeping.notify_one();
+		}
+	public:
+		static size_t default_size() {
+			return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+		}
+		explicit thread_pool(size_t threads = default_size()) : queues(std::max<size_t>(threads, 1)) {
+			for (size_t i = 1; i < queues.size(); i++)
+				workers.emplace_back([this, i] { run(i); });
+		}
+		thread_pool(thread_pool const&) = delete;
+		thread_pool& operator=(thread_pool const&) = delete;
+		~thread_pool() {
+			{
+				std::lock_guard<std::mutex> guard(sleep_lock);
+				stopping = true;
+			}
+			sleeping.notify_all();
+			for (auto& worker : workers)
+				worker.join();
+		}
+
+		size_t size() const {
+			return queues.size();
+		}
+		void submit(task t) {
+			push(own_index(), std::move(t));
+		}
+
+		// Calls f(first, last) for consecutive ranges of at most chunk elements covering
+		// [0, count) and returns once all of them are done. Each worker starts on its own
+		// contiguous share of the chunks. The first exception thrown by f is rethrown here.
+		template<typename F>
+		void parallel_for(size_t count, size_t chunk, F const& f) {
+			if (count == 0)
+				return;
+			chunk = std::max<size_t>(chunk, 1);
+			size_t const chunks = (count + chunk - 1) / chunk;
+			if (chunks == 1 || size() == 1) {
+				for (size_t first = 0; first < count; first += chunk)
+					f(first, std::min(count, first + chunk));
+				return;
+			}
+
+			struct state {
+				std::mutex lock;
+				std::condition_variable done;
+				size_t remaining;
+				std::exception_ptr error;
+			} s;
+			s.remaining = chunks;
+			auto body = [&s, &f, count, chunk](size_t c) {
+				try {
+					f(c * chunk, std::min(count, (c + 1) * chunk));
+				} catch (...) {
+					std::lock_guard<std::mutex> guard(s.lock);
+					if (!s.error)
+						s.error = std::current_exception();
+				}
+				std::lock_guard<std::mutex> guard(s.lock);
+				if (--s.remaining == 0)
+					s.done.notify_all();
+			};
+			{
+				std::lock_guard<std::mutex> guard(sleep_lock);
+				pending += chunks;
+			}
+			size_t const n = size(), self = own_index();
+			for (size_t q = 0; q < n; q++) {
+				size_t const index = (self + q) % n;
+				size_t const first = chunks * q / n, last = chunks * (q + 1) / n;
+				{
+					std::lock_guard<std::mutex> guard(queues[index].lock);
+					for (size_t c = last; c-- > first;)
+						queues[index].tasks.push_back([body, c] { body(c); });
+				}
+			}
+			sleeping.notify_all();
+
+			while (true) {
+				{
+					std::lock_guard<std::mutex> guard(s.lock);
+					if (s.remaining == 0)
+						break;
+				}
+				if (!run_one(self))
+					break;
+			}
+			std::unique_lock<std::mutex> guard(s.lock);
+			s.done.wait(guard, [&s] { return s.remaining == 0; });
+			if (s.error)
+				std::rethrow_exception(s.error);
+		}
+	};
+
+	inline thread_pool& default_thread_pool() {
+		static thread_pool pool;
+		return pool;
+	}
+
+	// Elements per chunk: about 64 KiB of input, so a chunk stays in cache while it is processed.
+	template<typename V>
+	constexpr size_t default_chunk_size() {
+		return std::max<size_t>(size_t(65536) / sizeof(V), 1);
+	}
+
+	// Stores through the basic_vector base, so outputs may also be the named vector classes.
+	template<typename V_O, typename V>
+	void store_vector(V_O& output, V const& value) {
+		using base_type = basic_vector<typename V_O::value_type, V_O::size_value>;
+		static_cast<base_type&>(output) = base_type(value);
+	}
+
+	// Every element is computed on its own exactly as the serial operators compute it, so the
+	// results do not depend on the number of threads or on the chunk size.
+	template<typename T, size_t R, size_t C, typename V, typename V_O>
+	void parallel_transform(basic_matrix<T, R, C> const& m, V const* input, size_t count, V_O* output,
+							size_t chunk = default_chunk_size<V>(), thread_pool& pool = default_thread_pool()) {
+		constexpr size_t S = V::size_value;
+		static_assert(S == C || (S + 1 == C && R == C), "Vector size does not match the matrix.");
+		pool.parallel_for(count, chunk, [&](size_t first, size_t last) {
+			for (size_t i = first; i < last; i++) {
+				if constexpr (S == C)
+					store_vector(output[i], m * input[i]);
+				else {
+					basic_vector<T, C> point(input[i]);
+					point.element(S) = T(1);
+					store_vector(output[i], basic_vector<T, S>(m * point));
+				}
+			}
+		});
+	}
+	// Transforms points by a projection and divides the result by its last component.
+	template<typename T, size_t R, size_t C, typename V, typename V_O>
+	void parallel_project(basic_matrix<T, R, C> const& m, V const* input, size_t count, V_O* output,
+						  size_t chunk = default_chunk_size<V>(), thread_pool& pool = default_thread_pool()) {
+		constexpr size_t S = V::size_value;
+		static_assert(S + 1 == C && R == C, "Vector size does not match the matrix.");
+		pool.parallel_for(count, chunk, [&](size_t first, size_t last) {
+			for (size_t i = first; i < last; i++) {
+				basic_vector<T, S + 1> point(input[i]);
+				point.element(S) = T(1);
+				auto clip = m * point;
+				basic_vector<T, S> res(clip);
+				res /= clip.element(S);
+				store_vector(output[i], res);
+			}
+		});
+	}
+	template<typename V>
+	void parallel_normalize(V* data, size_t count, size_t chunk = default_chunk_size<V>(), thread_pool& pool = default_thread_pool()) {
+		pool.parallel_for(count, chunk, [&](size_t first, size_t last) {
+			normalize(data + first, last - first);
+		});
+	}
+
+	template<typename T, size_t R, size_t C, size_t S>
+	auto parallel_transform(basic_matrix<T, R, C> const& m, vector_batch<T, S> const& input, vector_batch<T, batch_transform_sizes<R, C, S>::result_size>& output,
+							size_t chunk = default_chunk_size<basic_vector<T, S>>(), thread_pool& pool = default_thread_pool())
+		-> typename std::enable_if<batch_transform_sizes<R, C, S>::valid>::type {
+		output.resize(input.size());
+		pool.parallel_for(input.size(), chunk, [&](size_t first, size_t last) {
+			transform_lanes<batch_transform_sizes<R, C, S>::homogeneous>(m, input, output, first, last);
+		});
+	}
+	template<typename T, size_t S>
+	void parallel_normalize(vector_batch<T, S>& data, size_t chunk = default_chunk_size<basic_vector<T, S>>(), thread_pool& pool = default_thread_pool()) {
+		pool.parallel_for(data.size(), chunk, [&](size_t first, size_t last) {
+			data.normalize(first, last);
+		});
+	}
+}
\ No newline at end of file
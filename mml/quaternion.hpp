@@ -0,0 +1,350 @@
+#pragma once
+#include <cmath>
+
+#include "mml/transformation.hpp"
+
+namespace mml {
+	// Rotation stored as the quaternion x i + y j + z k + w. Products compose like the
+	// matrices they stand for: (a * b).rotate(v) == a.rotate(b.rotate(v)).
+	template<typename T>
+	class basic_quaternion {
+		static_assert(std::is_floating_point<T>::value, "Quaternions need a floating point type.");
+	protected:
+		T data[4];
+	public:
+		using value_type = T;
+
+		constexpr basic_quaternion() : data{T(0), T(0), T(0), T(1)} {}
+		constexpr basic_quaternion(T const& x, T const& y, T const& z, T const& w) : data{x, y, z, w} {}
+		constexpr basic_quaternion(basic_vector<T, 3> const& v, T const& w) : data{v.element(0), v.element(1), v.element(2), w} {}
+		// From the rotation block of a transformation, which has to be orthonormal.
+		template<size_t R, size_t C, typename = typename std::enable_if<(R >= 3 && C >= 3)>::type>
+		explicit constexpr basic_quaternion(basic_matrix<T, R, C> const& m) : data{} {
+			T const trace = m.element(0, 0) + m.element(1, 1) + m.element(2, 2);
+			if (trace > T(0)) {
+				T const s = math::sqrt(trace + T(1)) * T(2);
+				data[0] = (m.element(2, 1) - m.element(1, 2)) / s;
+				data[1] = (m.element(0, 2) - m.element(2, 0)) / s;
+				data[2] = (m.element(1, 0) - m.element(0, 1)) / s;
+				data[3] = T(0.25) * s;
+			} else if (m.element(0, 0) > m.element(1, 1) && m.element(0, 0) > m.element(2, 2)) {
+				T const s = math::sqrt(T(1) + m.element(0, 0) - m.element(1, 1) - m.element(2, 2)) * T(2);
+				data[0] = T(0.25) * s;
+				data[1] = (m.element(0, 1) + m.element(1, 0)) / s;
+				data[2] = (m.element(0, 2) + m.element(2, 0)) / s;
+				data[3] = (m.element(2, 1) - m.element(1, 2)) / s;
+			} else if (m.element(1, 1) > m.element(2, 2)) {
+				T const s = math::sqrt(T(1) + m.element(1, 1) - m.element(0, 0) - m.element(2, 2)) * T(2);
+				data[0] = (m.element(0, 1) + m.element(1, 0)) / s;
+				data[1] = T(0.25) * s;
+				data[2] = (m.element(1, 2) + m.element(2, 1)) / s;
+				data[3] = (m.element(0, 2) - m.element(2, 0)) / s;
+			} else {
+				T const s = math::sqrt(T(1) + m.element(2, 2) - m.element(0, 0) - m.element(1, 1)) * T(2);
+				data[0] = (m.element(0, 2) + m.element(2, 0)) / s;
+				data[1] = (m.element(1, 2) + m.element(2, 1)) / s;
+				data[2] = T(0.25) * s;
+				data[3] = (m.element(1, 0) - m.element(0, 1)) / s;
+			}
+		}
+
+		constexpr T const* begin() const {
+			return data;
+		}
+		constexpr T* begin() {
+			return data;
+		}
+		constexpr T const* end() const {
+			return data + 4;
+		}
+		constexpr T* end() {
+			return data + 4;
+		}
+		constexpr T const& x() const { return data[0]; }
+		constexpr T const& y() const { return data[1]; }
+		constexpr T const& z() const { return data[2]; }
+		constexpr T const& w() const { return data[3]; }
+		constexpr void x(T const& value) { data[0] = value; }
+		constexpr void y(T const& value) { data[1] = value; }
+		constexpr void z(T const& value) { data[2] = value; }
+		constexpr void w(T const& value) { data[3] = value; }
+		constexpr basic_vector<T, 3> vector() const {
+			return basic_vector<T, 3>(data[0], data[1], data[2]);
+		}
+
+		constexpr T length() const {
+			return T(math::sqrt((data[0] * data[0] + data[1] * data[1]) + (data[2] * data[2] + data[3] * data[3])));
+		}
+		constexpr void normalize() {
+			T const l = length();
+			for (size_t i = 0; i < 4; i++)
+				data[i] /= l;
+		}
+		constexpr basic_quaternion<T> normalized() const {
+			basic_quaternion<T> res(*this);
+			res.normalize();
+			return res;
+		}
+		constexpr basic_quaternion<T> conjugate() const {
+			return basic_quaternion<T>(-data[0], -data[1], -data[2], data[3]);
+		}
+		constexpr basic_quaternion<T> inverse() const {
+			T const n = (data[0] * data[0] + data[1] * data[1]) + (data[2] * data[2] + data[3] * data[3]);
+			return basic_quaternion<T>(-data[0] / n, -data[1] / n, -data[2] / n, data[3] / n);
+		}
+
+		constexpr basic_quaternion<T>& operator*=(basic_quaternion<T> const& other) {
+			if constexpr (simd::quaternion_kernel<T>::accelerated)
+				if (!MMLIsConstantEvaluated()) {
+					simd::quaternion_kernel<T>::multiply(data, data, other.begin());
+					return *this;
+				}
+			T const* a = data;
+			T const* b = other.begin();
+			T const res[4] = {
+				a[3] * b[0] + (a[0] * b[3] + a[1] * b[2]) - a[2] * b[1],
+				a[3] * b[1] + (a[1] * b[3] + a[2] * b[0]) - a[0] * b[2],
+				a[3] * b[2] + (a[2] * b[3] + a[0] * b[1]) - a[1] * b[0],
+				a[3] * b[3] - (a[0] * b[0] + a[1] * b[1]) - a[2] * b[2]
+			};
+			for (size_t i = 0; i < 4; i++)
+				data[i] = res[i];
+			return *this;
+		}
+
+		// v + w t + u x t with t = 2 u x v, for a unit quaternion.
+		constexpr basic_vector<T, 3> rotate(basic_vector<T, 3> const& v) const {
+			T const tx = T(2) * (data[1] * v.element(2) - data[2] * v.element(1));
+			T const ty = T(2) * (data[2] * v.element(0) - data[0] * v.element(2));
+			T const tz = T(2) * (data[0] * v.element(1) - data[1] * v.element(0));
+			return basic_vector<T, 3>(v.element(0) + data[3] * tx + (data[1] * tz - data[2] * ty),
+									  v.element(1) + data[3] * ty + (data[2] * tx - data[0] * tz),
+									  v.element(2) + data[3] * tz + (data[0] * ty - data[1] * tx));
+		}
+		constexpr basic_transformation<T, 3> to_transformation() const {
+			T const s = T(2) / ((data[0] * data[0] + data[1] * data[1]) + (data[2] * data[2] + data[3] * data[3]));
+			T const xs = data[0] * s, ys = data[1] * s, zs = data[2] * s;
+			T const wx = data[3] * xs, wy = data[3] * ys, wz = data[3] * zs;
+			T const xx = data[0] * xs, xy = data[0] * ys, xz = data[0] * zs;
+			T const yy = data[1] * ys, yz = data[1] * zs, zz = data[2] * zs;
+			basic_transformation<T, 3> res;
+			res.element(0, 0) = T(1) - (yy + zz);
+			res.element(0, 1) = xy - wz;
+			res.element(0, 2) = xz + wy;
+			res.element(1, 0) = xy + wz;
+			res.element(1, 1) = T(1) - (xx + zz);
+			res.element(1, 2) = yz - wx;
+			res.element(2, 0) = xz - wy;
+			res.element(2, 1) = yz + wx;
+			res.element(2, 2) = T(1) - (xx + yy);
+			return res;
+		}
+	};
+
+	template<typename T>
+	constexpr T dot(basic_quaternion<T> const& q1, basic_quaternion<T> const& q2) {
+		if constexpr (simd::quaternion_kernel<T>::accelerated)
+			if (!MMLIsConstantEvaluated())
+				return simd::quaternion_kernel<T>::dot(q1.begin(), q2.begin());
+		T const* a = q1.begin();
+		T const* b = q2.begin();
+		return (a[0] * b[0] + a[1] * b[1]) + (a[2] * b[2] + a[3] * b[3]);
+	}
+	template<typename T>
+	constexpr basic_quaternion<T> operator*(basic_quaternion<T> const& q1, basic_quaternion<T> const& q2) {
+		basic_quaternion<T> res(q1);
+		return res *= q2;
+	}
+	template<typename T>
+	constexpr bool operator==(basic_quaternion<T> const& q1, basic_quaternion<T> const& q2) {
+		for (size_t i = 0; i < 4; i++)
+			if (q1.begin()[i] != q2.begin()[i])
+				return false;
+		return true;
+	}
+	template<typename T>
+	constexpr bool operator!=(basic_quaternion<T> const& q1, basic_quaternion<T> const& q2) {
+		return !(q1 == q2);
+	}
+
+	template<typename T>
+	constexpr basic_quaternion<T> quaternion_rotation(T const& angle, basic_vector<T, 3> const& axis) {
+		auto const a = axis.normalized();
+		auto const half = math::sincos(angle / T(2));
+		return basic_quaternion<T>(a.element(0) * half.sin, a.element(1) * half.sin, a.element(2) * half.sin, half.cos);
+	}
+
+	// Normalized q1 * w1 + q2 * w2.
+	template<typename T>
+	constexpr basic_quaternion<T> blend(basic_quaternion<T> const& q1, basic_quaternion<T> const& q2, T const& w1, T const& w2) {
+		basic_quaternion<T> res;
+		if constexpr (simd::quaternion_kernel<T>::accelerated)
+			if (!MMLIsConstantEvaluated()) {
+				simd::quaternion_kernel<T>::blend(res.begin(), q1.begin(), q2.begin(), w1, w2);
+				return res;
+			}
+		for (size_t i = 0; i < 4; i++)
+			res.begin()[i] = q1.begin()[i] * w1 + q2.begin()[i] * w2;
+		T const l = T(math::sqrt(dot(res, res)));
+		for (size_t i = 0; i < 4; i++)
+			res.begin()[i] /= l;
+		return res;
+	}
+	// Both interpolations take the shorter arc.
+	template<typename T>
+	constexpr basic_quaternion<T> nlerp(basic_quaternion<T> const& q1, basic_quaternion<T> const& q2, T const& t) {
+		return blend(q1, q2, T(1) - t, dot(q1, q2) < T(0) ? -t : t);
+	}
+	template<typename T>
+	basic_quaternion<T> slerp(basic_quaternion<T> const& q1, basic_quaternion<T> const& q2, T const& t) {
+		T const d = dot(q1, q2);
+		T const cosine = d < T(0) ? -d : d;
+		if (cosine > T(0.9995))
+			return nlerp(q1, q2, t);
+		T const angle = std::acos(cosine);
+		T const s = std::sin(angle);
+		T const w2 = std::sin(t * angle) / s;
+		return blend(q1, q2, std::sin((T(1) - t) * angle) / s, d < T(0) ? -w2 : w2);
+	}
+
+	// Structure-of-arrays kernels of the batched functions. A SIMD group of quaternions is
+	// transposed in registers into one register per component, so that every lane holds one quaternion,
+	// and the formulas of basic_quaternion run in all lanes with the same grouping, giving the
+	// same results as the scalar functions up to the compiler contracting those into fma.
+	template<typename T>
+	struct quaternion_array_kernel {
+		using L = simd::lanes<T>;
+		using type = typename L::type;
+		static const size_t width = L::width;
+
+		template<typename Q>
+		static void load(Q const* q, type* r) {
+			if constexpr (sizeof(Q) == 4 * sizeof(T))
+				L::load_transposed(q->begin(), r);
+			else {
+				alignas(32) T components[4][width];
+				for (size_t i = 0; i < width; i++)
+					for (size_t k = 0; k < 4; k++)
+						components[k][i] = q[i].begin()[k];
+				for (size_t k = 0; k < 4; k++)
+					r[k] = L::load(components[k]);
+			}
+		}
+		template<typename Q>
+		static void store(Q* q, type const* r) {
+			if constexpr (sizeof(Q) == 4 * sizeof(T))
+				L::store_transposed(q->begin(), r);
+			else {
+				alignas(32) T components[4][width];
+				for (size_t k = 0; k < 4; k++)
+					L::store(components[k], r[k]);
+				for (size_t i = 0; i < width; i++)
+					for (size_t k = 0; k < 4; k++)
+						q[i].begin()[k] = components[k][i];
+			}
+		}
+		static type dot(type const* a, type const* b) {
+			return L::add(L::add(L::mul(a[0], b[0]), L::mul(a[1], b[1])), L::add(L::mul(a[2], b[2]), L::mul(a[3], b[3])));
+		}
+
+		template<typename Q>
+		static void multiply(Q const* q1, Q const* q2, Q* output) {
+			type a[4], b[4], r[4];
+			load(q1, a);
+			load(q2, b);
+			r[0] = L::sub(L::add(L::mul(a[3], b[0]), L::add(L::mul(a[0], b[3]), L::mul(a[1], b[2]))), L::mul(a[2], b[1]));
+			r[1] = L::sub(L::add(L::mul(a[3], b[1]), L::add(L::mul(a[1], b[3]), L::mul(a[2], b[0]))), L::mul(a[0], b[2]));
+			r[2] = L::sub(L::add(L::mul(a[3], b[2]), L::add(L::mul(a[2], b[3]), L::mul(a[0], b[1]))), L::mul(a[1], b[0]));
+			r[3] = L::sub(L::sub(L::mul(a[3], b[3]), L::add(L::mul(a[0], b[0]), L::mul(a[1], b[1]))), L::mul(a[2], b[2]));
+			store(output, r);
+		}
+		template<typename Q, typename V, typename V_O>
+		static void rotate(Q const* q, V const* input, V_O* output) {
+			type u[4];
+			load(q, u);
+			alignas(32) T components[3][width];
+			for (size_t i = 0; i < width; i++)
+				for (size_t k = 0; k < 3; k++)
+					components[k][i] = input[i].element(k);
+			type const vx = L::load(components[0]), vy = L::load(components[1]), vz = L::load(components[2]);
+			type const two = L::broadcast(T(2));
+			type const tx = L::mul(two, L::sub(L::mul(u[1], vz), L::mul(u[2], vy)));
+			type const ty = L::mul(two, L::sub(L::mul(u[2], vx), L::mul(u[0], vz)));
+			type const tz = L::mul(two, L::sub(L::mul(u[0], vy), L::mul(u[1], vx)));
+			L::store(components[0], L::add(L::add(vx, L::mul(u[3], tx)), L::sub(L::mul(u[1], tz), L::mul(u[2], ty))));
+			L::store(components[1], L::add(L::add(vy, L::mul(u[3], ty)), L::sub(L::mul(u[2], tx), L::mul(u[0], tz))));
+			L::store(components[2], L::add(L::add(vz, L::mul(u[3], tz)), L::sub(L::mul(u[0], ty), L::mul(u[1], tx))));
+			for (size_t i = 0; i < width; i++)
+				for (size_t k = 0; k < 3; k++)
+					output[i].element(k) = components[k][i];
+		}
+		template<typename Q>
+		static void nlerp(Q const* q1, Q const* q2, T t, Q* output) {
+			type a[4], b[4], r[4];
+			load(q1, a);
+			load(q2, b);
+			alignas(32) T weights[width];
+			L::store(weights, dot(a, b));
+			for (size_t i = 0; i < width; i++)
+				weights[i] = weights[i] < T(0) ? -t : t;
+			type const w1 = L::broadcast(T(1) - t), w2 = L::load(weights);
+			for (size_t k = 0; k < 4; k++)
+				r[k] = L::add(L::mul(a[k], w1), L::mul(b[k], w2));
+			type const l = L::sqrt(dot(r, r));
+			for (size_t k = 0; k < 4; k++)
+				r[k] = L::div(r[k], l);
+			store(output, r);
+		}
+	};
+
+	// Batched versions over arrays of quaternions, which may also be the named quaternion
+	// classes. Outputs may alias inputs. Multiplication, rotation and nlerp run a SIMD group of
+	// quaternions at a time where there are SIMD lanes.
+	template<typename Q>
+	auto multiply(Q const* q1, Q const* q2, size_t count, Q* output) -> typename std::enable_if<std::is_base_of<basic_quaternion<typename Q::value_type>, Q>::value>::type {
+		using T = typename Q::value_type;
+		size_t i = 0;
+		if constexpr (simd::lanes<T>::accelerated) {
+			using K = quaternion_array_kernel<T>;
+			for (; i < count - count % K::width; i += K::width)
+				K::multiply(q1 + i, q2 + i, output + i);
+		}
+		for (; i < count; i++)
+			static_cast<basic_quaternion<T>&>(output[i]) = q1[i] * q2[i];
+	}
+	template<typename Q, typename V, typename V_O>
+	auto rotate(Q const* q, V const* input, size_t count, V_O* output) -> typename std::enable_if<std::is_base_of<basic_quaternion<typename Q::value_type>, Q>::value>::type {
+		using T = typename Q::value_type;
+		size_t i = 0;
+		if constexpr (simd::lanes<T>::accelerated) {
+			using K = quaternion_array_kernel<T>;
+			for (; i < count - count % K::width; i += K::width)
+				K::rotate(q + i, input + i, output + i);
+		}
+		for (; i < count; i++)
+			static_cast<basic_vector<T, 3>&>(output[i]) = q[i].rotate(input[i]);
+	}
+	template<typename Q>
+	auto nlerp(Q const* q1, Q const* q2, size_t count, typename Q::value_type const& t, Q* output) -> typename std::enable_if<std::is_base_of<basic_quaternion<typename Q::value_type>, Q>::value>::type {
+		using T = typename Q::value_type;
+		size_t i = 0;
+		if constexpr (simd::lanes<T>::accelerated) {
+			using K = quaternion_array_kernel<T>;
+			for (; i < count - count % K::width; i += K::width)
+				K::nlerp(q1 + i, q2 + i, t, output + i);
+		}
+		for (; i < count; i++)
+			static_cast<basic_quaternion<T>&>(output[i]) = nlerp<T>(q1[i], q2[i], t);
+	}
+	template<typename Q>
+	auto slerp(Q const* q1, Q const* q2, size_t count, typename Q::value_type const& t, Q* output) -> typename std::enable_if<std::is_base_of<basic_quaternion<typename Q::value_type>, Q>::value>::type {
+		using base_type = basic_quaternion<typename Q::value_type>;
+		for (size_t i = 0; i < count; i++)
+			static_cast<base_type&>(output[i]) = slerp<typename Q::value_type>(q1[i], q2[i], t);
+	}
+
+	class quaternionf : public basic_quaternion<float> { public: using basic_quaternion::basic_quaternion; };
+	class quaterniond : public basic_quaternion<double> { public: using basic_quaternion::basic_quaternion; };
+
+	class quaternion : public quaternionf { public: using quaternionf::quaternionf; };
+}
\ No newline at end of file
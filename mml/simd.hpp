@@ -0,0 +1,854 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#if !defined(MML_NO_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MML_SSE
+#endif
+#if defined(MML_SSE) && defined(__AVX__)
+#define MML_AVX
+#endif
+#if defined(MML_SSE) && (defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__)))
+#define MML_F16C
+#endif
+#if defined(MML_SSE) && (defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__)))
+#define MML_FMA
+#endif
+#endif
+
+#if defined(MML_SSE)
+#include <immintrin.h>
+#endif
+
+namespace mml::simd {
+	// Register-level primitives for a T[S] array. The primary template marks the
+	// pair as not accelerated, so every caller keeps its scalar loop for it.
+	template<typename T, size_t S>
+	struct pack {
+		static const bool accelerated = false;
+	};
+
+#if defined(MML_SSE)
+	template<>
+	struct pack<float, 4> {
+		static const bool accelerated = true;
+		using type = __m128;
+		static type load(float const* p) { return _mm_loadu_ps(p); }
+		static type load_divisor(float const* p) { return _mm_loadu_ps(p); }
+		static void store(float* p, type v) { _mm_storeu_ps(p, v); }
+		static type broadcast(float q) { return _mm_set1_ps(q); }
+		static type add(type a, type b) { return _mm_add_ps(a, b); }
+		static type sub(type a, type b) { return _mm_sub_ps(a, b); }
+		static type mul(type a, type b) { return _mm_mul_ps(a, b); }
+		static type div(type a, type b) { return _mm_div_ps(a, b); }
+		static type negate(type a) { return _mm_xor_ps(a, _mm_set1_ps(-0.f)); }
+		static float sum(type v) {
+			__m128 s = _mm_add_ss(_mm_setzero_ps(), v);
+			s = _mm_add_ss(s, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)));
+			s = _mm_add_ss(s, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)));
+			s = _mm_add_ss(s, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)));
+			return _mm_cvtss_f32(s);
+		}
+		static void transpose(type& r0, type& r1, type& r2, type& r3) { _MM_TRANSPOSE4_PS(r0, r1, r2, r3); }
+	};
+	template<>
+	struct pack<float, 3> {
+		static const bool accelerated = true;
+		using type = __m128;
+		static type load(float const* p) { return _mm_setr_ps(p[0], p[1], p[2], 0.f); }
+		static type load_divisor(float const* p) { return _mm_setr_ps(p[0], p[1], p[2], 1.f); }
+		static void store(float* p, type v) {
+			_mm_storel_pi(reinterpret_cast<__m64*>(p), v);
+			_mm_store_ss(p + 2, _mm_movehl_ps(v, v));
+		}
+		static type broadcast(float q) { return _mm_set1_ps(q); }
+		static type add(type a, type b) { return _mm_add_ps(a, b); }
+		static type sub(type a, type b) { return _mm_sub_ps(a, b); }
+		static type mul(type a, type b) { return _mm_mul_ps(a, b); }
+		static type div(type a, type b) { return _mm_div_ps(a, b); }
+		static type negate(type a) { return _mm_xor_ps(a, _mm_set1_ps(-0.f)); }
+		static float sum(type v) {
+			__m128 s = _mm_add_ss(_mm_setzero_ps(), v);
+			s = _mm_add_ss(s, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)));
+			s = _mm_add_ss(s, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)));
+			return _mm_cvtss_f32(s);
+		}
+		static type cross(type a, type b) {
+			__m128 a_yzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+			__m128 a_zxy = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2));
+			__m128 b_yzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+			__m128 b_zxy = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 1, 0, 2));
+			return _mm_sub_ps(_mm_mul_ps(a_yzx, b_zxy), _mm_mul_ps(b_yzx, a_zxy));
+		}
+	};
+	template<>
+	struct pack<float, 2> {
+		static const bool accelerated = true;
+		using type = __m128;
+		static type load(float const* p) { return _mm_setr_ps(p[0], p[1], 0.f, 0.f); }
+		static type load_divisor(float const* p) { return _mm_setr_ps(p[0], p[1], 1.f, 1.f); }
+		static void store(float* p, type v) { _mm_storel_pi(reinterpret_cast<__m64*>(p), v); }
+		static type broadcast(float q) { return _mm_set1_ps(q); }
+		static type add(type a, type b) { return _mm_add_ps(a, b); }
+		static type sub(type a, type b) { return _mm_sub_ps(a, b); }
+		static type mul(type a, type b) { return _mm_mul_ps(a, b); }
+		static type div(type a, type b) { return _mm_div_ps(a, b); }
+		static type negate(type a) { return _mm_xor_ps(a, _mm_set1_ps(-0.f)); }
+		static float sum(type v) {
+			__m128 s = _mm_add_ss(_mm_setzero_ps(), v);
+			s = _mm_add_ss(s, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)));
+			return _mm_cvtss_f32(s);
+		}
+	};
+	template<>
+	struct pack<double, 2> {
+		static const bool accelerated = true;
+		using type = __m128d;
+		static type load(double const* p) { return _mm_loadu_pd(p); }
+		static type load_divisor(double const* p) { return _mm_loadu_pd(p); }
+		static void store(double* p, type v) { _mm_storeu_pd(p, v); }
+		static type broadcast(double q) { return _mm_set1_pd(q); }
+		static type add(type a, type b) { return _mm_add_pd(a, b); }
+		static type sub(type a, type b) { return _mm_sub_pd(a, b); }
+		static type mul(type a, type b) { return _mm_mul_pd(a, b); }
+		static type div(type a, type b) { return _mm_div_pd(a, b); }
+		static type negate(type a) { return _mm_xor_pd(a, _mm_set1_pd(-0.)); }
+		static double sum(type v) {
+			__m128d s = _mm_add_sd(_mm_setzero_pd(), v);
+			s = _mm_add_sd(s, _mm_unpackhi_pd(v, v));
+			return _mm_cvtsd_f64(s);
+		}
+	};
+#if defined(MML_AVX)
+	template<>
+	struct pack<double, 4> {
+		static const bool accelerated = true;
+		using type = __m256d;
+		static type load(double const* p) { return _mm256_loadu_pd(p); }
+		static type load_divisor(double const* p) { return _mm256_loadu_pd(p); }
+		static void store(double* p, type v) { _mm256_storeu_pd(p, v); }
+		static type broadcast(double q) { return _mm256_set1_pd(q); }
+		static type add(type a, type b) { return _mm256_add_pd(a, b); }
+		static type sub(type a, type b) { return _mm256_sub_pd(a, b); }
+		static type mul(type a, type b) { return _mm256_mul_pd(a, b); }
+		static type div(type a, type b) { return _mm256_div_pd(a, b); }
+		static type negate(type a) { return _mm256_xor_pd(a, _mm256_set1_pd(-0.)); }
+		static double sum(type v) {
+			__m128d lo = _mm256_castpd256_pd128(v), hi = _mm256_extractf128_pd(v, 1);
+			__m128d s = _mm_add_sd(_mm_setzero_pd(), lo);
+			s = _mm_add_sd(s, _mm_unpackhi_pd(lo, lo));
+			s = _mm_add_sd(s, hi);
+			s = _mm_add_sd(s, _mm_unpackhi_pd(hi, hi));
+			return _mm_cvtsd_f64(s);
+		}
+		static void transpose(type& r0, type& r1, type& r2, type& r3) {
+			__m256d t0 = _mm256_unpacklo_pd(r0, r1), t1 = _mm256_unpackhi_pd(r0, r1);
+			__m256d t2 = _mm256_unpacklo_pd(r2, r3), t3 = _mm256_unpackhi_pd(r2, r3);
+			r0 = _mm256_permute2f128_pd(t0, t2, 0x20);
+			r1 = _mm256_permute2f128_pd(t1, t3, 0x20);
+			r2 = _mm256_permute2f128_pd(t0, t2, 0x31);
+			r3 = _mm256_permute2f128_pd(t1, t3, 0x31);
+		}
+	};
+	template<>
+	struct pack<double, 3> {
+		static const bool accelerated = true;
+		using type = __m256d;
+		static type load(double const* p) { return _mm256_setr_pd(p[0], p[1], p[2], 0.); }
+		static type load_divisor(double const* p) { return _mm256_setr_pd(p[0], p[1], p[2], 1.); }
+		static void store(double* p, type v) {
+			_mm_storeu_pd(p, _mm256_castpd256_pd128(v));
+			_mm_store_sd(p + 2, _mm256_extractf128_pd(v, 1));
+		}
+		static type broadcast(double q) { return _mm256_set1_pd(q); }
+		static type add(type a, type b) { return _mm256_add_pd(a, b); }
+		static type sub(type a, type b) { return _mm256_sub_pd(a, b); }
+		static type mul(type a, type b) { return _mm256_mul_pd(a, b); }
+		static type div(type a, type b) { return _mm256_div_pd(a, b); }
+		static type negate(type a) { return _mm256_xor_pd(a, _mm256_set1_pd(-0.)); }
+		static double sum(type v) {
+			__m128d lo = _mm256_castpd256_pd128(v), hi = _mm256_extractf128_pd(v, 1);
+			__m128d s = _mm_add_sd(_mm_setzero_pd(), lo);
+			s = _mm_add_sd(s, _mm_unpackhi_pd(lo, lo));
+			s = _mm_add_sd(s, hi);
+			return _mm_cvtsd_f64(s);
+		}
+	};
+#else
+	template<>
+	struct pack<double, 4> {
+		static const bool accelerated = true;
+		struct type { __m128d lo, hi; };
+		static type load(double const* p) { return {_mm_loadu_pd(p), _mm_loadu_pd(p + 2)}; }
+		static type load_divisor(double const* p) { return load(p); }
+		static void store(double* p, type v) { _mm_storeu_pd(p, v.lo); _mm_storeu_pd(p + 2, v.hi); }
+		static type broadcast(double q) { return {_mm_set1_pd(q), _mm_set1_pd(q)}; }
+		static type add(type a, type b) { return {_mm_add_pd(a.lo, b.lo), _mm_add_pd(a.hi, b.hi)}; }
+		static type sub(type a, type b) { return {_mm_sub_pd(a.lo, b.lo), _mm_sub_pd(a.hi, b.hi)}; }
+		static type mul(type a, type b) { return {_mm_mul_pd(a.lo, b.lo), _mm_mul_pd(a.hi, b.hi)}; }
+		static type div(type a, type b) { return {_mm_div_pd(a.lo, b.lo), _mm_div_pd(a.hi, b.hi)}; }
+		static type negate(type a) { return {_mm_xor_pd(a.lo, _mm_set1_pd(-0.)), _mm_xor_pd(a.hi, _mm_set1_pd(-0.))}; }
+		static double sum(type v) {
+			__m128d s = _mm_add_sd(_mm_setzero_pd(), v.lo);
+			s = _mm_add_sd(s, _mm_unpackhi_pd(v.lo, v.lo));
+			s = _mm_add_sd(s, v.hi);
+			s = _mm_add_sd(s, _mm_unpackhi_pd(v.hi, v.hi));
+			return _mm_cvtsd_f64(s);
+		}
+		static void transpose(type& r0, type& r1, type& r2, type& r3) {
+			type c0 = {_mm_unpacklo_pd(r0.lo, r1.lo), _mm_unpacklo_pd(r2.lo, r3.lo)};
+			type c1 = {_mm_unpackhi_pd(r0.lo, r1.lo), _mm_unpackhi_pd(r2.lo, r3.lo)};
+			type c2 = {_mm_unpacklo_pd(r0.hi, r1.hi), _mm_unpacklo_pd(r2.hi, r3.hi)};
+			type c3 = {_mm_unpackhi_pd(r0.hi, r1.hi), _mm_unpackhi_pd(r2.hi, r3.hi)};
+			r0 = c0; r1 = c1; r2 = c2; r3 = c3;
+		}
+	};
+#endif
+#endif
+
+	// Vertical primitives for the structure-of-arrays containers: width consecutive
+	// elements of one lane are processed per step, each exactly as the scalar code would.
+	template<typename T>
+	struct lanes {
+		static const bool accelerated = false;
+		static const size_t width = 1;
+	};
+#if defined(MML_AVX)
+	template<>
+	struct lanes<float> {
+		static const bool accelerated = true;
+		static const size_t width = 8;
+		using type = __m256;
+		static type load(float const* p) { return _mm256_loadu_ps(p); }
+		static void store(float* p, type v) { _mm256_storeu_ps(p, v); }
+		static type broadcast(float q) { return _mm256_set1_ps(q); }
+		static type add(type a, type b) { return _mm256_add_ps(a, b); }
+		static type sub(type a, type b) { return _mm256_sub_ps(a, b); }
+		static type mul(type a, type b) { return _mm256_mul_ps(a, b); }
+		static type div(type a, type b) { return _mm256_div_ps(a, b); }
+		static type sqrt(type a) { return _mm256_sqrt_ps(a); }
+		static type max(type a, type b) { return _mm256_max_ps(a, b); }
+		static int less_mask(type a, type b) { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_LT_OQ)); }
+		// a * b + c, rounded once where the instruction set has fused multiply-adds.
+		static type fma(type a, type b, type c) {
+#if defined(MML_FMA)
+			return _mm256_fmadd_ps(a, b, c);
+#else
+			return add(mul(a, b), c);
+#endif
+		}
+		// The hardware estimate refined by one Newton step, within about two ulps.
+		static type rsqrt(type a) {
+			type const y = _mm256_rsqrt_ps(a);
+			return mul(y, sub(broadcast(1.5f), mul(mul(broadcast(0.5f), a), mul(y, y))));
+		}
+		// width consecutive groups of four, e.g. quaternions, one register per element of a group.
+		static void load_transposed(float const* p, type* r) {
+			type const a = load(p), b = load(p + 8), c = load(p + 16), d = load(p + 24);
+			transpose_halves(_mm256_permute2f128_ps(a, c, 0x20), _mm256_permute2f128_ps(a, c, 0x31),
+				_mm256_permute2f128_ps(b, d, 0x20), _mm256_permute2f128_ps(b, d, 0x31), r);
+		}
+		static void store_transposed(float* p, type const* r) {
+			type t[4];
+			transpose_halves(r[0], r[1], r[2], r[3], t);
+			store(p, _mm256_permute2f128_ps(t[0], t[1], 0x20));
+			store(p + 8, _mm256_permute2f128_ps(t[2], t[3], 0x20));
+			store(p + 16, _mm256_permute2f128_ps(t[0], t[1], 0x31));
+			store(p + 24, _mm256_permute2f128_ps(t[2], t[3], 0x31));
+		}
+	private:
+		static void transpose_halves(type a, type b, type c, type d, type* r) {
+			type const ab_low = _mm256_unpacklo_ps(a, b), ab_high = _mm256_unpackhi_ps(a, b);
+			type const cd_low = _mm256_unpacklo_ps(c, d), cd_high = _mm256_unpackhi_ps(c, d);
+			r[0] = _mm256_shuffle_ps(ab_low, cd_low, _MM_SHUFFLE(1, 0, 1, 0));
+			r[1] = _mm256_shuffle_ps(ab_low, cd_low, _MM_SHUFFLE(3, 2, 3, 2));
+			r[2] = _mm256_shuffle_ps(ab_high, cd_high, _MM_SHUFFLE(1, 0, 1, 0));
+			r[3] = _mm256_shuffle_ps(ab_high, cd_high, _MM_SHUFFLE(3, 2, 3, 2));
+		}
+	};
+	template<>
+	struct lanes<double> {
+		static const bool accelerated = true;
+		static const size_t width = 4;
+		using type = __m256d;
+		static type load(double const* p) { return _mm256_loadu_pd(p); }
+		static void store(double* p, type v) { _mm256_storeu_pd(p, v); }
+		static type broadcast(double q) { return _mm256_set1_pd(q); }
+		static type add(type a, type b) { return _mm256_add_pd(a, b); }
+		static type sub(type a, type b) { return _mm256_sub_pd(a, b); }
+		static type mul(type a, type b) { return _mm256_mul_pd(a, b); }
+		static type div(type a, type b) { return _mm256_div_pd(a, b); }
+		static type sqrt(type a) { return _mm256_sqrt_pd(a); }
+		static type max(type a, type b) { return _mm256_max_pd(a, b); }
+		static int less_mask(type a, type b) { return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_LT_OQ)); }
+		static type fma(type a, type b, type c) {
+#if defined(MML_FMA)
+			return _mm256_fmadd_pd(a, b, c);
+#else
+			return add(mul(a, b), c);
+#endif
+		}
+		static type rsqrt(type a) { return div(broadcast(1.), sqrt(a)); }
+		// The transposition of a 4x4 block is its own inverse.
+		static void load_transposed(double const* p, type* r) {
+			type const q[4] = {load(p), load(p + 4), load(p + 8), load(p + 12)};
+			transpose(q, r);
+		}
+		static void store_transposed(double* p, type const* r) {
+			type q[4];
+			transpose(r, q);
+			for (size_t i = 0; i < 4; i++)
+				store(p + 4 * i, q[i]);
+		}
+	private:
+		static void transpose(type const* q, type* r) {
+			type const low01 = _mm256_unpacklo_pd(q[0], q[1]), high01 = _mm256_unpackhi_pd(q[0], q[1]);
+			type const low23 = _mm256_unpacklo_pd(q[2], q[3]), high23 = _mm256_unpackhi_pd(q[2], q[3]);
+			r[0] = _mm256_permute2f128_pd(low01, low23, 0x20);
+			r[1] = _mm256_permute2f128_pd(high01, high23, 0x20);
+			r[2] = _mm256_permute2f128_pd(low01, low23, 0x31);
+			r[3] = _mm256_permute2f128_pd(high01, high23, 0x31);
+		}
+	};
+#elif defined(MML_SSE)
+	template<>
+	struct lanes<float> {
+		static const bool accelerated = true;
+		static const size_t width = 4;
+		using type = __m128;
+		static type load(float const* p) { return _mm_loadu_ps(p); }
+		static void store(float* p, type v) { _mm_storeu_ps(p, v); }
+		static type broadcast(float q) { return _mm_set1_ps(q); }
+		static type add(type a, type b) { return _mm_add_ps(a, b); }
+		static type sub(type a, type b) { return _mm_sub_ps(a, b); }
+		static type mul(type a, type b) { return _mm_mul_ps(a, b); }
+		static type div(type a, type b) { return _mm_div_ps(a, b); }
+		static type sqrt(type a) { return _mm_sqrt_ps(a); }
+		static type max(type a, type b) { return _mm_max_ps(a, b); }
+		static int less_mask(type a, type b) { return _mm_movemask_ps(_mm_cmplt_ps(a, b)); }
+		// a * b + c, rounded once where the instruction set has fused multiply-adds.
+		static type fma(type a, type b, type c) {
+#if defined(MML_FMA)
+			return _mm_fmadd_ps(a, b, c);
+#else
+			return add(mul(a, b), c);
+#endif
+		}
+		// The hardware estimate refined by one Newton step, within about two ulps.
+		static type rsqrt(type a) {
+			type const y = _mm_rsqrt_ps(a);
+			return mul(y, sub(broadcast(1.5f), mul(mul(broadcast(0.5f), a), mul(y, y))));
+		}
+		// width consecutive groups of four, e.g. quaternions, one register per element of a group.
+		static void load_transposed(float const* p, type* r) {
+			type const q[4] = {load(p), load(p + 4), load(p + 8), load(p + 12)};
+			transpose(q, r);
+		}
+		static void store_transposed(float* p, type const* r) {
+			type q[4];
+			transpose(r, q);
+			for (size_t i = 0; i < 4; i++)
+				store(p + 4 * i, q[i]);
+		}
+	private:
+		static void transpose(type const* q, type* r) {
+			type const low01 = _mm_unpacklo_ps(q[0], q[1]), high01 = _mm_unpackhi_ps(q[0], q[1]);
+			type const low23 = _mm_unpacklo_ps(q[2], q[3]), high23 = _mm_unpackhi_ps(q[2], q[3]);
+			r[0] = _mm_movelh_ps(low01, low23);
+			r[1] = _mm_movehl_ps(low23, low01);
+			r[2] = _mm_movelh_ps(high01, high23);
+			r[3] = _mm_movehl_ps(high23, high01);
+		}
+	};
+	template<>
+	struct lanes<double> {
+		static const bool accelerated = true;
+		static const size_t width = 2;
+		using type = __m128d;
+		static type load(double const* p) { return _mm_loadu_pd(p); }
+		static void store(double* p, type v) { _mm_storeu_pd(p, v); }
+		static type broadcast(double q) { return _mm_set1_pd(q); }
+		static type add(type a, type b) { return _mm_add_pd(a, b); }
+		static type sub(type a, type b) { return _mm_sub_pd(a, b); }
+		static type mul(type a, type b) { return _mm_mul_pd(a, b); }
+		static type div(type a, type b) { return _mm_div_pd(a, b); }
+		static type sqrt(type a) { return _mm_sqrt_pd(a); }
+		static type max(type a, type b) { return _mm_max_pd(a, b); }
+		static int less_mask(type a, type b) { return _mm_movemask_pd(_mm_cmplt_pd(a, b)); }
+		static type fma(type a, type b, type c) {
+#if defined(MML_FMA)
+			return _mm_fmadd_pd(a, b, c);
+#else
+			return add(mul(a, b), c);
+#endif
+		}
+		static type rsqrt(type a) { return div(broadcast(1.), sqrt(a)); }
+		static void load_transposed(double const* p, type* r) {
+			type const a = load(p), b = load(p + 2), c = load(p + 4), d = load(p + 6);
+			r[0] = _mm_unpacklo_pd(a, c);
+			r[1] = _mm_unpackhi_pd(a, c);
+			r[2] = _mm_unpacklo_pd(b, d);
+			r[3] = _mm_unpackhi_pd(b, d);
+		}
+		static void store_transposed(double* p, type const* r) {
+			store(p, _mm_unpacklo_pd(r[0], r[1]));
+			store(p + 2, _mm_unpacklo_pd(r[2], r[3]));
+			store(p + 4, _mm_unpackhi_pd(r[0], r[1]));
+			store(p + 6, _mm_unpackhi_pd(r[2], r[3]));
+		}
+	};
+#endif
+
+	template<typename T, size_t S>
+	struct is_accelerated : std::integral_constant<bool, pack<T, S>::accelerated> {};
+
+	// Element-wise kernels on raw T[S] arrays. The lanes are summed in index order,
+	// so every result matches the scalar loops of basic_vector bit for bit.
+	template<typename T, size_t S>
+	struct kernel {
+		using P = pack<T, S>;
+		static void add(T* a, T const* b) { P::store(a, P::add(P::load(a), P::load(b))); }
+		static void sub(T* a, T const* b) { P::store(a, P::sub(P::load(a), P::load(b))); }
+		static void mul(T* a, T const* b) { P::store(a, P::mul(P::load(a), P::load(b))); }
+		static void div(T* a, T const* b) { P::store(a, P::div(P::load(a), P::load_divisor(b))); }
+		static void mul(T* a, T q) { P::store(a, P::mul(P::load(a), P::broadcast(q))); }
+		static void div(T* a, T q) { P::store(a, P::div(P::load(a), P::broadcast(q))); }
+		static void negate(T* r, T const* a) { P::store(r, P::negate(P::load(a))); }
+		static T dot(T const* a, T const* b) { return P::sum(P::mul(P::load(a), P::load(b))); }
+		static void cross(T* r, T const* a, T const* b) { P::store(r, P::cross(P::load(a), P::load(b))); }
+	};
+
+	// Row-major 4x4 kernels. Each output lane accumulates its products in the
+	// same order as the scalar loops in matrix.hpp, starting from zero.
+	template<typename T>
+	struct matrix_kernel {
+		using P = pack<T, 4>;
+		static void multiply(T* r, T const* a, T const* b) {
+			auto b0 = P::load(b), b1 = P::load(b + 4), b2 = P::load(b + 8), b3 = P::load(b + 12);
+			for (size_t i = 0; i < 4; i++) {
+				auto acc = P::add(P::broadcast(T(0)), P::mul(P::broadcast(a[i * 4 + 0]), b0));
+				acc = P::add(acc, P::mul(P::broadcast(a[i * 4 + 1]), b1));
+				acc = P::add(acc, P::mul(P::broadcast(a[i * 4 + 2]), b2));
+				acc = P::add(acc, P::mul(P::broadcast(a[i * 4 + 3]), b3));
+				P::store(r + i * 4, acc);
+			}
+		}
+		// 3x4 affine matrices whose last row (0, 0, 0, 1) is implicit.
+		static void affine_multiply(T* r, T const* a, T const* b) {
+			T const last[4] = {T(0), T(0), T(0), T(1)};
+			auto b0 = P::load(b), b1 = P::load(b + 4), b2 = P::load(b + 8), b3 = P::load(last);
+			for (size_t i = 0; i < 3; i++) {
+				auto acc = P::add(P::broadcast(T(0)), P::mul(P::broadcast(a[i * 4 + 0]), b0));
+				acc = P::add(acc, P::mul(P::broadcast(a[i * 4 + 1]), b1));
+				acc = P::add(acc, P::mul(P::broadcast(a[i * 4 + 2]), b2));
+				acc = P::add(acc, P::mul(P::broadcast(a[i * 4 + 3]), b3));
+				P::store(r + i * 4, acc);
+			}
+		}
+		static void transform(T* r, T const* m, T const* v) {
+			auto c0 = P::load(m), c1 = P::load(m + 4), c2 = P::load(m + 8), c3 = P::load(m + 12);
+			P::transpose(c0, c1, c2, c3);
+			auto acc = P::add(P::broadcast(T(0)), P::mul(c0, P::broadcast(v[0])));
+			acc = P::add(acc, P::mul(c1, P::broadcast(v[1])));
+			acc = P::add(acc, P::mul(c2, P::broadcast(v[2])));
+			acc = P::add(acc, P::mul(c3, P::broadcast(v[3])));
+			P::store(r, acc);
+		}
+		static void transform_transposed(T* r, T const* v, T const* m) {
+			auto acc = P::add(P::broadcast(T(0)), P::mul(P::broadcast(v[0]), P::load(m)));
+			acc = P::add(acc, P::mul(P::broadcast(v[1]), P::load(m + 4)));
+			acc = P::add(acc, P::mul(P::broadcast(v[2]), P::load(m + 8)));
+			acc = P::add(acc, P::mul(P::broadcast(v[3]), P::load(m + 12)));
+			P::store(r, acc);
+		}
+	};
+
+	// Closed-form 4x4 inverse from 2x2 blocks, each held row-major in one register. Returns the
+	// determinant; r is only written when it is not zero.
+	template<typename T>
+	struct inverse_kernel {
+		static const bool accelerated = false;
+	};
+#if defined(MML_SSE)
+	template<>
+	struct inverse_kernel<float> {
+		static const bool accelerated = true;
+		template<int x, int y, int z, int w>
+		static __m128 shuffle(__m128 a, __m128 b) { return _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x)); }
+		template<int x, int y, int z, int w>
+		static __m128 swizzle(__m128 a) { return shuffle<x, y, z, w>(a, a); }
+		static __m128 mul(__m128 a, __m128 b) {
+			return _mm_add_ps(_mm_mul_ps(a, swizzle<0, 3, 0, 3>(b)), _mm_mul_ps(swizzle<1, 0, 3, 2>(a), swizzle<2, 1, 2, 1>(b)));
+		}
+		static __m128 adjugate_mul(__m128 a, __m128 b) {
+			return _mm_sub_ps(_mm_mul_ps(swizzle<3, 3, 0, 0>(a), b), _mm_mul_ps(swizzle<1, 1, 2, 2>(a), swizzle<2, 3, 0, 1>(b)));
+		}
+		static __m128 mul_adjugate(__m128 a, __m128 b) {
+			return _mm_sub_ps(_mm_mul_ps(a, swizzle<3, 0, 3, 0>(b)), _mm_mul_ps(swizzle<1, 0, 3, 2>(a), swizzle<2, 1, 2, 1>(b)));
+		}
+		static float inverse(float* r, float const* m) {
+			__m128 r0 = _mm_loadu_ps(m), r1 = _mm_loadu_ps(m + 4), r2 = _mm_loadu_ps(m + 8), r3 = _mm_loadu_ps(m + 12);
+			__m128 a = _mm_movelh_ps(r0, r1), b = _mm_movehl_ps(r1, r0);
+			__m128 c = _mm_movelh_ps(r2, r3), d = _mm_movehl_ps(r3, r2);
+			__m128 dets = _mm_sub_ps(_mm_mul_ps(shuffle<0, 2, 0, 2>(r0, r2), shuffle<1, 3, 1, 3>(r1, r3)),
+									 _mm_mul_ps(shuffle<1, 3, 1, 3>(r0, r2), shuffle<0, 2, 0, 2>(r1, r3)));
+			__m128 det_a = swizzle<0, 0, 0, 0>(dets), det_b = swizzle<1, 1, 1, 1>(dets);
+			__m128 det_c = swizzle<2, 2, 2, 2>(dets), det_d = swizzle<3, 3, 3, 3>(dets);
+
+			__m128 d_c = adjugate_mul(d, c), a_b = adjugate_mul(a, b);
+			__m128 x = _mm_sub_ps(_mm_mul_ps(det_d, a), mul(b, d_c));
+			__m128 w = _mm_sub_ps(_mm_mul_ps(det_a, d), mul(c, a_b));
+			__m128 y = _mm_sub_ps(_mm_mul_ps(det_b, c), mul_adjugate(d, a_b));
+			__m128 z = _mm_sub_ps(_mm_mul_ps(det_c, b), mul_adjugate(a, d_c));
+
+			__m128 trace = _mm_mul_ps(a_b, swizzle<0, 2, 1, 3>(d_c));
+			trace = _mm_add_ps(trace, swizzle<1, 0, 3, 2>(trace));
+			trace = _mm_add_ps(trace, swizzle<2, 3, 0, 1>(trace));
+			__m128 det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(det_a, det_d), _mm_mul_ps(det_b, det_c)), trace);
+			float const determinant = _mm_cvtss_f32(det);
+			if (determinant == 0.f)
+				return determinant;
+
+			__m128 factor = _mm_div_ps(_mm_setr_ps(1.f, -1.f, -1.f, 1.f), det);
+			x = _mm_mul_ps(x, factor);
+			y = _mm_mul_ps(y, factor);
+			z = _mm_mul_ps(z, factor);
+			w = _mm_mul_ps(w, factor);
+			_mm_storeu_ps(r, shuffle<3, 1, 3, 1>(x, y));
+			_mm_storeu_ps(r + 4, shuffle<2, 0, 2, 0>(x, y));
+			_mm_storeu_ps(r + 8, shuffle<3, 1, 3, 1>(z, w));
+			_mm_storeu_ps(r + 12, shuffle<2, 0, 2, 0>(z, w));
+			return determinant;
+		}
+	};
+#endif
+
+	// Quaternions stored as (x, y, z, w), one per register. The operations are grouped the way
+	// basic_quaternion groups them, so results match the scalar code bit for bit.
+	template<typename T>
+	struct quaternion_kernel {
+		static const bool accelerated = false;
+	};
+#if defined(MML_SSE)
+	template<>
+	struct quaternion_kernel<float> {
+		static const bool accelerated = true;
+		template<int x, int y, int z, int w>
+		static __m128 swizzle(__m128 a) { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(w, z, y, x)); }
+		static __m128 multiply(__m128 a, __m128 b) {
+			__m128 const sign = _mm_setr_ps(0.f, 0.f, 0.f, -0.f);
+			__m128 t0 = _mm_mul_ps(swizzle<3, 3, 3, 3>(a), b);
+			__m128 t1 = _mm_mul_ps(swizzle<0, 1, 2, 0>(a), swizzle<3, 3, 3, 0>(b));
+			__m128 t2 = _mm_mul_ps(swizzle<1, 2, 0, 1>(a), swizzle<2, 0, 1, 1>(b));
+			__m128 t3 = _mm_mul_ps(swizzle<2, 0, 1, 2>(a), swizzle<1, 2, 0, 2>(b));
+			return _mm_sub_ps(_mm_add_ps(t0, _mm_xor_ps(_mm_add_ps(t1, t2), sign)), t3);
+		}
+		static __m128 dot(__m128 a, __m128 b) {
+			__m128 p = _mm_mul_ps(a, b);
+			p = _mm_add_ps(p, swizzle<1, 0, 3, 2>(p));
+			return _mm_add_ps(p, swizzle<2, 3, 0, 1>(p));
+		}
+		static void multiply(float* r, float const* a, float const* b) {
+			_mm_storeu_ps(r, multiply(_mm_loadu_ps(a), _mm_loadu_ps(b)));
+		}
+		// r = normalize(a * wa + b * wb)
+		static void blend(float* r, float const* a, float const* b, float wa, float wb) {
+			__m128 q = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a), _mm_set1_ps(wa)), _mm_mul_ps(_mm_loadu_ps(b), _mm_set1_ps(wb)));
+			_mm_storeu_ps(r, _mm_div_ps(q, _mm_sqrt_ps(dot(q, q))));
+		}
+		static float dot(float const* a, float const* b) {
+			return _mm_cvtss_f32(dot(_mm_loadu_ps(a), _mm_loadu_ps(b)));
+		}
+	};
+#endif
+
+	// Bulk conversions between float and the storage formats of storage.hpp, eight scalars per
+	// step. Each produces exactly the bits of the scalar conversion, with the default rounding
+	// mode, except for the payload of NaNs.
+#if defined(MML_SSE)
+	// IEEE half precision held in uint16_t. Without F16C the bits are converted with integer
+	// operations: normal numbers by rebiasing the exponent and rounding the mantissa to nearest
+	// even, subnormals by letting the float unit do the rounding against a magic constant.
+	struct half_kernel {
+		static const bool accelerated = true;
+		static const size_t width = 8;
+#if defined(MML_F16C)
+		static void to_float(float* r, uint16_t const* h) {
+			__m128i const bits = _mm_loadu_si128(reinterpret_cast<__m128i const*>(h));
+			_mm_storeu_ps(r, _mm_cvtph_ps(bits));
+			_mm_storeu_ps(r + 4, _mm_cvtph_ps(_mm_unpackhi_epi64(bits, bits)));
+		}
+		static void from_float(uint16_t* h, float const* f) {
+			__m128i const lo = _mm_cvtps_ph(_mm_loadu_ps(f), _MM_FROUND_TO_NEAREST_INT);
+			__m128i const hi = _mm_cvtps_ph(_mm_loadu_ps(f + 4), _MM_FROUND_TO_NEAREST_INT);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(h), _mm_unpacklo_epi64(lo, hi));
+		}
+#else
+		static __m128 to_float(__m128i h) {
+			__m128i const sign = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16);
+			__m128i o = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x7fff)), 13);
+			__m128i const exponent = _mm_and_si128(o, _mm_set1_epi32(0x7c00 << 13));
+			o = _mm_add_epi32(o, _mm_set1_epi32((127 - 15) << 23));
+			o = _mm_add_epi32(o, _mm_and_si128(_mm_cmpeq_epi32(exponent, _mm_set1_epi32(0x7c00 << 13)), _mm_set1_epi32((128 - 16) << 23)));
+			__m128i const subnormal = _mm_cmpeq_epi32(exponent, _mm_setzero_si128());
+			__m128 const rescaled = _mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(o, _mm_set1_epi32(1 << 23))), _mm_castsi128_ps(_mm_set1_epi32(113 << 23)));
+			o = _mm_or_si128(_mm_and_si128(subnormal, _mm_castps_si128(rescaled)), _mm_andnot_si128(subnormal, o));
+			return _mm_castsi128_ps(_mm_or_si128(o, sign));
+		}
+		static __m128i from_float(__m128 f) {
+			__m128i u = _mm_castps_si128(f);
+			__m128i const sign = _mm_srli_epi32(_mm_and_si128(u, _mm_set1_epi32(int(0x80000000u))), 16);
+			u = _mm_and_si128(u, _mm_set1_epi32(0x7fffffff));
+			__m128i const special = _mm_or_si128(_mm_set1_epi32(0x7c00), _mm_and_si128(_mm_cmpgt_epi32(u, _mm_set1_epi32(255 << 23)), _mm_set1_epi32(0x0200)));
+			__m128 const magic = _mm_castsi128_ps(_mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23));
+			__m128i const subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(u), magic)), _mm_castps_si128(magic));
+			__m128i const odd = _mm_and_si128(_mm_srli_epi32(u, 13), _mm_set1_epi32(1));
+			__m128i const normal = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(u, _mm_set1_epi32(0xfff - (112 << 23))), odd), 13);
+			__m128i const is_special = _mm_cmpgt_epi32(u, _mm_set1_epi32(((127 + 16) << 23) - 1));
+			__m128i const is_subnormal = _mm_cmplt_epi32(u, _mm_set1_epi32(113 << 23));
+			__m128i o = _mm_or_si128(_mm_and_si128(is_subnormal, subnormal), _mm_andnot_si128(is_subnormal, normal));
+			o = _mm_or_si128(_mm_and_si128(is_special, special), _mm_andnot_si128(is_special, o));
+			return _mm_or_si128(o, sign);
+		}
+		static void to_float(float* r, uint16_t const* h) {
+			__m128i const bits = _mm_loadu_si128(reinterpret_cast<__m128i const*>(h));
+			_mm_storeu_ps(r, to_float(_mm_unpacklo_epi16(bits, _mm_setzero_si128())));
+			_mm_storeu_ps(r + 4, to_float(_mm_unpackhi_epi16(bits, _mm_setzero_si128())));
+		}
+		static void from_float(uint16_t* h, float const* f) {
+			// Sign extended, so that the saturating pack keeps all sixteen bits.
+			__m128i const lo = _mm_srai_epi32(_mm_slli_epi32(from_float(_mm_loadu_ps(f)), 16), 16);
+			__m128i const hi = _mm_srai_epi32(_mm_slli_epi32(from_float(_mm_loadu_ps(f + 4)), 16), 16);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(h), _mm_packs_epi32(lo, hi));
+		}
+#endif
+	};
+#else
+	struct half_kernel {
+		static const bool accelerated = false;
+	};
+#endif
+
+	// Normalized integers: unsigned ones map [0, max] to [0, 1], signed ones [-max, max] to
+	// [-1, 1] with the minimum clamped to -1. NaNs are stored as zero.
+	template<typename I>
+	struct normalized_kernel {
+		static const bool accelerated = false;
+	};
+#if defined(MML_SSE)
+	template<typename I>
+	struct normalized_sse_kernel {
+		static const bool accelerated = true;
+		static const size_t width = 8;
+		static const bool is_signed = std::is_signed<I>::value;
+		static constexpr float max = float(std::numeric_limits<I>::max());
+
+		static __m128 to_float(__m128i i) {
+			__m128 const f = _mm_div_ps(_mm_cvtepi32_ps(i), _mm_set1_ps(max));
+			return is_signed ? _mm_max_ps(f, _mm_set1_ps(-1.f)) : f;
+		}
+		static __m128i from_float(float const* p) {
+			__m128 f = _mm_loadu_ps(p);
+			f = _mm_and_ps(f, _mm_cmpord_ps(f, f));
+			f = _mm_min_ps(_mm_max_ps(f, _mm_set1_ps(is_signed ? -1.f : 0.f)), _mm_set1_ps(1.f));
+			return _mm_cvtps_epi32(_mm_mul_ps(f, _mm_set1_ps(max)));
+		}
+		static void to_float(float* r, I const* v) {
+			__m128i lo, hi;
+			if constexpr (sizeof(I) == 1) {
+				__m128i const bytes = _mm_loadl_epi64(reinterpret_cast<__m128i const*>(v));
+				__m128i const words = is_signed ? _mm_srai_epi16(_mm_unpacklo_epi8(bytes, bytes), 8) : _mm_unpacklo_epi8(bytes, _mm_setzero_si128());
+				lo = is_signed ? _mm_srai_epi32(_mm_unpacklo_epi16(words, words), 16) : _mm_unpacklo_epi16(words, _mm_setzero_si128());
+				hi = is_signed ? _mm_srai_epi32(_mm_unpackhi_epi16(words, words), 16) : _mm_unpackhi_epi16(words, _mm_setzero_si128());
+			} else {
+				__m128i const words = _mm_loadu_si128(reinterpret_cast<__m128i const*>(v));
+				lo = is_signed ? _mm_srai_epi32(_mm_unpacklo_epi16(words, words), 16) : _mm_unpacklo_epi16(words, _mm_setzero_si128());
+				hi = is_signed ? _mm_srai_epi32(_mm_unpackhi_epi16(words, words), 16) : _mm_unpackhi_epi16(words, _mm_setzero_si128());
+			}
+			_mm_storeu_ps(r, to_float(lo));
+			_mm_storeu_ps(r + 4, to_float(hi));
+		}
+		static void from_float(I* v, float const* f) {
+			__m128i lo = from_float(f), hi = from_float(f + 4);
+			if constexpr (sizeof(I) == 1) {
+				__m128i const words = _mm_packs_epi32(lo, hi);
+				__m128i const bytes = is_signed ? _mm_packs_epi16(words, words) : _mm_packus_epi16(words, words);
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(v), bytes);
+			} else if constexpr (is_signed) {
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(v), _mm_packs_epi32(lo, hi));
+			} else {
+				// Biased into the signed range for the saturating pack, which SSE2 only has for it.
+				__m128i const bias = _mm_set1_epi32(0x8000);
+				__m128i const words = _mm_packs_epi32(_mm_sub_epi32(lo, bias), _mm_sub_epi32(hi, bias));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(v), _mm_xor_si128(words, _mm_set1_epi16(int16_t(0x8000))));
+			}
+		}
+	};
+	template<> struct normalized_kernel<int8_t> : normalized_sse_kernel<int8_t> {};
+	template<> struct normalized_kernel<uint8_t> : normalized_sse_kernel<uint8_t> {};
+	template<> struct normalized_kernel<int16_t> : normalized_sse_kernel<int16_t> {};
+	template<> struct normalized_kernel<uint16_t> : normalized_sse_kernel<uint16_t> {};
+#endif
+
+	// The polynomial sine and cosine of math::fast_sincos, operation for operation, for four
+	// floats or two doubles per step. F provides the coefficients and the limit, beyond which
+	// lanes take std::sin and std::cos like the scalar function does.
+	template<typename T>
+	struct trigonometry_kernel {
+		static const bool accelerated = false;
+	};
+#if defined(MML_SSE)
+	template<>
+	struct trigonometry_kernel<float> {
+		static const bool accelerated = true;
+		static const size_t width = 4;
+		template<typename F>
+		static void sincos(float* s, float* c, float const* x) {
+			__m128 const v = _mm_loadu_ps(x);
+			int const inside = _mm_movemask_ps(_mm_cmple_ps(_mm_andnot_ps(_mm_set1_ps(-0.f), v), _mm_set1_ps(F::limit)));
+			__m128 const turns = _mm_mul_ps(v, _mm_set1_ps(F::two_over_pi));
+			__m128 const half = _mm_or_ps(_mm_and_ps(turns, _mm_set1_ps(-0.f)), _mm_set1_ps(0.5f));
+			__m128i const quadrant = _mm_cvttps_epi32(_mm_add_ps(turns, half));
+			__m128 const q = _mm_cvtepi32_ps(quadrant);
+			__m128 r = _mm_sub_ps(v, _mm_mul_ps(q, _mm_set1_ps(F::half_pi_1)));
+			r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(F::half_pi_2)));
+			r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(F::half_pi_3)));
+			__m128 const r2 = _mm_mul_ps(r, r);
+			__m128 ps = _mm_add_ps(_mm_set1_ps(F::sin_2), _mm_mul_ps(r2, _mm_set1_ps(F::sin_3)));
+			ps = _mm_add_ps(_mm_set1_ps(F::sin_1), _mm_mul_ps(r2, ps));
+			ps = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), ps));
+			__m128 pc = _mm_add_ps(_mm_set1_ps(F::cos_2), _mm_mul_ps(r2, _mm_set1_ps(F::cos_3)));
+			pc = _mm_add_ps(_mm_set1_ps(F::cos_1), _mm_mul_ps(r2, pc));
+			pc = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(_mm_mul_ps(r2, r2), pc), _mm_mul_ps(_mm_set1_ps(0.5f), r2)), _mm_set1_ps(1.f));
+			__m128i const one = _mm_set1_epi32(1), two = _mm_set1_epi32(2);
+			__m128 const odd = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+			__m128 const negate_sin = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, two), two));
+			__m128 const negate_cos = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), two));
+			__m128 const sign = _mm_set1_ps(-0.f);
+			__m128 const sines = _mm_or_ps(_mm_and_ps(odd, pc), _mm_andnot_ps(odd, ps));
+			__m128 const cosines = _mm_or_ps(_mm_and_ps(odd, ps), _mm_andnot_ps(odd, pc));
+			if (inside != 0xF) {
+				alignas(16) float angles[4], ss[4], cs[4];
+				_mm_store_ps(angles, v);
+				_mm_store_ps(ss, _mm_xor_ps(sines, _mm_and_ps(negate_sin, sign)));
+				_mm_store_ps(cs, _mm_xor_ps(cosines, _mm_and_ps(negate_cos, sign)));
+				for (size_t i = 0; i < 4; i++) {
+					s[i] = inside >> i & 1 ? ss[i] : std::sin(angles[i]);
+					c[i] = inside >> i & 1 ? cs[i] : std::cos(angles[i]);
+				}
+				return;
+			}
+			_mm_storeu_ps(s, _mm_xor_ps(sines, _mm_and_ps(negate_sin, sign)));
+			_mm_storeu_ps(c, _mm_xor_ps(cosines, _mm_and_ps(negate_cos, sign)));
+		}
+	};
+	template<>
+	struct trigonometry_kernel<double> {
+		static const bool accelerated = true;
+		static const size_t width = 2;
+		// Spreads the two 32-bit masks over the 64-bit lanes.
+		static __m128d widen(__m128i mask) {
+			return _mm_castsi128_pd(_mm_shuffle_epi32(mask, _MM_SHUFFLE(1, 1, 0, 0)));
+		}
+		template<typename F>
+		static void sincos(double* s, double* c, double const* x) {
+			__m128d const v = _mm_loadu_pd(x);
+			int const inside = _mm_movemask_pd(_mm_cmple_pd(_mm_andnot_pd(_mm_set1_pd(-0.), v), _mm_set1_pd(F::limit)));
+			__m128d const turns = _mm_mul_pd(v, _mm_set1_pd(F::two_over_pi));
+			__m128d const half = _mm_or_pd(_mm_and_pd(turns, _mm_set1_pd(-0.)), _mm_set1_pd(0.5));
+			__m128i const quadrant = _mm_cvttpd_epi32(_mm_add_pd(turns, half));
+			__m128d const q = _mm_cvtepi32_pd(quadrant);
+			__m128d r = _mm_sub_pd(v, _mm_mul_pd(q, _mm_set1_pd(F::half_pi_1)));
+			r = _mm_sub_pd(r, _mm_mul_pd(q, _mm_set1_pd(F::half_pi_2)));
+			r = _mm_sub_pd(r, _mm_mul_pd(q, _mm_set1_pd(F::half_pi_3)));
+			__m128d const r2 = _mm_mul_pd(r, r);
+			__m128d ps = _mm_add_pd(_mm_set1_pd(F::sin_2), _mm_mul_pd(r2, _mm_set1_pd(F::sin_3)));
+			ps = _mm_add_pd(_mm_set1_pd(F::sin_1), _mm_mul_pd(r2, ps));
+			ps = _mm_add_pd(r, _mm_mul_pd(_mm_mul_pd(r, r2), ps));
+			__m128d pc = _mm_add_pd(_mm_set1_pd(F::cos_2), _mm_mul_pd(r2, _mm_set1_pd(F::cos_3)));
+			pc = _mm_add_pd(_mm_set1_pd(F::cos_1), _mm_mul_pd(r2, pc));
+			pc = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(_mm_mul_pd(r2, r2), pc), _mm_mul_pd(_mm_set1_pd(0.5), r2)), _mm_set1_pd(1.));
+			__m128i const one = _mm_set1_epi32(1), two = _mm_set1_epi32(2);
+			__m128d const odd = widen(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+			__m128d const negate_sin = widen(_mm_cmpeq_epi32(_mm_and_si128(quadrant, two), two));
+			__m128d const negate_cos = widen(_mm_cmpeq_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), two));
+			__m128d const sign = _mm_set1_pd(-0.);
+			__m128d const sines = _mm_or_pd(_mm_and_pd(odd, pc), _mm_andnot_pd(odd, ps));
+			__m128d const cosines = _mm_or_pd(_mm_and_pd(odd, ps), _mm_andnot_pd(odd, pc));
+			if (inside != 0x3) {
+				alignas(16) double angles[2], ss[2], cs[2];
+				_mm_store_pd(angles, v);
+				_mm_store_pd(ss, _mm_xor_pd(sines, _mm_and_pd(negate_sin, sign)));
+				_mm_store_pd(cs, _mm_xor_pd(cosines, _mm_and_pd(negate_cos, sign)));
+				for (size_t i = 0; i < 2; i++) {
+					s[i] = inside >> i & 1 ? ss[i] : std::sin(angles[i]);
+					c[i] = inside >> i & 1 ? cs[i] : std::cos(angles[i]);
+				}
+				return;
+			}
+			_mm_storeu_pd(s, _mm_xor_pd(sines, _mm_and_pd(negate_sin, sign)));
+			_mm_storeu_pd(c, _mm_xor_pd(cosines, _mm_and_pd(negate_cos, sign)));
+		}
+	};
+#endif
+
+	// Arrays of three or four component float vectors, four vectors per step: their squared
+	// lengths, summed in component order like basic_vector does, and the vectors divided or
+	// multiplied by one factor each.
+	template<typename T, size_t S>
+	struct vector_array_kernel {
+		static const bool accelerated = false;
+	};
+#if defined(MML_SSE)
+	template<>
+	struct vector_array_kernel<float, 3> {
+		static const bool accelerated = true;
+		static const size_t width = 4;
+		static void squares(float* sums, float const* v) {
+			__m128 const a = _mm_loadu_ps(v), b = _mm_loadu_ps(v + 4), c = _mm_loadu_ps(v + 8);
+			__m128 const x = _mm_shuffle_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 0)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 1, 0));
+			__m128 const y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+			__m128 const z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+			__m128 sum = _mm_add_ps(_mm_setzero_ps(), _mm_mul_ps(x, x));
+			sum = _mm_add_ps(sum, _mm_mul_ps(y, y));
+			_mm_storeu_ps(sums, _mm_add_ps(sum, _mm_mul_ps(z, z)));
+		}
+		static void scale(float* r, float const* v, float const* factors, bool multiply) {
+			__m128 const f = _mm_loadu_ps(factors);
+			__m128 const fa = _mm_shuffle_ps(f, f, _MM_SHUFFLE(1, 0, 0, 0));
+			__m128 const fb = _mm_shuffle_ps(f, f, _MM_SHUFFLE(2, 2, 1, 1));
+			__m128 const fc = _mm_shuffle_ps(f, f, _MM_SHUFFLE(3, 3, 3, 2));
+			__m128 const a = _mm_loadu_ps(v), b = _mm_loadu_ps(v + 4), c = _mm_loadu_ps(v + 8);
+			_mm_storeu_ps(r, multiply ? _mm_mul_ps(a, fa) : _mm_div_ps(a, fa));
+			_mm_storeu_ps(r + 4, multiply ? _mm_mul_ps(b, fb) : _mm_div_ps(b, fb));
+			_mm_storeu_ps(r + 8, multiply ? _mm_mul_ps(c, fc) : _mm_div_ps(c, fc));
+		}
+	};
+	template<>
+	struct vector_array_kernel<float, 4> {
+		static const bool accelerated = true;
+		static const size_t width = 4;
+		static void squares(float* sums, float const* v) {
+			__m128 x = _mm_loadu_ps(v), y = _mm_loadu_ps(v + 4), z = _mm_loadu_ps(v + 8), w = _mm_loadu_ps(v + 12);
+			_MM_TRANSPOSE4_PS(x, y, z, w);
+			__m128 sum = _mm_add_ps(_mm_setzero_ps(), _mm_mul_ps(x, x));
+			sum = _mm_add_ps(sum, _mm_mul_ps(y, y));
+			sum = _mm_add_ps(sum, _mm_mul_ps(z, z));
+			_mm_storeu_ps(sums, _mm_add_ps(sum, _mm_mul_ps(w, w)));
+		}
+		static void scale(float* r, float const* v, float const* factors, bool multiply) {
+			__m128 const f = _mm_loadu_ps(factors);
+			__m128 const fs[4] = {_mm_shuffle_ps(f, f, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(f, f, _MM_SHUFFLE(1, 1, 1, 1)),
+								  _mm_shuffle_ps(f, f, _MM_SHUFFLE(2, 2, 2, 2)), _mm_shuffle_ps(f, f, _MM_SHUFFLE(3, 3, 3, 3))};
+			for (size_t i = 0; i < 4; i++) {
+				__m128 const a = _mm_loadu_ps(v + i * 4);
+				_mm_storeu_ps(r + i * 4, multiply ? _mm_mul_ps(a, fs[i]) : _mm_div_ps(a, fs[i]));
+			}
+		}
+	};
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,454 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+#include "mml/dynamic_matrix.hpp"
+
+#include "mml/exceptions.hpp"
+DefineNewMMLException(SparseMatrixTooLarge);
+
+namespace mml {
+	// Element types of sparse matrices: scalars, or basic_matrix blocks of a block sparse
+	// matrix such as the 3 x 3 node couplings of a finite element mesh.
+	template<typename V>
+	struct sparse_block {
+		using transposed_type = V;
+
+		static V zero() {
+			return V(0);
+		}
+		static V transposed(V const& value) {
+			return value;
+		}
+	};
+	template<typename T, size_t R, size_t C>
+	struct sparse_block<basic_matrix<T, R, C>> {
+		using transposed_type = basic_matrix<T, C, R>;
+
+		static basic_matrix<T, R, C> zero() {
+			return basic_matrix<T, R, C>(ZeroMatrix);
+		}
+		static transposed_type transposed(basic_matrix<T, R, C> const& value) {
+			transposed_type res(ZeroMatrix);
+			for (size_t r = 0; r < R; r++)
+				for (size_t c = 0; c < C; c++)
+					res.element(c, r) = value.element(r, c);
+			return res;
+		}
+	};
+
+	// One entry of a matrix in coordinate form.
+	template<typename V>
+	struct sparse_entry {
+		size_t row;
+		size_t column;
+		V value;
+	};
+
+	// Compressed sparse matrix, by rows (CSR) in the RowMajor layout and by columns (CSC) in
+	// the ColumnMajor one. The outer array holds where every row (column) starts in the other
+	// two, which hold the column (row) index and the value of each stored entry, sorted by
+	// that index within the row (column). Indices are 32 bit, so a stored entry costs
+	// sizeof(V) + 4 bytes.
+	template<typename V>
+	class sparse_matrix {
+		template<typename> friend class sparse_matrix;
+	public:
+		using value_type = V;
+		using index_type = uint32_t;
+	protected:
+		size_t row_count;
+		size_t column_count;
+		MatrixLayout order;
+		std::vector<size_t> starts;
+		std::vector<index_type, aligned_allocator<index_type>> indices;
+		std::vector<V, aligned_allocator<V>> values;
+
+		size_t outer_count() const {
+			return order == RowMajor ? row_count : column_count;
+		}
+		size_t inner_count() const {
+			return order == RowMajor ? column_count : row_count;
+		}
+		void check_size() const {
+			if (inner_count() > size_t(std::numeric_limits<index_type>::max()))
+				throw Exceptions::SparseMatrixTooLarge("Indices are 32 bit.");
+		}
+	public:
+		sparse_matrix() : row_count(0), column_count(0), order(RowMajor), starts(1, 0) {}
+		// An empty (all zero) matrix.
+		sparse_matrix(size_t rows, size_t columns, MatrixLayout layout = RowMajor)
+			: row_count(rows), column_count(columns), order(layout), starts(outer_count() + 1, 0) {
+			check_size();
+		}
+		// Entries may come in any order; the values of repeated coordinates are summed in the
+		// order they are given, as when element matrices are assembled.
+		sparse_matrix(size_t rows, size_t columns, sparse_entry<V> const* entries, size_t count, MatrixLayout layout = RowMajor)
+			: sparse_matrix(rows, columns, layout) {
+			bool const by_rows = order == RowMajor;
+			auto const outer = [by_rows](sparse_entry<V> const& e) { return by_rows ? e.row : e.column; };
+			auto const inner = [by_rows](sparse_entry<V> const& e) { return by_rows ? e.column : e.row; };
+			for (size_t i = 0; i < count; i++)
+				if (entries[i].row >= rows || entries[i].column >= columns)
+					throw Exceptions::MatrixIndexOutOfBounds("An entry lies outside of the matrix.");
+
+			// A stable counting sort by the outer index, then a stable sort of every row (column)
+			// by the inner one: insertion sort for the usual short ones.
+			for (size_t i = 0; i < count; i++)
+				starts[outer(entries[i]) + 1]++;
+			std::partial_sum(starts.begin(), starts.end(), starts.begin());
+			std::vector<size_t> next(starts.begin(), starts.end() - 1);
+			indices.resize(count);
+			values.resize(count);
+			for (size_t i = 0; i < count; i++) {
+				size_t const position = next[outer(entries[i])]++;
+				indices[position] = index_type(inner(entries[i]));
+				values[position] = entries[i].value;
+			}
+			std::vector<size_t> permutation;
+			for (size_t o = 0; o < outer_count(); o++) {
+				size_t const first = starts[o], last = starts[o + 1];
+				if (last - first <= 32)
+					for (size_t k = first + 1; k < last; k++) {
+						index_type const index = indices[k];
+						if (indices[k - 1] <= index)
+							continue;
+						V const value = values[k];
+						size_t j = k;
+						for (; j > first && indices[j - 1] > index; j--) {
+							indices[j] = indices[j - 1];
+							values[j] = values[j - 1];
+						}
+						indices[j] = index;
+						values[j] = value;
+					}
+				else {
+					permutation.resize(last - first);
+					std::iota(permutation.begin(), permutation.end(), first);
+					std::stable_sort(permutation.begin(), permutation.end(), [this](size_t a, size_t b) { return indices[a] < indices[b]; });
+					std::vector<index_type> sorted_indices(permutation.size());
+					std::vector<V> sorted_values;
+					sorted_values.reserve(permutation.size());
+					for (size_t k = 0; k < permutation.size(); k++) {
+						sorted_indices[k] = indices[permutation[k]];
+						sorted_values.push_back(values[permutation[k]]);
+					}
+					std::copy(sorted_indices.begin(), sorted_indices.end(), indices.begin() + first);
+					std::copy(sorted_values.begin(), sorted_values.end(), values.begin() + first);
+				}
+			}
+
+			// Merges repeated coordinates, which are now adjacent.
+			size_t stored = 0;
+			for (size_t o = 0; o < outer_count(); o++) {
+				size_t const first = starts[o], last = starts[o + 1];
+				starts[o] = stored;
+				for (size_t k = first; k < last; k++)
+					if (stored > starts[o] && indices[stored - 1] == indices[k])
+						values[stored - 1] += values[k];
+					else {
+						indices[stored] = indices[k];
+						values[stored] = values[k];
+						stored++;
+					}
+			}
+			starts[outer_count()] = stored;
+			indices.resize(stored);
+			values.resize(stored);
+			indices.shrink_to_fit();
+			values.shrink_to_fit();
+		}
+		sparse_matrix(size_t rows, size_t columns, std::vector<sparse_entry<V>> const& entries, MatrixLayout layout = RowMajor)
+			: sparse_matrix(rows, columns, entries.data(), entries.size(), layout) {}
+
+		size_t rows() const {
+			return row_count;
+		}
+		size_t columns() const {
+			return column_count;
+		}
+		MatrixLayout layout() const {
+			return order;
+		}
+		size_t non_zeros() const {
+			return values.size();
+		}
+		// Bytes taken by the three arrays.
+		size_t memory_size() const {
+			return starts.size() * sizeof(size_t) + indices.size() * sizeof(index_type) + values.size() * sizeof(V);
+		}
+		// Raw compressed arrays: outer_starts() has an entry per row (column) and one more.
+		size_t const* outer_starts() const {
+			return starts.data();
+		}
+		index_type const* inner_indices() const {
+			return indices.data();
+		}
+		V const* data() const {
+			return values.data();
+		}
+		V* data() {
+			return values.data();
+		}
+
+		// Binary search within the row (column); entries that are not stored are zero.
+		V at(size_t r, size_t c) const noexcept(MML_BOUNDS_NOEXCEPT) {
+			CheckMMLBounds(r < row_count && c < column_count, MatrixIndexOutOfBounds);
+			size_t const o = order == RowMajor ? r : c, i = order == RowMajor ? c : r;
+			auto const first = indices.begin() + starts[o], last = indices.begin() + starts[o + 1];
+			auto const found = std::lower_bound(first, last, index_type(i));
+			return found != last && *found == i ? values[size_t(found - indices.begin())] : sparse_block<V>::zero();
+		}
+		V operator()(size_t r, size_t c) const noexcept(MML_BOUNDS_NOEXCEPT) {
+			return at(r, c);
+		}
+
+		// Reinterprets the arrays in the other layout, so it costs a copy but no sorting; blocks
+		// are transposed as well.
+		sparse_matrix<typename sparse_block<V>::transposed_type> transposed() const {
+			sparse_matrix<typename sparse_block<V>::transposed_type> res;
+			res.row_count = column_count;
+			res.column_count = row_count;
+			res.order = order == RowMajor ? ColumnMajor : RowMajor;
+			res.starts = starts;
+			res.indices = indices;
+			res.values.resize(values.size(), sparse_block<typename sparse_block<V>::transposed_type>::zero());
+			for (size_t k = 0; k < values.size(); k++)
+				res.values[k] = sparse_block<V>::transposed(values[k]);
+			return res;
+		}
+		// Converts between CSR and CSC with one counting sort.
+		sparse_matrix<V> with_layout(MatrixLayout layout) const {
+			if (layout == order)
+				return *this;
+			sparse_matrix<V> res(row_count, column_count, layout);
+			for (index_type i : indices)
+				res.starts[size_t(i) + 1]++;
+			std::partial_sum(res.starts.begin(), res.starts.end(), res.starts.begin());
+			std::vector<size_t> next(res.starts.begin(), res.starts.end() - 1);
+			res.indices.resize(indices.size());
+			res.values.resize(values.size(), sparse_block<V>::zero());
+			for (size_t o = 0; o < outer_count(); o++)
+				for (size_t k = starts[o]; k < starts[o + 1]; k++) {
+					size_t const position = next[indices[k]]++;
+					res.indices[position] = index_type(o);
+					res.values[position] = values[k];
+				}
+			return res;
+		}
+		template<typename V_ = V, typename = typename std::enable_if<std::is_arithmetic<V_>::value>::type>
+		explicit operator dynamic_matrix<V_>() const {
+			dynamic_matrix<V> res(row_count, column_count, ZeroMatrix);
+			for (size_t o = 0; o < outer_count(); o++)
+				for (size_t k = starts[o]; k < starts[o + 1]; k++)
+					(order == RowMajor ? res.element(o, indices[k]) : res.element(indices[k], o)) = values[k];
+			return res;
+		}
+	};
+
+	// Collects coordinate entries, e.g. during finite element assembly, and compresses them.
+	template<typename V>
+	class sparse_builder {
+	protected:
+		size_t row_count;
+		size_t column_count;
+		std::vector<sparse_entry<V>> entries;
+	public:
+		sparse_builder(size_t rows, size_t columns, size_t capacity = 0) : row_count(rows), column_count(columns) {
+			entries.reserve(capacity);
+		}
+
+		size_t rows() const {
+			return row_count;
+		}
+		size_t columns() const {
+			return column_count;
+		}
+		size_t size() const {
+			return entries.size();
+		}
+		sparse_entry<V> const* data() const {
+			return entries.data();
+		}
+		void reserve(size_t capacity) {
+			entries.reserve(capacity);
+		}
+		void clear() {
+			entries.clear();
+		}
+		void add(size_t r, size_t c, V const& value) noexcept(MML_BOUNDS_NOEXCEPT) {
+			CheckMMLBounds(r < row_count && c < column_count, MatrixIndexOutOfBounds);
+			entries.push_back({r, c, value});
+		}
+		sparse_matrix<V> build(MatrixLayout layout = RowMajor) const {
+			return sparse_matrix<V>(row_count, column_count, entries.data(), entries.size(), layout);
+		}
+	};
+
+	// Products of an element of a sparse matrix with an element of a dense vector: scalars
+	// with scalars or with basic_vectors (the rows of a dense multi-vector), and blocks with
+	// basic_vectors of their column count. Accumulation goes through element(), so sums do
+	// not depend on how well the expression templates inline.
+	template<typename V, typename X, typename = void>
+	struct sparse_product {};
+	template<typename V, typename X>
+	struct sparse_product<V, X, typename std::enable_if<std::is_arithmetic<V>::value && std::is_arithmetic<X>::value>::type> {
+		using type = V;
+
+		static type zero() {
+			return type(0);
+		}
+		static void accumulate(type& sum, V const& a, X const& x) {
+			sum += a * V(x);
+		}
+		template<typename Y>
+		static void store(Y& y, type const& sum) {
+			y = sum;
+		}
+	};
+	template<typename V, typename X>
+	struct sparse_product<V, X, typename std::enable_if<std::is_arithmetic<V>::value && std::is_arithmetic<typename X::value_type>::value
+		&& std::is_base_of<basic_vector<typename X::value_type, X::size_value>, X>::value>::type> {
+		static const size_t S = X::size_value;
+		using type = basic_vector<V, S>;
+
+		static type zero() {
+			return type();
+		}
+		static void accumulate(type& sum, V const& a, X const& x) {
+			for (size_t i = 0; i < S; i++)
+				sum.element(i) += a * V(x.element(i));
+		}
+		template<typename Y>
+		static void store(Y& y, type const& sum) {
+			store_vector(y, sum);
+		}
+	};
+	template<typename T, size_t R, size_t C, typename X>
+	struct sparse_product<basic_matrix<T, R, C>, X, typename std::enable_if<std::is_base_of<basic_vector<T, C>, X>::value>::type> {
+		using type = basic_vector<T, R>;
+
+		static type zero() {
+			return type();
+		}
+		static void accumulate(type& sum, basic_matrix<T, R, C> const& a, X const& x) {
+			for (size_t r = 0; r < R; r++)
+				for (size_t c = 0; c < C; c++)
+					sum.element(r) += a.element(r, c) * x.element(c);
+		}
+		template<typename Y>
+		static void store(Y& y, type const& sum) {
+			store_vector(y, sum);
+		}
+	};
+
+	// y = A * x for arrays of A.columns() and A.rows() elements. Rows of a CSR matrix are
+	// split over the pool into ranges of about chunk stored entries each, so long rows do not
+	// stall one thread, and every row is summed in storage order whatever the thread count.
+	// A CSC matrix is scattered column by column, every thread into its own range of rows,
+	// which it finds in each column by a binary search; the sums run in column order, as on
+	// one thread. Converting it with with_layout(RowMajor) saves the searches when it is
+	// multiplied repeatedly.
+	template<typename V, typename X, typename Y>
+	void multiply(sparse_matrix<V> const& a, X const* x, Y* y, size_t chunk = default_chunk_size<V>(), thread_pool& pool = default_thread_pool()) {
+		using P = sparse_product<V, X>;
+		size_t const* starts = a.outer_starts();
+		auto const* indices = a.inner_indices();
+		V const* values = a.data();
+		if (a.layout() == ColumnMajor) {
+			size_t const parts = std::min(pool.size(), a.rows());
+			pool.parallel_for(parts, 1, [&](size_t first, size_t last) {
+				size_t const top = a.rows() * first / parts, bottom = a.rows() * last / parts;
+				std::vector<typename P::type> sums(bottom - top, P::zero());
+				for (size_t c = 0; c < a.columns(); c++) {
+					size_t k = top == 0 ? starts[c] : size_t(std::lower_bound(indices + starts[c], indices + starts[c + 1], top) - indices);
+					for (; k < starts[c + 1] && indices[k] < bottom; k++)
+						P::accumulate(sums[indices[k] - top], values[k], x[c]);
+				}
+				for (size_t r = top; r < bottom; r++)
+					P::store(y[r], sums[r - top]);
+			});
+			return;
+		}
+		size_t const count = a.non_zeros();
+		size_t const parts = std::max<size_t>(count / std::max<size_t>(chunk, 1), 1);
+		auto const boundary = [&](size_t part) {
+			if (part == parts)
+				return a.rows();
+			return size_t(std::lower_bound(starts, starts + a.rows(), count / parts * part + std::min(part, count % parts)) - starts);
+		};
+		pool.parallel_for(parts, 1, [&](size_t first, size_t last) {
+			for (size_t r = boundary(first); r < boundary(last); r++) {
+				auto sum = P::zero();
+				for (size_t k = starts[r]; k < starts[r + 1]; k++)
+					P::accumulate(sum, values[k], x[indices[k]]);
+				P::store(y[r], sum);
+			}
+		});
+	}
+	template<typename V, typename X, typename Y>
+	void multiply(sparse_matrix<V> const& a, std::vector<X> const& x, std::vector<Y>& y, thread_pool& pool = default_thread_pool()) {
+		if (x.size() != a.columns())
+			throw Exceptions::MatrixSizeMismatch("There has to be one element per column.");
+		y.resize(a.rows());
+		multiply(a, x.data(), y.data(), default_chunk_size<V>(), pool);
+	}
+	template<typename V, typename X>
+	std::vector<typename sparse_product<V, X>::type> operator*(sparse_matrix<V> const& a, std::vector<X> const& x) {
+		std::vector<typename sparse_product<V, X>::type> res;
+		multiply(a, x, res);
+		return res;
+	}
+
+	// C = A * B with a dense B of any layout, keeping the layout of C. Threads own ranges of
+	// rows of C for either layout of A, as in the product with a vector.
+	template<typename T>
+	void multiply(sparse_matrix<T> const& a, dynamic_matrix<T> const& b, dynamic_matrix<T>& c, thread_pool& pool = default_thread_pool()) {
+		if (a.columns() != b.rows())
+			throw Exceptions::MatrixSizeMismatch("Inner dimensions differ.");
+		if (&c == &b) {
+			dynamic_matrix<T> res(0, 0, ZeroMatrix, c.layout());
+			multiply(a, b, res, pool);
+			c = std::move(res);
+			return;
+		}
+		c = dynamic_matrix<T>(a.rows(), b.columns(), ZeroMatrix, c.layout());
+		size_t const* starts = a.outer_starts();
+		auto const* indices = a.inner_indices();
+		T const* values = a.data();
+		if (a.layout() == ColumnMajor) {
+			size_t const parts = std::min(pool.size(), a.rows());
+			pool.parallel_for(parts, 1, [&](size_t first, size_t last) {
+				size_t const top = a.rows() * first / parts, bottom = a.rows() * last / parts;
+				for (size_t k = 0; k < a.columns(); k++) {
+					size_t p = top == 0 ? starts[k] : size_t(std::lower_bound(indices + starts[k], indices + starts[k + 1], top) - indices);
+					for (; p < starts[k + 1] && indices[p] < bottom; p++)
+						for (size_t j = 0; j < b.columns(); j++)
+							c.element(indices[p], j) += values[p] * b.element(k, j);
+				}
+			});
+			return;
+		}
+		pool.parallel_for(a.rows(), std::max<size_t>(default_chunk_size<T>() / std::max<size_t>(b.columns(), 1), 1), [&](size_t first, size_t last) {
+			for (size_t r = first; r < last; r++)
+				for (size_t p = starts[r]; p < starts[r + 1]; p++)
+					for (size_t j = 0; j < b.columns(); j++)
+						c.element(r, j) += values[p] * b.element(indices[p], j);
+		});
+	}
+	template<typename T>
+	dynamic_matrix<T> operator*(sparse_matrix<T> const& a, dynamic_matrix<T> const& b) {
+		dynamic_matrix<T> res;
+		multiply(a, b, res);
+		return res;
+	}
+
+	class sparse_matrixf : public sparse_matrix<float> { public: using sparse_matrix::sparse_matrix; };
+	class sparse_matrixd : public sparse_matrix<double> { public: using sparse_matrix::sparse_matrix; };
+	class block_sparse_matrix3f : public sparse_matrix<basic_matrix<float, 3u, 3u>> { public: using sparse_matrix::sparse_matrix; };
+	class block_sparse_matrix3d : public sparse_matrix<basic_matrix<double, 3u, 3u>> { public: using sparse_matrix::sparse_matrix; };
+}
\ No newline at end of file
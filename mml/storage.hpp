@@ -0,0 +1,184 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include "mml/vector.hpp"
+
+namespace mml {
+	// Compact scalar formats for storing vectors. They convert to and from float implicitly,
+	// but have no arithmetic of their own: convert() moves whole arrays to vector*f for
+	// computation and back.
+
+	// IEEE 754 binary16. Conversion from float rounds to nearest even, overflows to infinity
+	// and keeps NaNs.
+	class half {
+	public:
+		using bits_type = uint16_t;
+		using kernel = simd::half_kernel;
+	protected:
+		bits_type value;
+	public:
+		constexpr half() : value(0) {}
+		half(float f) : value(from_float(f)) {}
+		operator float() const {
+			return to_float(value);
+		}
+		static constexpr half from_bits(bits_type bits) {
+			half res;
+			res.value = bits;
+			return res;
+		}
+		constexpr bits_type bits() const {
+			return value;
+		}
+
+		static float to_float(bits_type h) {
+			uint32_t o = uint32_t(h & 0x7fff) << 13;
+			uint32_t const exponent = o & (0x7c00u << 13);
+			o += (127 - 15) << 23;
+			if (exponent == 0x7c00u << 13)
+				o += (128 - 16) << 23;
+			else if (exponent == 0) {
+				o += 1 << 23;
+				float rescaled, magic;
+				uint32_t const magic_bits = 113 << 23;
+				std::memcpy(&rescaled, &o, sizeof(o));
+				std::memcpy(&magic, &magic_bits, sizeof(magic));
+				rescaled -= magic;
+				std::memcpy(&o, &rescaled, sizeof(o));
+			}
+			o |= uint32_t(h & 0x8000) << 16;
+			float res;
+			std::memcpy(&res, &o, sizeof(res));
+			return res;
+		}
+		static bits_type from_float(float f) {
+			uint32_t u;
+			std::memcpy(&u, &f, sizeof(u));
+			uint32_t const sign = (u & 0x80000000u) >> 16;
+			u &= 0x7fffffffu;
+			uint32_t o;
+			if (u >= (127 + 16) << 23)
+				o = u > 255u << 23 ? 0x7e00 : 0x7c00;
+			else if (u < 113 << 23) {
+				float magic, value;
+				uint32_t const magic_bits = ((127 - 15) + (23 - 10) + 1) << 23;
+				std::memcpy(&magic, &magic_bits, sizeof(magic));
+				std::memcpy(&value, &u, sizeof(value));
+				value += magic;
+				std::memcpy(&o, &value, sizeof(o));
+				o -= magic_bits;
+			} else
+				o = (u + (uint32_t(15 - 127) << 23) + 0xfff + ((u >> 13) & 1)) >> 13;
+			return bits_type(o | sign);
+		}
+	};
+
+	// Fixed-point fractions of the full range of I: unsigned types store [0, 1], signed ones
+	// [-1, 1], where the lowest value also reads as -1. Conversion from float clamps, rounds to
+	// nearest even and stores NaNs as zero.
+	template<typename I>
+	class normalized {
+		static_assert(std::is_integral<I>::value && sizeof(I) <= 2, "Only 8 and 16 bit integers are supported as normalized storage.");
+	public:
+		using bits_type = I;
+		using kernel = simd::normalized_kernel<I>;
+		static constexpr float max = float(std::numeric_limits<I>::max());
+	protected:
+		bits_type value;
+	public:
+		constexpr normalized() : value(0) {}
+		constexpr normalized(float f) : value(from_float(f)) {}
+		constexpr operator float() const {
+			return to_float(value);
+		}
+		static constexpr normalized from_bits(bits_type bits) {
+			normalized res;
+			res.value = bits;
+			return res;
+		}
+		constexpr bits_type bits() const {
+			return value;
+		}
+
+		static constexpr float to_float(bits_type v) {
+			float const res = float(v) / max;
+			return res < -1.f ? -1.f : res;
+		}
+		static constexpr bits_type from_float(float f) {
+			if (f != f)
+				return bits_type(0);
+			float const lowest = std::is_signed<I>::value ? -1.f : 0.f;
+			float const scaled = (f < lowest ? lowest : f > 1.f ? 1.f : f) * max;
+			float const magnitude = scaled < 0.f ? -scaled : scaled;
+			int32_t rounded = int32_t(magnitude);
+			float const fraction = magnitude - float(rounded);
+			if (fraction > .5f || (fraction == .5f && (rounded & 1)))
+				rounded++;
+			return bits_type(scaled < 0.f ? -rounded : rounded);
+		}
+	};
+	using unorm8 = normalized<uint8_t>;
+	using snorm8 = normalized<int8_t>;
+	using unorm16 = normalized<uint16_t>;
+	using snorm16 = normalized<int16_t>;
+
+	template<typename T> struct is_storage_scalar : std::false_type {};
+	template<> struct is_storage_scalar<half> : std::true_type {};
+	template<typename I> struct is_storage_scalar<normalized<I>> : std::true_type {};
+
+	// Bulk conversion of count vectors, e.g. a vertex stream, with the kernels of simd.hpp for
+	// all but the last few scalars. Both arrays are treated as flat arrays of count * S scalars.
+	template<typename T, size_t S>
+	auto convert(basic_vector<T, S> const* input, basic_vector<float, S>* output, size_t count) -> typename std::enable_if<is_storage_scalar<T>::value>::type {
+		static_assert(sizeof(basic_vector<T, S>) == sizeof(T) * S && sizeof(basic_vector<float, S>) == sizeof(float) * S, "Vectors have to be tightly packed.");
+		using K = typename T::kernel;
+		auto const* in = reinterpret_cast<typename T::bits_type const*>(input);
+		auto* out = reinterpret_cast<float*>(output);
+		size_t const size = count * S;
+		size_t i = 0;
+		if constexpr (K::accelerated)
+			for (size_t const whole = size - size % K::width; i < whole; i += K::width)
+				K::to_float(out + i, in + i);
+		for (; i < size; i++)
+			out[i] = T::to_float(in[i]);
+	}
+	template<typename T, size_t S>
+	auto convert(basic_vector<float, S> const* input, basic_vector<T, S>* output, size_t count) -> typename std::enable_if<is_storage_scalar<T>::value>::type {
+		static_assert(sizeof(basic_vector<T, S>) == sizeof(T) * S && sizeof(basic_vector<float, S>) == sizeof(float) * S, "Vectors have to be tightly packed.");
+		using K = typename T::kernel;
+		auto const* in = reinterpret_cast<float const*>(input);
+		auto* out = reinterpret_cast<typename T::bits_type*>(output);
+		size_t const size = count * S;
+		size_t i = 0;
+		if constexpr (K::accelerated)
+			for (size_t const whole = size - size % K::width; i < whole; i += K::width)
+				K::from_float(out + i, in + i);
+		for (; i < size; i++)
+			out[i] = T::from_float(in[i]);
+	}
+
+	class vector2h : public basic_vector<half, 2u> { public: using basic_vector::basic_vector; };
+	class vector3h : public basic_vector<half, 3u> { public: using basic_vector::basic_vector; };
+	class vector4h : public basic_vector<half, 4u> { public: using basic_vector::basic_vector; };
+
+	class vector2n8 : public basic_vector<unorm8, 2u> { public: using basic_vector::basic_vector; };
+	class vector3n8 : public basic_vector<unorm8, 3u> { public: using basic_vector::basic_vector; };
+	class vector4n8 : public basic_vector<unorm8, 4u> { public: using basic_vector::basic_vector; };
+
+	class vector2n16 : public basic_vector<unorm16, 2u> { public: using basic_vector::basic_vector; };
+	class vector3n16 : public basic_vector<unorm16, 3u> { public: using basic_vector::basic_vector; };
+	class vector4n16 : public basic_vector<unorm16, 4u> { public: using basic_vector::basic_vector; };
+
+	class vector2sn8 : public basic_vector<snorm8, 2u> { public: using basic_vector::basic_vector; };
+	class vector3sn8 : public basic_vector<snorm8, 3u> { public: using basic_vector::basic_vector; };
+	class vector4sn8 : public basic_vector<snorm8, 4u> { public: using basic_vector::basic_vector; };
+
+	class vector2sn16 : public basic_vector<snorm16, 2u> { public: using basic_vector::basic_vector; };
+	class vector3sn16 : public basic_vector<snorm16, 3u> { public: using basic_vector::basic_vector; };
+	class vector4sn16 : public basic_vector<snorm16, 4u> { public: using basic_vector::basic_vector; };
+
+	static_assert(sizeof(vector3h) == 6 && sizeof(vector4n16) == 8 && sizeof(vector4n8) == 4, "Storage vectors have to be tightly packed.");
+}
\ No newline at end of file
@@ -0,0 +1,175 @@
+#pragma once
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "mml/parallel.hpp"
+#include "mml/transformation.hpp"
+
+#include "mml/exceptions.hpp"
+DefineNewMMLException(TransformTreeNodeIsNotValid);
+
+namespace mml {
+	// Hierarchy of transformations stored as flat arrays in depth-first order, so every subtree
+	// is the contiguous range [i, end(i)) and a parent always precedes its children. Changing a
+	// local matrix only marks its node; update() recomputes the world matrices of the marked
+	// subtrees, distributing independent subtrees over the pool.
+	template<typename T, size_t S>
+	class transform_tree {
+	public:
+		using matrix_type = basic_transformation<T, S>;
+		static const size_t npos = std::numeric_limits<size_t>::max();
+	protected:
+		using base_type = basic_matrix<T, S + 1, S + 1>;
+
+		std::vector<matrix_type> locals;
+		std::vector<matrix_type> worlds;
+		std::vector<size_t> parents;
+		std::vector<size_t> ends;
+		std::vector<bool> marked;
+		std::vector<size_t> dirty;
+		size_t recomputed_last = 0;
+		size_t subtrees_last = 0;
+		size_t recomputed_total = 0;
+
+		void mark(size_t node) {
+			if (!marked[node]) {
+				marked[node] = true;
+				dirty.push_back(node);
+			}
+		}
+		void compute(size_t node) {
+			if (parents[node] == npos)
+				worlds[node] = locals[node];
+			else
+				static_cast<base_type&>(worlds[node]) = worlds[parents[node]] * locals[node];
+		}
+		void compute(size_t first, size_t last) {
+			for (size_t i = first; i < last; i++)
+				compute(i);
+		}
+	public:
+		transform_tree() {}
+
+		size_t size() const {
+			return locals.size();
+		}
+		void reserve(size_t count) {
+			locals.reserve(count);
+			worlds.reserve(count);
+			parents.reserve(count);
+			ends.reserve(count);
+			marked.reserve(count);
+		}
+		void clear() {
+			locals.clear();
+			worlds.clear();
+			parents.clear();
+			ends.clear();
+			marked.clear();
+			dirty.clear();
+		}
+
+		// Nodes are added in depth-first order: the parent has to be the last added node or one
+		// of its ancestors. npos adds a new root. Returns the index of the node.
+		size_t add(size_t parent, matrix_type const& local = matrix_type()) {
+			if (parent != npos && (parent >= size() || ends[parent] != size()))
+				throw Exceptions::TransformTreeNodeIsNotValid("Nodes have to be added in depth-first order.");
+			size_t const node = size();
+			locals.push_back(local);
+			worlds.push_back(local);
+			parents.push_back(parent);
+			ends.push_back(node + 1);
+			marked.push_back(false);
+			for (size_t p = parent; p != npos; p = parents[p])
+				ends[p] = node + 1;
+			mark(node);
+			return node;
+		}
+
+		size_t parent(size_t node) const {
+			return parents[node];
+		}
+		// One past the last node of the subtree rooted at node.
+		size_t end(size_t node) const {
+			return ends[node];
+		}
+		matrix_type const& local(size_t node) const {
+			return locals[node];
+		}
+		// Up to date for nodes whose ancestors have not changed since the last update().
+		matrix_type const& world(size_t node) const {
+			return worlds[node];
+		}
+		void set_local(size_t node, matrix_type const& local) {
+			locals[node] = local;
+			mark(node);
+		}
+		bool is_dirty(size_t node) const {
+			for (size_t p = node; p != npos; p = parents[p])
+				if (marked[p])
+					return true;
+			return false;
+		}
+
+		// Subtrees larger than grain are split into their root, computed here, and the subtrees
+		// of its children, so one large change is spread over the pool as well.
+		void update(size_t grain = 1024, thread_pool& pool = default_thread_pool()) {
+			std::sort(dirty.begin(), dirty.end());
+			std::vector<size_t> roots;
+			for (size_t node : dirty)
+				if (roots.empty() || node >= ends[roots.back()])
+					roots.push_back(node);
+			for (size_t node : dirty)
+				marked[node] = false;
+			dirty.clear();
+
+			std::vector<size_t> work;
+			size_t count = 0;
+			grain = std::max<size_t>(grain, 1);
+			while (!roots.empty()) {
+				size_t const node = roots.back();
+				roots.pop_back();
+				if (ends[node] - node <= grain) {
+					work.push_back(node);
+					continue;
+				}
+				compute(node);
+				count++;
+				for (size_t child = node + 1; child < ends[node]; child = ends[child])
+					roots.push_back(child);
+			}
+			subtrees_last = work.size();
+			for (size_t node : work)
+				count += ends[node] - node;
+
+			size_t const chunk = std::max<size_t>(work.size() * grain / std::max<size_t>(count, 1), 1);
+			pool.parallel_for(work.size(), chunk, [&](size_t first, size_t last) {
+				for (size_t i = first; i < last; i++)
+					compute(work[i], ends[work[i]]);
+			});
+			recomputed_last = count;
+			recomputed_total += count;
+		}
+
+		// Counters: world matrices recomputed and independent subtrees scheduled by the last
+		// update(), and world matrices recomputed since construction or reset_counters().
+		size_t last_recomputed() const {
+			return recomputed_last;
+		}
+		size_t last_subtrees() const {
+			return subtrees_last;
+		}
+		size_t total_recomputed() const {
+			return recomputed_total;
+		}
+		void reset_counters() {
+			recomputed_last = subtrees_last = recomputed_total = 0;
+		}
+	};
+
+	class transform_tree2f : public transform_tree<float, 2u> { public: using transform_tree::transform_tree; };
+	class transform_tree3f : public transform_tree<float, 3u> { public: using transform_tree::transform_tree; };
+	class transform_tree2d : public transform_tree<double, 2u> { public: using transform_tree::transform_tree; };
+	class transform_tree3d : public transform_tree<double, 3u> { public: using transform_tree::transform_tree; };
+}
\ No newline at end of file
@@ -6,110 +6,179 @@ DefineNewMMLException(TransformationError)
 
 namespace mml {
 	template <typename T, size_t S> class basic_transformation;
-	template <typename T> basic_transformation<T, 2> rotation(T const& angle);
-	template <typename T, typename T_O, typename = typename std::enable_if<std::is_convertible<T, T_O>::value>::type> 
-		basic_transformation<T, 3> rotation(T const& angle, basic_vector<T, 3> const& axis);
+	template <typename T> constexpr basic_transformation<T, 2> rotation(T const& angle);
+	template <typename T> constexpr basic_transformation<T, 3> rotation(T const& angle, basic_vector<T, 3> const& axis);
+	template <typename T, size_t R, size_t C> constexpr basic_transformation<T, R - 1> affine_inverse(basic_matrix<T, R, C> const& m);
+	template <typename T, size_t R, size_t C> constexpr basic_transformation<T, R - 1> rigid_inverse(basic_matrix<T, R, C> const& m);
 
 	template <typename T, size_t S>
 	class basic_transformation : public basic_matrix<T, S + 1, S + 1> {
 	protected:
 		using basic_matrix<T, S + 1, S + 1>::data;
+
+		// Left-multiplies by a purely linear transformation, so only the first S rows change.
+		constexpr void transform_rows(basic_matrix<T, S + 1, S + 1> const& m) {
+			MMLCount(products, 1);
+			MMLCount(flops, 2 * S * S * (S + 1));
+			T rows[S][S + 1] = {};
+			for (size_t r = 0; r < S; r++)
+				for (size_t k = 0; k < S; k++)
+					for (size_t c = 0; c < S + 1; c++)
+						rows[r][c] += m.element(r, k) * data[k].element(c);
+			for (size_t r = 0; r < S; r++)
+				for (size_t c = 0; c < S + 1; c++)
+					data[r].element(c) = rows[r][c];
+		}
 	public:
 		using basic_matrix<T, S + 1, S + 1>::basic_matrix;
 
 		template <typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-		basic_transformation<T, S> translate(basic_vector<T_O, S> const& direction) {
+		constexpr basic_transformation<T, S> translate(basic_vector<T_O, S> const& direction) {
 			for (size_t r = 0; r < S + 1; r++)
-				data[r][S] += dot(data[r], direction);
+				data[r].element(S) += dot(data[r], direction);
 			return *this;
 		}
 		template <typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-		basic_transformation<T, S> scale(basic_vector<T_O, S> const& direction) {
+		constexpr basic_transformation<T, S> scale(basic_vector<T_O, S> const& direction) {
 			for (size_t r = 0; r < S + 1; r++)
 				data[r] *= direction;
 			return *this;
 		}
-		template <typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type, typename = typename std::enable_if<S == 2>::type>
-		basic_transformation<T, S> rotate(T_O const& angle) {
-			auto res = (rotation<T>(angle) * *this);
-			for (size_t r = 0; r < S + 1; r++)
-				data[r] = res[r];
+		template <typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type, size_t S_ = S, typename = typename std::enable_if<S_ == 2>::type>
+		constexpr basic_transformation<T, S> rotate(T_O const& angle) {
+			transform_rows(rotation<T>(angle));
 			return *this;
 		}
 		template <typename T_O, typename T_OO, typename = typename std::enable_if<std::is_convertible<T, T_O>::value>::type, 
-			typename = typename std::enable_if<std::is_convertible<T, T_OO>::value>::type, typename = typename std::enable_if<S == 3>::type>
-		basic_transformation<T, S> rotate(T_O const& angle, basic_vector<T_OO, S> const& axis) {
-			auto res = (rotation<T>(angle, axis) * *this);
-			for (size_t r = 0; r < S + 1; r++)
-				data[r] = res[r];
+			typename = typename std::enable_if<std::is_convertible<T, T_OO>::value>::type, size_t S_ = S, typename = typename std::enable_if<S_ == 3>::type>
+		constexpr basic_transformation<T, S> rotate(T_O const& angle, basic_vector<T_OO, S> const& axis) {
+			transform_rows(rotation<T>(angle, axis));
 			return *this;
 		}
+
+		constexpr basic_transformation<T, S> affine_inverse() const {
+			return mml::affine_inverse(*this);
+		}
+		constexpr basic_transformation<T, S> rigid_inverse() const {
+			return mml::rigid_inverse(*this);
+		}
 	};
 	
 	template <typename T, size_t S, typename = typename std::enable_if<(S > 1)>::type>
-	inline basic_transformation<T, S> translation(basic_vector<T, S> const& direction) {
+	constexpr basic_transformation<T, S> translation(basic_vector<T, S> const& direction) {
 		basic_transformation<T, S> res;
 		for (size_t i = 0; i < S; i++)
-			res[i][S] = direction[i];
+			res.element(i, S) = direction.element(i);
 		return res;
 	}
 	template <typename T, size_t S, typename = typename std::enable_if<(S > 1)>::type>
-	inline basic_transformation<T, S> scaling(basic_vector<T, S> const& direction) {
+	constexpr basic_transformation<T, S> scaling(basic_vector<T, S> const& direction) {
 		basic_transformation<T, S> res;
 		for (size_t i = 0; i < S; i++)
-			res[i][i] = direction[i];
+			res.element(i, i) = direction.element(i);
 		return res;
 	}
+	// The builders from a sine and cosine construct the rows in place, which compiles to a few
+	// register stores instead of patching an identity matrix through memory.
 	template <typename T>
-	inline basic_transformation<T, 3> rotation_x(T const& angle) {
-		return {{T(1), T(0), T(0), T(0)},
-		{T(0), std::cos(angle), -std::sin(angle), T(0)},
-		{T(0), std::sin(angle), std::cos(angle), T(0)},
-		{T(0), T(0), T(0), T(1)}};
+	constexpr basic_transformation<T, 3> rotation_x(math::sine_cosine<T> const& angle) {
+		using row = basic_vector<T, 4>;
+		T const c = angle.cos;
+		T const s = angle.sin;
+		return basic_transformation<T, 3>(row(T(1), T(0), T(0), T(0)),
+		row(T(0), c, -s, T(0)),
+		row(T(0), s, c, T(0)),
+		row(T(0), T(0), T(0), T(1)));
 	}
 	template <typename T>
-	inline basic_transformation<T, 3> rotation_y(T const& angle) {
-		return {{std::cos(angle), T(0), std::sin(angle), T(0)},
-		{ T(0), T(1), T(0), T(0) },
-		{-std::sin(angle), T(0), std::cos(angle), T(0)},
-		{T(0), T(0), T(0), T(1)}};
+	constexpr basic_transformation<T, 3> rotation_y(math::sine_cosine<T> const& angle) {
+		using row = basic_vector<T, 4>;
+		T const c = angle.cos;
+		T const s = angle.sin;
+		return basic_transformation<T, 3>(row(c, T(0), s, T(0)),
+		row(T(0), T(1), T(0), T(0)),
+		row(-s, T(0), c, T(0)),
+		row(T(0), T(0), T(0), T(1)));
 	}
 	template <typename T>
-	inline basic_transformation<T, 3> rotation_z(T const& angle) {
-		return {{std::cos(angle), -std::sin(angle), T(0), T(0)},
-		{ std::sin(angle), std::cos(angle), T(0), T(0) },
-		{T(0), T(0), T(1), T(0)},
-		{T(0), T(0), T(0), T(1)}};
+	constexpr basic_transformation<T, 3> rotation_z(math::sine_cosine<T> const& angle) {
+		using row = basic_vector<T, 4>;
+		T const c = angle.cos;
+		T const s = angle.sin;
+		return basic_transformation<T, 3>(row(c, -s, T(0), T(0)),
+		row(s, c, T(0), T(0)),
+		row(T(0), T(0), T(1), T(0)),
+		row(T(0), T(0), T(0), T(1)));
 	}
+	// The axis has to be of unit length already.
 	template <typename T>
-	inline basic_transformation<T, 3> rotation(T const& angle, basic_vector<T, 3> const& axis) {
-		T const c = cos(angle);
-		T const s = sin(angle);
-		auto a = axis.normalized();
+	constexpr basic_transformation<T, 3> unit_axis_rotation(math::sine_cosine<T> const& angle, basic_vector<T, 3> const& a) {
+		using row = basic_vector<T, 4>;
+		T const c = angle.cos;
+		T const s = angle.sin;
 		auto t = ((T(1) - c) * a);
+		return basic_transformation<T, 3>(
+			row(c + t.element(0) * a.element(0), t.element(1) * a.element(0) - s * a.element(2), t.element(2) * a.element(0) + s * a.element(1), T(0)),
+			row(t.element(0) * a.element(1) + s * a.element(2), c + t.element(1) * a.element(1), t.element(2) * a.element(1) - s * a.element(0), T(0)),
+			row(t.element(0) * a.element(2) - s * a.element(1), t.element(1) * a.element(2) + s * a.element(0), c + t.element(2) * a.element(2), T(0)),
+			row(T(0), T(0), T(0), T(1)));
+	}
+	template <typename T>
+	constexpr basic_transformation<T, 3> rotation_x(T const& angle) {
+		return rotation_x(math::sincos(angle));
+	}
+	template <typename T>
+	constexpr basic_transformation<T, 3> rotation_y(T const& angle) {
+		return rotation_y(math::sincos(angle));
+	}
+	template <typename T>
+	constexpr basic_transformation<T, 3> rotation_z(T const& angle) {
+		return rotation_z(math::sincos(angle));
+	}
+	template <typename T>
+	constexpr basic_transformation<T, 3> rotation(T const& angle, basic_vector<T, 3> const& axis) {
+		return unit_axis_rotation(math::sincos(angle), basic_vector<T, 3>(axis.normalized()));
+	}
 
-		basic_transformation<T, 3> r;
-		r[0][0] = c + t[0] * a[0];
-		r[1][1] = c + t[1] * a[1];
-		r[2][2] = c + t[2] * a[2];
-		r[3][3] = T(1);
-
-		r[0][1] = t[1] * a[0] - s * a[2];
-		r[0][2] = t[2] * a[0] + s * a[1];
-		r[1][0] = t[0] * a[1] + s * a[2];
-		r[1][2] = t[2] * a[1] - s * a[0];
-		r[2][0] = t[0] * a[2] - s * a[1];
-		r[2][1] = t[1] * a[2] + s * a[0];
-
-		return r;
+	// Rotations for whole arrays of angles. The sines and cosines of a block of angles are
+	// computed first, vectorized in fast trigonometry mode, then the block of matrices is
+	// filled; every result equals the one of the single rotation builder.
+	template <typename T, typename F>
+	void build_rotations(T const* angles, basic_transformation<T, 3>* out, size_t count, F const& build) {
+		static const size_t block = 256;
+		T sines[block], cosines[block];
+		for (size_t first = 0; first < count; first += block) {
+			size_t const size = std::min(block, count - first);
+			math::sincos(angles + first, sines, cosines, size);
+			for (size_t i = 0; i < size; i++)
+				out[first + i] = build(first + i, math::sine_cosine<T>{sines[i], cosines[i]});
+		}
 	}
 	template <typename T>
-	inline basic_transformation<T, 2> rotation(T const& angle) {
+	void rotations_x(T const* angles, basic_transformation<T, 3>* out, size_t count) {
+		build_rotations(angles, out, count, [](size_t, math::sine_cosine<T> const& angle) { return rotation_x(angle); });
+	}
+	template <typename T>
+	void rotations_y(T const* angles, basic_transformation<T, 3>* out, size_t count) {
+		build_rotations(angles, out, count, [](size_t, math::sine_cosine<T> const& angle) { return rotation_y(angle); });
+	}
+	template <typename T>
+	void rotations_z(T const* angles, basic_transformation<T, 3>* out, size_t count) {
+		build_rotations(angles, out, count, [](size_t, math::sine_cosine<T> const& angle) { return rotation_z(angle); });
+	}
+	template <typename T>
+	void rotations(T const* angles, basic_vector<T, 3> const* axes, basic_transformation<T, 3>* out, size_t count) {
+		build_rotations(angles, out, count, [axes](size_t i, math::sine_cosine<T> const& angle) {
+			return unit_axis_rotation(angle, basic_vector<T, 3>(axes[i].normalized()));
+		});
+	}
+	template <typename T>
+	constexpr basic_transformation<T, 2> rotation(T const& angle) {
 		return basic_transformation<T, 2>(rotation_z<T>(angle));
 	}
 
 	template <typename T>
-	inline basic_transformation<T, 3> perspective_projection(T const& l, T const& r, T const& b, T const& t, T const& n, T const& f) {
+	constexpr basic_transformation<T, 3> perspective_projection(T const& l, T const& r, T const& b, T const& t, T const& n, T const& f) {
 		if (l == r || b == t || n == f)
 			throw Exceptions::TransformationError();
 		return basic_transformation<T, 3>{
@@ -120,7 +189,7 @@ namespace mml {
 		};
 	}
 	template <typename T>
-	inline basic_transformation<T, 3> orthographic_projection(T const& l, T const& r, T const& b, T const& t, T const& n, T const& f) {
+	constexpr basic_transformation<T, 3> orthographic_projection(T const& l, T const& r, T const& b, T const& t, T const& n, T const& f) {
 		if (l == r || b == t || n == f)
 			throw Exceptions::TransformationError();
 		return basic_transformation<T, 3>{
@@ -131,6 +200,48 @@ namespace mml {
 		};
 	}
 
+	// Inverse of an affine transformation (last row 0, ..., 0, 1): only the linear block is
+	// inverted, in closed form, and the translation is mapped back through it.
+	template <typename T, size_t R, size_t C>
+	constexpr basic_transformation<T, R - 1> affine_inverse(basic_matrix<T, R, C> const& m) {
+		static_assert(R == C && R > 1, "Only square homogeneous matrices have an affine inverse.");
+		constexpr size_t S = R - 1;
+		auto const linear = basic_matrix<T, S, S>(m).inverse();
+		basic_transformation<T, S> res;
+		for (size_t r = 0; r < S; r++)
+			for (size_t c = 0; c < S; c++) {
+				res.element(r, c) = linear.element(r, c);
+				res.element(r, S) -= linear.element(r, c) * m.element(c, S);
+			}
+		return res;
+	}
+	// Inverse of a rotation followed by a translation: the rotation block is transposed and the
+	// translation is rotated back and negated. Scaling and shear need affine_inverse instead.
+	template <typename T, size_t R, size_t C>
+	constexpr basic_transformation<T, R - 1> rigid_inverse(basic_matrix<T, R, C> const& m) {
+		static_assert(R == C && R > 1, "Only square homogeneous matrices have a rigid inverse.");
+		constexpr size_t S = R - 1;
+		basic_transformation<T, S> res;
+		for (size_t r = 0; r < S; r++)
+			for (size_t c = 0; c < S; c++) {
+				res.element(r, c) = m.element(c, r);
+				res.element(r, S) -= m.element(c, r) * m.element(c, S);
+			}
+		return res;
+	}
+	template<typename M>
+	auto affine_inverse(M const* input, size_t count, M* output) -> typename std::enable_if<is_matrix<M>::value>::type {
+		using base_type = basic_matrix<typename matrix_operand_traits<M>::value_type, matrix_operand_traits<M>::rows_value, matrix_operand_traits<M>::columns_value>;
+		for (size_t i = 0; i < count; i++)
+			static_cast<base_type&>(output[i]) = affine_inverse(input[i]);
+	}
+	template<typename M>
+	auto rigid_inverse(M const* input, size_t count, M* output) -> typename std::enable_if<is_matrix<M>::value>::type {
+		using base_type = basic_matrix<typename matrix_operand_traits<M>::value_type, matrix_operand_traits<M>::rows_value, matrix_operand_traits<M>::columns_value>;
+		for (size_t i = 0; i < count; i++)
+			static_cast<base_type&>(output[i]) = rigid_inverse(input[i]);
+	}
+
 	class transformation2f : public basic_transformation<float, 2u> { public: using basic_transformation::basic_transformation; };
 	class transformation3f : public basic_transformation<float, 3u> { public: using basic_transformation::basic_transformation; };
 	class transformation2d : public basic_transformation<double, 2u> { public: using basic_transformation::basic_transformation; };
@@ -138,44 +249,44 @@ namespace mml {
 
 	class transformation : public transformation3f { public: using transformation3f::transformation3f; };
 
-	inline auto translation(vector const& direction) {
+	constexpr auto translation(vector const& direction) {
 		return translation<vector::value_type, vector::size_value>(direction);
 	}
-	inline auto translation(float x, float y, float z) {
+	constexpr auto translation(float x, float y, float z) {
 		return translation<vector::value_type, vector::size_value>(vector{x,y,z});
 	}
-	inline auto scaling(vector const& direction) {
+	constexpr auto scaling(vector const& direction) {
 		return scaling<vector::value_type, vector::size_value>(direction);
 	}
-	inline auto scaling(float x, float y, float z) {
+	constexpr auto scaling(float x, float y, float z) {
 		return scaling<vector::value_type, vector::size_value>(vector{x,y,z});
 	}
-	inline auto rotation(vector::value_type const& angle, vector const& axis) {
-		return rotation<vector::value_type, vector::value_type>(angle, axis);
+	constexpr auto rotation(vector::value_type const& angle, vector const& axis) {
+		return rotation<vector::value_type>(angle, axis);
 	}
-	inline auto rotation(vector::value_type const& angle, float x, float y, float z) {
-		return rotation<vector::value_type, vector::value_type>(angle, vector{x,y,z});
+	constexpr auto rotation(vector::value_type const& angle, float x, float y, float z) {
+		return rotation<vector::value_type>(angle, vector{x,y,z});
 	}
-	inline auto rotation_x(vector::value_type const& angle) {
+	constexpr auto rotation_x(vector::value_type const& angle) {
 		return rotation_x<vector::value_type>(angle);
 	}
-	inline auto rotation_y(vector::value_type const& angle) {
+	constexpr auto rotation_y(vector::value_type const& angle) {
 		return rotation_y<vector::value_type>(angle);
 	}
-	inline auto rotation_z(vector::value_type const& angle) {
+	constexpr auto rotation_z(vector::value_type const& angle) {
 		return rotation_z<vector::value_type>(angle);
 	}
 
-	inline auto orthographic_projection(basic_vector<vector2f, 3> const& edges) {
+	constexpr auto orthographic_projection(basic_vector<vector2f, 3> const& edges) {
 		return orthographic_projection<float>(edges[0][0], edges[0][1], edges[1][0], edges[1][1], edges[2][0], edges[2][1]);
 	}
-	inline auto orthographic_projection(float left, float right, float bottom, float top, float near, float far) {
+	constexpr auto orthographic_projection(float left, float right, float bottom, float top, float near, float far) {
 		return orthographic_projection<float>(left, right, bottom, top, near, far);
 	}
-	inline auto perspective_projection(basic_vector<vector2f, 3> const& edges) {
+	constexpr auto perspective_projection(basic_vector<vector2f, 3> const& edges) {
 		return perspective_projection<float>(edges[0][0], edges[0][1], edges[1][0], edges[1][1], edges[2][0], edges[2][1]);
 	}
-	inline auto perspective_projection(float left, float right, float bottom, float top, float near, float far) {
-		return orthographic_projection<float>(left, right, bottom, top, near, far);
+	constexpr auto perspective_projection(float left, float right, float bottom, float top, float near, float far) {
+		return perspective_projection<float>(left, right, bottom, top, near, far);
 	}
 }
\ No newline at end of file
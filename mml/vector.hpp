@@ -1,184 +1,292 @@
 #pragma once
 #include <initializer_list>
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 
+#include "mml/math.hpp"
+#include "mml/simd.hpp"
 #include "mml/exceptions.hpp"
 DefineNewMMLException(VectorIndexOutOfBounds);
+#include "mml/expression.hpp"
 
 namespace mml {
+	// Vectors of vectors are the storage of matrices and are counted as matrices, never as
+	// the vectors of their rows.
 	template<typename T, size_t S>
-	class basic_vector {
+	class basic_vector : public instrumentation::counted<is_vector<T>::value ? instrumentation::matrix_constructions : instrumentation::vector_constructions,
+		basic_vector<T, S>, is_vector<T>::value && !is_matrix<T>::value ? S : 0> {
 	protected:
 		T data[S];
 	public:
 		using value_type = T;
 		static const size_t size_value = S;
 
-		basic_vector() : data{T(0)} {}
-		basic_vector(basic_vector<T, S> const& other) {
-			std::copy(other.begin(), other.end(), data);
-		}
-		basic_vector(basic_vector<T, S>&& other) {
-			std::move(other.begin(), other.end(), data);
-		}
+		constexpr basic_vector() : data{T(0)} {}
+		constexpr basic_vector(basic_vector<T, S> const& other) = default;
+		constexpr basic_vector(basic_vector<T, S>&& other) = default;
 		template <typename... Tail>
-		basic_vector(typename std::enable_if<sizeof...(Tail) + 1 <= S, T>::type head = T(0),
+		constexpr basic_vector(typename std::enable_if<sizeof...(Tail) + 1 <= S, T>::type head = T(0),
 					 Tail... tail) : data{head, T(tail)...} {}
 		template<typename T_O, size_t S_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-		basic_vector(basic_vector<T_O, S_O> const& other, typename std::enable_if<(S_O <= S), void*>::type less = nullptr) : basic_vector() {
-			std::copy(other.begin(), other.end(), data);
+		constexpr basic_vector(basic_vector<T_O, S_O> const& other, typename std::enable_if<(S_O <= S), void*>::type less = nullptr) : basic_vector() {
+			for (size_t i = 0; i < S_O; i++)
+				data[i] = T(other.element(i));
 		}
 		template<typename T_O, size_t S_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-		basic_vector(basic_vector<T_O, S_O> &&other, typename std::enable_if<(S_O <= S), void*>::type less = nullptr) : basic_vector() {
-			std::move(other.begin(), other.end(), data);
+		constexpr basic_vector(basic_vector<T_O, S_O> &&other, typename std::enable_if<(S_O <= S), void*>::type less = nullptr) : basic_vector() {
+			for (size_t i = 0; i < S_O; i++)
+				data[i] = T(std::move(other.element(i)));
 		}
 		template<typename T_O, size_t S_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-		explicit basic_vector(basic_vector<T_O, S_O> const& other, typename std::enable_if<(S_O > S), void*>::type more = nullptr) {
-			std::copy(other.begin(), other.begin() + S, data);
+		explicit constexpr basic_vector(basic_vector<T_O, S_O> const& other, typename std::enable_if<(S_O > S), void*>::type more = nullptr) : data{} {
+			for (size_t i = 0; i < S; i++)
+				data[i] = T(other.element(i));
 		}
 		template<typename T_O, size_t S_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-		explicit basic_vector(basic_vector<T_O, S_O> &&other, typename std::enable_if<(S_O > S), void*>::type more = nullptr) {
-			std::move(other.begin(), other.begin() + S, data);
+		explicit constexpr basic_vector(basic_vector<T_O, S_O> &&other, typename std::enable_if<(S_O > S), void*>::type more = nullptr) : data{} {
+			for (size_t i = 0; i < S; i++)
+				data[i] = T(std::move(other.element(i)));
 		}
-		basic_vector(std::initializer_list<T> const& inputs) : basic_vector() {
+		constexpr basic_vector(std::initializer_list<T> const& inputs) : basic_vector() {
 			if (inputs.size() > S)
 				throw Exceptions::VectorIndexOutOfBounds("Too many inputs.");
-			std::copy(inputs.begin(), inputs.end(), data);
-			std::fill(data + inputs.size(), data + S, T(0));
+			size_t i = 0;
+			for (auto const& input : inputs)
+				data[i++] = input;
 		}
-		basic_vector(std::initializer_list<T>&& inputs) : basic_vector() {
+		constexpr basic_vector(std::initializer_list<T>&& inputs) : basic_vector() {
 			if (inputs.size() > S)
 				throw Exceptions::VectorIndexOutOfBounds("Too many inputs.");
-			std::move(inputs.begin(), inputs.end(), data);
-			std::fill(data + inputs.size(), data + S, T(0));
-		}
-		basic_vector<T, S> const& operator=(basic_vector<T, S> const& other) {
-			std::copy(other.begin(), other.end(), data);
-			return *this;
+			size_t i = 0;
+			for (auto const& input : inputs)
+				data[i++] = input;
+		}
+		template<typename E, typename = typename std::enable_if<is_vector_expression<E>::value && std::is_convertible<typename E::value_type, T>::value>::type>
+		constexpr basic_vector(E const& other, typename std::enable_if<(E::size_value <= S), void*>::type less = nullptr) : basic_vector() {
+			MMLCount(flops, E::operations * E::size_value);
+			for (size_t i = 0; i < E::size_value; i++)
+				data[i] = T(other.element(i));
+		}
+		template<typename E, typename = typename std::enable_if<is_vector_expression<E>::value && std::is_convertible<typename E::value_type, T>::value>::type>
+		explicit constexpr basic_vector(E const& other, typename std::enable_if<(E::size_value > S), void*>::type more = nullptr) : data{} {
+			MMLCount(flops, E::operations * S);
+			for (size_t i = 0; i < S; i++)
+				data[i] = T(other.element(i));
 		}
-		basic_vector<T, S> const& operator=(basic_vector<T, S>&& other) {
-			std::move(other.begin(), other.end(), data);
+		constexpr basic_vector<T, S>& operator=(basic_vector<T, S> const& other) = default;
+		constexpr basic_vector<T, S>& operator=(basic_vector<T, S>&& other) = default;
+		template<typename E>
+		constexpr auto operator=(E const& other) -> typename std::enable_if<is_vector_expression<E>::value && (E::size_value <= S), basic_vector<T, S>&>::type {
+			MMLCount(flops, E::operations * E::size_value);
+			for (size_t i = 0; i < S; i++)
+				data[i] = i < E::size_value ? T(other.element(i)) : T(0);
 			return *this;
 		}
 
-		T const& operator[](size_t index) const {
-			if (index >= S)
-				throw Exceptions::VectorIndexOutOfBounds();
+		constexpr T const& operator[](size_t index) const noexcept(MML_BOUNDS_NOEXCEPT) {
+			CheckMMLBounds(index < S, VectorIndexOutOfBounds);
 			return data[index];
 		}
-		T& operator[](size_t index) {
-			if (index >= S)
-				throw Exceptions::VectorIndexOutOfBounds();
+		constexpr T& operator[](size_t index) noexcept(MML_BOUNDS_NOEXCEPT) {
+			CheckMMLBounds(index < S, VectorIndexOutOfBounds);
 			return data[index];
 		}
-		T const& at(size_t index) const {
+		constexpr T const& at(size_t index) const noexcept(MML_BOUNDS_NOEXCEPT) {
 			return operator[](index);
 		}
-		T& at(size_t index) {
+		constexpr T& at(size_t index) noexcept(MML_BOUNDS_NOEXCEPT) {
 			return operator[](index);
 		}
+		constexpr T const& element(size_t index) const noexcept {
+			return data[index];
+		}
+		constexpr T& element(size_t index) noexcept {
+			return data[index];
+		}
 
-		size_t size() const {
+		constexpr size_t size() const {
 			return S;
 		}
-		T const* begin() const {
+		constexpr T const* begin() const {
 			return data;
 		}
-		T* begin() {
+		constexpr T* begin() {
 			return data;
 		}
-		T const* end() const {
+		constexpr T const* end() const {
 			return data + S;
 		}
-		T* end() {
+		constexpr T* end() {
 			return data + S;
 		}
-		bool empty() const {
+		constexpr bool empty() const {
 			for (size_t i = 0; i < S; i++)
 				if (data[i] != T(0))
 					return false;
 			return true;
 		}
-		void clear() {
+		constexpr void clear() {
 			for (size_t i = 0; i < S; i++)
 				data[i] = T(0);
 		}
 
-		template<typename = typename std::enable_if<S >= 0 && S <= 4>::type> T const& x() const { return data[0]; }
-		template<typename = typename std::enable_if<S >= 1 && S <= 4>::type> T const& y() const { return data[1]; }
-		template<typename = typename std::enable_if<S >= 2 && S <= 4>::type> T const& z() const { return data[2]; }
-		template<typename = typename std::enable_if<S >= 3 && S <= 4>::type> T const& w() const { return data[3]; }
-		template<typename = typename std::enable_if<S >= 0 && S <= 4>::type> void x(T const& value) { data[0] = value; }
-		template<typename = typename std::enable_if<S >= 1 && S <= 4>::type> void y(T const& value) { data[0] = value; }
-		template<typename = typename std::enable_if<S >= 2 && S <= 4>::type> void z(T const& value) { data[0] = value; }
-		template<typename = typename std::enable_if<S >= 3 && S <= 4>::type> void w(T const& value) { data[0] = value; }
+		template<size_t S_ = S, typename = typename std::enable_if<S_ >= 0 && S_ <= 4>::type> constexpr T const& x() const { return data[0]; }
+		template<size_t S_ = S, typename = typename std::enable_if<S_ >= 1 && S_ <= 4>::type> constexpr T const& y() const { return data[1]; }
+		template<size_t S_ = S, typename = typename std::enable_if<S_ >= 2 && S_ <= 4>::type> constexpr T const& z() const { return data[2]; }
+		template<size_t S_ = S, typename = typename std::enable_if<S_ >= 3 && S_ <= 4>::type> constexpr T const& w() const { return data[3]; }
+		template<size_t S_ = S, typename = typename std::enable_if<S_ >= 0 && S_ <= 4>::type> constexpr void x(T const& value) { data[0] = value; }
+		template<size_t S_ = S, typename = typename std::enable_if<S_ >= 1 && S_ <= 4>::type> constexpr void y(T const& value) { data[1] = value; }
+		template<size_t S_ = S, typename = typename std::enable_if<S_ >= 2 && S_ <= 4>::type> constexpr void z(T const& value) { data[2] = value; }
+		template<size_t S_ = S, typename = typename std::enable_if<S_ >= 3 && S_ <= 4>::type> constexpr void w(T const& value) { data[3] = value; }
 		
-		T length() const {
+		constexpr T length() const {
+			MMLCount(flops, 2 * S);
+			if constexpr (simd::is_accelerated<T, S>::value)
+				if (!MMLIsConstantEvaluated())
+					return T(std::sqrt(simd::kernel<T, S>::dot(data, data)));
 			T sum = T(0);
 			for (size_t i = 0; i < S; i++)
 				sum += data[i] * data[i];
-			return std::sqrt(sum);
+			return T(math::sqrt(sum));
 		}
-		template<typename = typename std::enable_if<std::is_floating_point<T>::value>::type>
-		void normalize() {
+		template<typename T_ = T, typename = typename std::enable_if<std::is_floating_point<T_>::value>::type>
+		constexpr void normalize() {
 			auto l = length();
+			MMLCount(flops, S);
+			if constexpr (simd::is_accelerated<T, S>::value)
+				if (!MMLIsConstantEvaluated()) {
+					simd::kernel<T, S>::div(data, l);
+					return;
+				}
 			for (size_t i = 0; i < S; i++)
 				data[i] /= l;
 		}
 
 		template<typename..., typename T_O = T>
-		typename std::enable_if<std::is_floating_point<T_O>::value, basic_vector<T_O, S>>::type const normalized() const {
+		constexpr typename std::enable_if<std::is_floating_point<T_O>::value, basic_vector<T_O, S>>::type const normalized() const {
 			basic_vector<T_O, S> ret(*this);
 			ret.normalize();
 			return ret;
 		}
 		template<typename..., typename T_O = T>
-		typename std::enable_if<!std::is_floating_point<T_O>::value, basic_vector<float, S>>::type const normalized() const {
+		constexpr typename std::enable_if<!std::is_floating_point<T_O>::value, basic_vector<float, S>>::type const normalized() const {
 			basic_vector<float, S> ret(*this);
 			ret.normalize();
 			return ret;
 		}
 
 		template<typename T_O, size_t S_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type, typename = typename std::enable_if<(S_O <= S)>::type>
-		basic_vector<T, S>& operator+=(basic_vector<T_O, S_O> const& other) {
+		constexpr basic_vector<T, S>& operator+=(basic_vector<T_O, S_O> const& other) {
+			MMLCount(flops, S_O);
+			if constexpr (simd::is_accelerated<T, S>::value && std::is_same<T, T_O>::value && S == S_O)
+				if (!MMLIsConstantEvaluated()) {
+					simd::kernel<T, S>::add(data, other.begin());
+					return *this;
+				}
 			for (size_t i = 0; i < std::min(S, S_O); i++)
-				data[i] += T(other[i]);
+				data[i] += T(other.element(i));
 			return *this;
 		}
 		template<typename T_O, size_t S_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type, typename = typename std::enable_if<(S_O <= S)>::type>
-		basic_vector<T, S>& operator-=(basic_vector<T_O, S_O> const& other) {
+		constexpr basic_vector<T, S>& operator-=(basic_vector<T_O, S_O> const& other) {
+			MMLCount(flops, S_O);
+			if constexpr (simd::is_accelerated<T, S>::value && std::is_same<T, T_O>::value && S == S_O)
+				if (!MMLIsConstantEvaluated()) {
+					simd::kernel<T, S>::sub(data, other.begin());
+					return *this;
+				}
 			for (size_t i = 0; i < std::min(S, S_O); i++)
-				data[i] -= T(other[i]);
+				data[i] -= T(other.element(i));
 			return *this;
 		}
 		template<typename T_O, size_t S_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type, typename = typename std::enable_if<(S_O <= S)>::type>
-		basic_vector<T, S>& operator*=(basic_vector<T_O, S_O> const& other) {
+		constexpr basic_vector<T, S>& operator*=(basic_vector<T_O, S_O> const& other) {
+			MMLCount(flops, S_O);
+			if constexpr (simd::is_accelerated<T, S>::value && std::is_same<T, T_O>::value && S == S_O)
+				if (!MMLIsConstantEvaluated()) {
+					simd::kernel<T, S>::mul(data, other.begin());
+					return *this;
+				}
 			for (size_t i = 0; i < std::min(S, S_O); i++)
-				data[i] *= T(other[i]);
+				data[i] *= T(other.element(i));
 			return *this;
 		}
 		template<typename T_O, size_t S_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type, typename = typename std::enable_if<(S_O <= S)>::type>
-		basic_vector<T, S>& operator/=(basic_vector<T_O, S_O> const& other) {
+		constexpr basic_vector<T, S>& operator/=(basic_vector<T_O, S_O> const& other) {
+			MMLCount(flops, S_O);
+			if constexpr (simd::is_accelerated<T, S>::value && std::is_same<T, T_O>::value && S == S_O)
+				if (!MMLIsConstantEvaluated()) {
+					simd::kernel<T, S>::div(data, other.begin());
+					return *this;
+				}
 			for (size_t i = 0; i < std::min(S, S_O); i++)
-				data[i] /= T(other[i]);
+				data[i] /= T(other.element(i));
+			return *this;
+		}
+
+		template<typename E>
+		constexpr auto operator+=(E const& other) -> typename std::enable_if<is_vector_expression<E>::value && (E::size_value <= S), basic_vector<T, S>&>::type {
+			MMLCount(flops, (E::operations + 1) * E::size_value);
+			for (size_t i = 0; i < E::size_value; i++)
+				data[i] += T(other.element(i));
+			return *this;
+		}
+		template<typename E>
+		constexpr auto operator-=(E const& other) -> typename std::enable_if<is_vector_expression<E>::value && (E::size_value <= S), basic_vector<T, S>&>::type {
+			MMLCount(flops, (E::operations + 1) * E::size_value);
+			for (size_t i = 0; i < E::size_value; i++)
+				data[i] -= T(other.element(i));
+			return *this;
+		}
+		template<typename E>
+		constexpr auto operator*=(E const& other) -> typename std::enable_if<is_vector_expression<E>::value && (E::size_value <= S), basic_vector<T, S>&>::type {
+			MMLCount(flops, (E::operations + 1) * E::size_value);
+			for (size_t i = 0; i < E::size_value; i++)
+				data[i] *= T(other.element(i));
+			return *this;
+		}
+		template<typename E>
+		constexpr auto operator/=(E const& other) -> typename std::enable_if<is_vector_expression<E>::value && (E::size_value <= S), basic_vector<T, S>&>::type {
+			MMLCount(flops, (E::operations + 1) * E::size_value);
+			for (size_t i = 0; i < E::size_value; i++)
+				data[i] /= T(other.element(i));
 			return *this;
 		}
 
 		template<typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-		basic_vector<T, S>& operator*=(T_O const& q) {
+		constexpr basic_vector<T, S>& operator*=(T_O const& q) {
+			MMLCount(flops, S);
+			if constexpr (simd::is_accelerated<T, S>::value)
+				if (!MMLIsConstantEvaluated()) {
+					simd::kernel<T, S>::mul(data, T(q));
+					return *this;
+				}
 			for (size_t i = 0; i < S; i++)
 				data[i] *= T(q);
 			return *this;
 		}
 		template<typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-		basic_vector<T, S>& operator/=(T_O const& q) {
+		constexpr basic_vector<T, S>& operator/=(T_O const& q) {
+			MMLCount(flops, S);
+			if constexpr (simd::is_accelerated<T, S>::value)
+				if (!MMLIsConstantEvaluated()) {
+					simd::kernel<T, S>::div(data, T(q));
+					return *this;
+				}
 			for (size_t i = 0; i < S; i++)
 				data[i] /= T(q);
 			return *this;
 		}
 
-		basic_vector<T, S> const operator-() const {
+		constexpr basic_vector<T, S> const operator-() const {
 			basic_vector<T, S> res;
+			MMLCount(flops, S);
+			if constexpr (simd::is_accelerated<T, S>::value)
+				if (!MMLIsConstantEvaluated()) {
+					simd::kernel<T, S>::negate(res.data, data);
+					return res;
+				}
 			for (size_t i = 0; i < S; i++)
 				res.data[i] = -data[i];
 			return res;
@@ -191,157 +299,203 @@ namespace mml {
 		using basic_vector<T, S + 1>::data;
 	public:
 		template<typename... Tail>
-		basic_homogeneous_vector(typename std::enable_if<sizeof...(Tail) + 1 <= S, T>::type head = T(0),
+		constexpr basic_homogeneous_vector(typename std::enable_if<sizeof...(Tail) + 1 <= S, T>::type head = T(0),
 										 Tail... tail) : basic_vector<T, S + 1>(head, tail...) { data[S] = T(1); }
 		template<typename... Tail>
-		basic_homogeneous_vector(typename std::enable_if<sizeof...(Tail) == S, T>::type head = T(0),
+		constexpr basic_homogeneous_vector(typename std::enable_if<sizeof...(Tail) == S, T>::type head = T(0),
 										 Tail... tail) : basic_vector<T, S + 1>(head, tail...) {}
 		template<typename T_O, size_t S_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-		basic_homogeneous_vector(basic_vector<T_O, S_O> const& other, typename std::enable_if<(S_O <= S + 1), void*>::type less = nullptr)
+		constexpr basic_homogeneous_vector(basic_vector<T_O, S_O> const& other, typename std::enable_if<(S_O <= S + 1), void*>::type less = nullptr)
 			: basic_vector<T, S + 1>(other) { data[S] = T(1); }
 		template<typename T_O, size_t S_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-		basic_homogeneous_vector(basic_vector<T_O, S_O> &&other, typename std::enable_if<(S_O <= S + 1), void*>::type less = nullptr)
+		constexpr basic_homogeneous_vector(basic_vector<T_O, S_O> &&other, typename std::enable_if<(S_O <= S + 1), void*>::type less = nullptr)
 			: basic_vector<T, S + 1>(other) { data[S] = T(1); }
 		template<typename T_O, size_t S_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-		explicit basic_homogeneous_vector(basic_vector<T_O, S_O> const& other, typename std::enable_if<(S_O > S + 1), void*>::type more = nullptr)
+		explicit constexpr basic_homogeneous_vector(basic_vector<T_O, S_O> const& other, typename std::enable_if<(S_O > S + 1), void*>::type more = nullptr)
 			: basic_vector<T, S + 1>(other) {}
 		template<typename T_O, size_t S_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-		explicit basic_homogeneous_vector(basic_vector<T_O, S_O> &&other, typename std::enable_if<(S_O > S + 1), void*>::type more = nullptr)
+		explicit constexpr basic_homogeneous_vector(basic_vector<T_O, S_O> &&other, typename std::enable_if<(S_O > S + 1), void*>::type more = nullptr)
 			: basic_vector<T, S + 1>(other) {}
-		basic_homogeneous_vector(T* inputs) : basic_vector<T, S + 1>(inputs) { data[S] = T(1); }
-		basic_homogeneous_vector(std::initializer_list<T> const& inputs) : basic_vector<T, S + 1>(inputs) {
+		constexpr basic_homogeneous_vector(T* inputs) : basic_vector<T, S + 1>(inputs) { data[S] = T(1); }
+		constexpr basic_homogeneous_vector(std::initializer_list<T> const& inputs) : basic_vector<T, S + 1>(inputs) {
 			data[S] = T(1);
 		}
-		basic_homogeneous_vector(std::initializer_list<T>&& inputs) : basic_vector<T, S + 1>(inputs) {
+		constexpr basic_homogeneous_vector(std::initializer_list<T>&& inputs) : basic_vector<T, S + 1>(inputs) {
 			data[S] = T(1);
 		}
 	};
 
 	template<typename T, size_t S, typename T_O, size_t S_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type, typename = typename std::enable_if<(S_O == S)>::type>
-	bool operator==(basic_vector<T, S> const& v1, basic_vector<T_O, S_O> const& v2) {
+	constexpr bool operator==(basic_vector<T, S> const& v1, basic_vector<T_O, S_O> const& v2) {
 		for (size_t i = 0; i < S; i++)
-			if (v1[i] != v2[i])
+			if (v1.element(i) != v2.element(i))
 				return false;
 		return true;
 	}
 	template<typename T, size_t S, typename T_O, size_t S_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type, typename = typename std::enable_if<(S_O == S)>::type>
-	bool operator!=(basic_vector<T, S> const& v1, basic_vector<T_O, S_O> const& v2) {
+	constexpr bool operator!=(basic_vector<T, S> const& v1, basic_vector<T_O, S_O> const& v2) {
 		return !(v1 == v2);
 	}
 
-	template<typename T, size_t S, typename T_O, size_t S_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-	auto operator+(basic_vector<T, S> const& v1, basic_vector<T_O, S_O> const& v2) {
-		basic_vector<decltype(v1[0] + v2[0]), std::max(S, S_O)> res{v1};
-		return res += v2;
+	template<typename L, typename R>
+	struct vector_operands : std::integral_constant<bool, is_vector_operand<typename std::decay<L>::type>::value && is_vector_operand<typename std::decay<R>::type>::value
+		&& std::is_convertible<typename vector_operand_traits<typename std::decay<R>::type>::value_type, typename vector_operand_traits<typename std::decay<L>::type>::value_type>::value> {};
+	template<typename V, typename Q>
+	struct vector_scalar_operands : std::integral_constant<bool, is_vector_operand<typename std::decay<V>::type>::value && is_scalar_operand<typename std::decay<Q>::type>::value
+		&& std::is_convertible<typename std::decay<Q>::type, typename vector_operand_traits<typename std::decay<V>::type>::value_type>::value> {};
+	template<typename L, typename R>
+	struct vector_expression_operands : std::integral_constant<bool, vector_operands<L, R>::value
+		&& (is_vector_expression<typename std::decay<L>::type>::value || is_vector_expression<typename std::decay<R>::type>::value)> {};
+
+	template<typename L, typename R>
+	constexpr auto operator+(L&& v1, R&& v2) -> typename expression_result<vector_operands<L, R>::value, vector_expression<expression_add, L, R>, L, R>::type {
+		return vector_expression<expression_add, L, R>(std::forward<L>(v1), std::forward<R>(v2));
 	}
-	template<typename T, size_t S, typename T_O, size_t S_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-	auto operator-(basic_vector<T, S> const& v1, basic_vector<T_O, S_O> const& v2) {
-		basic_vector<decltype(v1[0] - v2[0]), std::max(S, S_O)> res{v1};
-		return res -= v2;
+	template<typename L, typename R>
+	constexpr auto operator-(L&& v1, R&& v2) -> typename expression_result<vector_operands<L, R>::value, vector_expression<expression_subtract, L, R>, L, R>::type {
+		return vector_expression<expression_subtract, L, R>(std::forward<L>(v1), std::forward<R>(v2));
 	}
-	template<typename T, size_t S, typename T_O, size_t S_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-	auto operator*(basic_vector<T, S> const& v1, basic_vector<T_O, S_O> const& v2) {
-		basic_vector<decltype(v1[0] * v2[0]), std::max(S, S_O)> res{v1};
-		return res *= v2;
+	template<typename L, typename R>
+	constexpr auto operator*(L&& v1, R&& v2) -> typename expression_result<vector_operands<L, R>::value, vector_expression<expression_multiply, L, R>, L, R>::type {
+		return vector_expression<expression_multiply, L, R>(std::forward<L>(v1), std::forward<R>(v2));
 	}
-	template<typename T, size_t S, typename T_O, size_t S_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-	auto operator/(basic_vector<T, S> const& v1, basic_vector<T_O, S_O> const& v2) {
-		basic_vector<decltype(v1[0] / v2[0]), std::max(S, S_O)> res{v1};
-		return res /= v2;
+	template<typename L, typename R>
+	constexpr auto operator/(L&& v1, R&& v2) -> typename expression_result<vector_operands<L, R>::value, vector_expression<expression_divide, L, R>, L, R>::type {
+		return vector_expression<expression_divide, L, R>(std::forward<L>(v1), std::forward<R>(v2));
 	}
 
-	template<typename T, size_t S, typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-	auto const operator*(basic_vector<T, S> const& v, T_O const& q) {
-		basic_vector<decltype(v[0] * q), S> res{v};
-		return res *= q;
+	template<typename V, typename Q>
+	constexpr auto operator*(V&& v, Q&& q) -> typename expression_result<vector_scalar_operands<V, Q>::value, vector_expression<expression_multiply, V, Q>, V, Q>::type {
+		return vector_expression<expression_multiply, V, Q>(std::forward<V>(v), std::forward<Q>(q));
 	}
-	template<typename T, size_t S, typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-	auto const operator*(T_O const& q, basic_vector<T, S> const& v) {
-		basic_vector<decltype(v[0] * q), S> res{v};
-		return res *= q;
+	template<typename Q, typename V>
+	constexpr auto operator*(Q&& q, V&& v) -> typename expression_result<vector_scalar_operands<V, Q>::value, vector_expression<expression_multiply, V, Q>, V, Q>::type {
+		return vector_expression<expression_multiply, V, Q>(std::forward<V>(v), std::forward<Q>(q));
 	}
-	template<typename T, size_t S, typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-	auto const operator/(basic_vector<T, S> const& v, T_O const& q) {
-		basic_vector<decltype(v[0] / q), S> res{v};
-		return res /= q;
+	template<typename V, typename Q>
+	constexpr auto operator/(V&& v, Q&& q) -> typename expression_result<vector_scalar_operands<V, Q>::value, vector_expression<expression_divide, V, Q>, V, Q>::type {
+		return vector_expression<expression_divide, V, Q>(std::forward<V>(v), std::forward<Q>(q));
 	}
-	template<typename T, size_t S, typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-	auto const operator/(T_O const& q, basic_vector<T, S> const& v) {
-		basic_vector<decltype(q / v[0]), S> res{v};
-		for (auto &it : res)
-			it = q / it;
-		return res;
+	template<typename Q, typename V>
+	constexpr auto operator/(Q&& q, V&& v) -> typename expression_result<vector_scalar_operands<V, Q>::value, vector_expression<expression_divide_reversed, V, Q>, V, Q>::type {
+		return vector_expression<expression_divide_reversed, V, Q>(std::forward<V>(v), std::forward<Q>(q));
+	}
+	template<typename E>
+	constexpr auto operator-(E&& e) -> typename std::enable_if<is_vector_expression<typename std::decay<E>::type>::value, vector_expression<expression_negate, E, expression_none>>::type {
+		return {std::forward<E>(e), expression_none{}};
+	}
+
+	template<typename V, typename = typename std::enable_if<is_vector_operand<typename std::decay<V>::type>::value && !is_vector_expression<typename std::decay<V>::type>::value>::type>
+	constexpr vector_expression<expression_identity, V, expression_none> lazy(V&& v) {
+		return {std::forward<V>(v), expression_none{}};
 	}
 
 	template<typename T, size_t S, typename T_O, size_t S_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-	T const operator%(basic_vector<T, S> const& v1, basic_vector<T_O, S_O> const& v2) {
+	constexpr T const operator%(basic_vector<T, S> const& v1, basic_vector<T_O, S_O> const& v2) {
+		MMLCount(flops, 2 * std::min(S, S_O));
+		if constexpr (simd::is_accelerated<T, S>::value && std::is_same<T, T_O>::value && S == S_O)
+			if (!MMLIsConstantEvaluated())
+				return simd::kernel<T, S>::dot(v1.begin(), v2.begin());
 		T res = T(0);
 		for (int i = 0; i < std::min(S, S_O); i++)
-			res += v1[i] * v2[i];
+			res += v1.element(i) * v2.element(i);
 		return res;
 	}
 	template<typename T, size_t S, typename T_O, size_t S_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-	T const dot(basic_vector<T, S> const& v1, basic_vector<T_O, S_O> const& v2) {
+	constexpr T const dot(basic_vector<T, S> const& v1, basic_vector<T_O, S_O> const& v2) {
 		return v1 % v2;
 	}
 
 	template<typename T, typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-	basic_vector<T, 3> const operator^(basic_vector<T, 3> const& v1, basic_vector<T_O, 3> const& v2) {
-		return basic_vector<decltype(v1[0] * v2[0]), 3>(v1[1] * v2[2] - v2[1] * v1[2],
-																v1[2] * v2[0] - v2[2] * v1[0],
-																v1[0] * v2[1] - v2[0] * v1[1]);
+	constexpr basic_vector<T, 3> const operator^(basic_vector<T, 3> const& v1, basic_vector<T_O, 3> const& v2) {
+		MMLCount(flops, 9);
+		if constexpr (std::is_same<T, float>::value && std::is_same<T, T_O>::value && simd::is_accelerated<T, 3>::value)
+			if (!MMLIsConstantEvaluated()) {
+				basic_vector<T, 3> res;
+				simd::kernel<T, 3>::cross(res.begin(), v1.begin(), v2.begin());
+				return res;
+			}
+		return basic_vector<decltype(v1[0] * v2[0]), 3>(v1.element(1) * v2.element(2) - v2.element(1) * v1.element(2),
+																v1.element(2) * v2.element(0) - v2.element(2) * v1.element(0),
+																v1.element(0) * v2.element(1) - v2.element(0) * v1.element(1));
 	}
 	template<typename T, typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-	basic_vector<T, 3> const cross(basic_vector<T, 3> const& v1, basic_vector<T_O, 3> const& v2) {
+	constexpr basic_vector<T, 3> const cross(basic_vector<T, 3> const& v1, basic_vector<T_O, 3> const& v2) {
 		return v1 ^ v2;
 	}
 
 	template<typename T, typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-	basic_vector<T, 3> const operator^(basic_homogeneous_vector<T, 3> const& v1, basic_vector<T_O, 3> const& v2) {
+	constexpr basic_vector<T, 3> const operator^(basic_homogeneous_vector<T, 3> const& v1, basic_vector<T_O, 3> const& v2) {
 		return basic_vector<T, 3>(v1) ^ v2;
 	}
 	template<typename T, typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-	basic_vector<T, 3> const operator^(basic_vector<T, 3> const& v1, basic_homogeneous_vector<T_O, 3> const& v2) {
+	constexpr basic_vector<T, 3> const operator^(basic_vector<T, 3> const& v1, basic_homogeneous_vector<T_O, 3> const& v2) {
 		return v1 ^ basic_vector<T, 3>(v2);
 	}
 	template<typename T, typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-	basic_vector<T, 3> const operator^(basic_homogeneous_vector<T, 3> const& v1, basic_homogeneous_vector<T_O, 3> const& v2) {
+	constexpr basic_vector<T, 3> const operator^(basic_homogeneous_vector<T, 3> const& v1, basic_homogeneous_vector<T_O, 3> const& v2) {
 		return basic_vector<T, 3>(v1) ^ basic_vector<T, 3>(v2);
 	}
 
 	template<typename T, typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-	basic_vector<T, 3> const cross(basic_homogeneous_vector<T, 3> const& v1, basic_vector<T_O, 3> const& v2) {
+	constexpr basic_vector<T, 3> const cross(basic_homogeneous_vector<T, 3> const& v1, basic_vector<T_O, 3> const& v2) {
 		return basic_vector<T, 3>(v1) ^ v2;
 	}
 	template<typename T, typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-	basic_vector<T, 3> const cross(basic_vector<T, 3> const& v1, basic_homogeneous_vector<T_O, 3> const& v2) {
+	constexpr basic_vector<T, 3> const cross(basic_vector<T, 3> const& v1, basic_homogeneous_vector<T_O, 3> const& v2) {
 		return v1 ^ basic_vector<T, 3>(v2);
 	}
 	template<typename T, typename T_O, typename = typename std::enable_if<std::is_convertible<T_O, T>::value>::type>
-	basic_vector<T, 3> const cross(basic_homogeneous_vector<T, 3> const& v1, basic_homogeneous_vector<T_O, 3> const& v2) {
+	constexpr basic_vector<T, 3> const cross(basic_homogeneous_vector<T, 3> const& v1, basic_homogeneous_vector<T_O, 3> const& v2) {
 		return basic_vector<T, 3>(v1) ^ basic_vector<T, 3>(v2);
 	}
 
-	class vector2f : public basic_vector<float, 2u> { public: using basic_vector::basic_vector; };
-	class vector3f : public basic_vector<float, 3u> { public: using basic_vector::basic_vector; };
-	class vector4f : public basic_vector<float, 4u> { public: using basic_vector::basic_vector; };
+	template<typename L, typename R>
+	constexpr auto operator==(L const& v1, R const& v2) -> typename std::enable_if<vector_expression_operands<L, R>::value, bool>::type {
+		return evaluate(v1) == evaluate(v2);
+	}
+	template<typename L, typename R>
+	constexpr auto operator!=(L const& v1, R const& v2) -> typename std::enable_if<vector_expression_operands<L, R>::value, bool>::type {
+		return evaluate(v1) != evaluate(v2);
+	}
+	template<typename L, typename R>
+	constexpr auto operator%(L const& v1, R const& v2) -> typename std::enable_if<vector_expression_operands<L, R>::value, typename vector_operand_traits<L>::value_type>::type {
+		return evaluate(v1) % evaluate(v2);
+	}
+	template<typename L, typename R>
+	constexpr auto dot(L const& v1, R const& v2) -> typename std::enable_if<vector_expression_operands<L, R>::value, typename vector_operand_traits<L>::value_type>::type {
+		return evaluate(v1) % evaluate(v2);
+	}
+	template<typename L, typename R>
+	constexpr auto operator^(L const& v1, R const& v2) -> typename std::enable_if<vector_expression_operands<L, R>::value, basic_vector<typename vector_operand_traits<L>::value_type, 3>>::type {
+		return evaluate(v1) ^ evaluate(v2);
+	}
+	template<typename L, typename R>
+	constexpr auto cross(L const& v1, R const& v2) -> typename std::enable_if<vector_expression_operands<L, R>::value, basic_vector<typename vector_operand_traits<L>::value_type, 3>>::type {
+		return evaluate(v1) ^ evaluate(v2);
+	}
+
+	// The named types are initialized from the results of the operators, which are basic_vectors.
+	class vector2f : public basic_vector<float, 2u> { public: using basic_vector::basic_vector; constexpr vector2f(basic_vector const& other) : basic_vector(other) {} };
+	class vector3f : public basic_vector<float, 3u> { public: using basic_vector::basic_vector; constexpr vector3f(basic_vector const& other) : basic_vector(other) {} };
+	class vector4f : public basic_vector<float, 4u> { public: using basic_vector::basic_vector; constexpr vector4f(basic_vector const& other) : basic_vector(other) {} };
 
-	class vector2d : public basic_vector<double, 2u> { public: using basic_vector::basic_vector; };
-	class vector3d : public basic_vector<double, 3u> { public: using basic_vector::basic_vector; };
-	class vector4d : public basic_vector<double, 4u> { public: using basic_vector::basic_vector; };
+	class vector2d : public basic_vector<double, 2u> { public: using basic_vector::basic_vector; constexpr vector2d(basic_vector const& other) : basic_vector(other) {} };
+	class vector3d : public basic_vector<double, 3u> { public: using basic_vector::basic_vector; constexpr vector3d(basic_vector const& other) : basic_vector(other) {} };
+	class vector4d : public basic_vector<double, 4u> { public: using basic_vector::basic_vector; constexpr vector4d(basic_vector const& other) : basic_vector(other) {} };
 
-	class vector2b : public basic_vector<uint8_t, 2u> { public: using basic_vector::basic_vector; };
-	class vector3b : public basic_vector<uint8_t, 3u> { public: using basic_vector::basic_vector; };
-	class vector4b : public basic_vector<uint8_t, 4u> { public: using basic_vector::basic_vector; };
+	class vector2b : public basic_vector<uint8_t, 2u> { public: using basic_vector::basic_vector; constexpr vector2b(basic_vector const& other) : basic_vector(other) {} };
+	class vector3b : public basic_vector<uint8_t, 3u> { public: using basic_vector::basic_vector; constexpr vector3b(basic_vector const& other) : basic_vector(other) {} };
+	class vector4b : public basic_vector<uint8_t, 4u> { public: using basic_vector::basic_vector; constexpr vector4b(basic_vector const& other) : basic_vector(other) {} };
 
-	class vector2u : public basic_vector<uint32_t, 2u> { public: using basic_vector::basic_vector; };
-	class vector3u : public basic_vector<uint32_t, 3u> { public: using basic_vector::basic_vector; };
-	class vector4u : public basic_vector<uint32_t, 4u> { public: using basic_vector::basic_vector; };
+	class vector2u : public basic_vector<uint32_t, 2u> { public: using basic_vector::basic_vector; constexpr vector2u(basic_vector const& other) : basic_vector(other) {} };
+	class vector3u : public basic_vector<uint32_t, 3u> { public: using basic_vector::basic_vector; constexpr vector3u(basic_vector const& other) : basic_vector(other) {} };
+	class vector4u : public basic_vector<uint32_t, 4u> { public: using basic_vector::basic_vector; constexpr vector4u(basic_vector const& other) : basic_vector(other) {} };
 
-	class vector2i : public basic_vector<int32_t, 2u> { public: using basic_vector::basic_vector; };
-	class vector3i : public basic_vector<int32_t, 3u> { public: using basic_vector::basic_vector; };
-	class vector4i : public basic_vector<int32_t, 4u> { public: using basic_vector::basic_vector; };
+	class vector2i : public basic_vector<int32_t, 2u> { public: using basic_vector::basic_vector; constexpr vector2i(basic_vector const& other) : basic_vector(other) {} };
+	class vector3i : public basic_vector<int32_t, 3u> { public: using basic_vector::basic_vector; constexpr vector3i(basic_vector const& other) : basic_vector(other) {} };
+	class vector4i : public basic_vector<int32_t, 4u> { public: using basic_vector::basic_vector; constexpr vector4i(basic_vector const& other) : basic_vector(other) {} };
 
-	class vector : public vector3f { public: using vector3f::vector3f; };
+	class vector : public vector3f { public: using vector3f::vector3f; constexpr vector(basic_vector<float, 3u> const& other) : vector3f(other) {} };
 	class vectorH : public basic_homogeneous_vector<float, 3u> { public: using basic_homogeneous_vector::basic_homogeneous_vector; };
 }
\ No newline at end of file
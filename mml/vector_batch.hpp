@@ -0,0 +1,414 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+#include "mml/transformation.hpp"
+
+#include "mml/exceptions.hpp"
+DefineNewMMLException(VectorBatchSizeMismatch);
+
+namespace mml {
+	// precise: the lengths and quotients of basic_vector::length() and normalize(). fast: the
+	// reciprocal square root estimate of simd::lanes refined by one Newton step, within about
+	// two ulps, where the lanes have one; double lanes compute the reciprocal exactly.
+	// Either way, vectors are normalized by the square root of at least the smallest normal
+	// number: zero vectors stay zero and vectors whose squared length underflows come out short,
+	// instead of turning into NaNs or infinities.
+	enum class precision { precise, fast };
+
+	// What length_factors makes of squared lengths: the lengths themselves, or the factors a
+	// vector has to be divided (precise) or multiplied (fast) by to normalize it.
+	enum class length_factor { length, normalization };
+
+	// Overwrites count squared lengths with their factors. A partial last group of lanes is
+	// padded, so every element goes through the same instructions.
+	template<typename T>
+	void length_factors(T* squares, size_t count, precision p, length_factor f) {
+		T const smallest = std::numeric_limits<T>::min();
+		using L = simd::lanes<T>;
+		if constexpr (L::accelerated) {
+			auto const process = [&](T* x) {
+				auto const sum = L::load(x);
+				if (p == precision::fast) {
+					auto const inverse = L::rsqrt(L::max(sum, L::broadcast(smallest)));
+					L::store(x, f == length_factor::length ? L::mul(sum, inverse) : inverse);
+				} else
+					L::store(x, L::sqrt(f == length_factor::length ? sum : L::max(sum, L::broadcast(smallest))));
+			};
+			size_t i = 0;
+			for (; i + L::width <= count; i += L::width)
+				process(squares + i);
+			if (i < count) {
+				T padded[L::width];
+				std::fill(std::copy(squares + i, squares + count, padded), padded + L::width, T(1));
+				process(padded);
+				std::copy(padded, padded + (count - i), squares + i);
+			}
+		} else
+			for (size_t i = 0; i < count; i++) {
+				if (f == length_factor::length)
+					squares[i] = T(std::sqrt(squares[i]));
+				else {
+					T const length = T(std::sqrt(std::max(squares[i], smallest)));
+					squares[i] = p == precision::fast ? T(1) / length : length;
+				}
+			}
+	}
+
+	// Structure-of-arrays storage for many basic_vector<T, S>: every component has its own
+	// contiguous lane, so the batch operations below stream through memory lane by lane.
+	template<typename T, size_t S>
+	class vector_batch {
+	protected:
+		std::vector<T> data[S];
+	public:
+		using value_type = T;
+		using vector_type = basic_vector<T, S>;
+		static const size_t size_value = S;
+
+		vector_batch() {}
+		explicit vector_batch(size_t count, vector_type const& value = vector_type()) {
+			resize(count, value);
+		}
+		template<typename Iterator, typename = typename std::enable_if<is_vector<typename std::iterator_traits<Iterator>::value_type>::value>::type>
+		vector_batch(Iterator first, Iterator last) {
+			assign(first, last);
+		}
+		vector_batch(std::initializer_list<vector_type> const& inputs) {
+			assign(inputs.begin(), inputs.end());
+		}
+
+		template<typename Iterator>
+		void assign(Iterator first, Iterator last) {
+			clear();
+			if constexpr (std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>::value)
+				reserve(size_t(std::distance(first, last)));
+			for (; first != last; ++first)
+				push_back(*first);
+		}
+		std::vector<vector_type> to_vectors() const {
+			std::vector<vector_type> res(size());
+			for (size_t i = 0; i < size(); i++)
+				res[i] = element(i);
+			return res;
+		}
+
+		size_t size() const {
+			return data[0].size();
+		}
+		bool empty() const {
+			return data[0].empty();
+		}
+		void reserve(size_t count) {
+			for (size_t k = 0; k < S; k++)
+				data[k].reserve(count);
+		}
+		void resize(size_t count, vector_type const& value = vector_type()) {
+			for (size_t k = 0; k < S; k++)
+				data[k].resize(count, value.element(k));
+		}
+		void clear() {
+			for (size_t k = 0; k < S; k++)
+				data[k].clear();
+		}
+		void push_back(vector_type const& value) {
+			for (size_t k = 0; k < S; k++)
+				data[k].push_back(value.element(k));
+		}
+
+		vector_type element(size_t index) const {
+			vector_type res;
+			for (size_t k = 0; k < S; k++)
+				res.element(k) = data[k][index];
+			return res;
+		}
+		vector_type operator[](size_t index) const noexcept(MML_BOUNDS_NOEXCEPT) {
+			CheckMMLBounds(index < size(), VectorIndexOutOfBounds);
+			return element(index);
+		}
+		vector_type at(size_t index) const noexcept(MML_BOUNDS_NOEXCEPT) {
+			return operator[](index);
+		}
+		void set(size_t index, vector_type const& value) noexcept(MML_BOUNDS_NOEXCEPT) {
+			CheckMMLBounds(index < size(), VectorIndexOutOfBounds);
+			for (size_t k = 0; k < S; k++)
+				data[k][index] = value.element(k);
+		}
+
+		T const* lane(size_t component) const noexcept(MML_BOUNDS_NOEXCEPT) {
+			CheckMMLBounds(component < S, VectorIndexOutOfBounds);
+			return data[component].data();
+		}
+		T* lane(size_t component) noexcept(MML_BOUNDS_NOEXCEPT) {
+			CheckMMLBounds(component < S, VectorIndexOutOfBounds);
+			return data[component].data();
+		}
+		template<size_t S_ = S, typename = typename std::enable_if<S_ >= 1 && S_ <= 4>::type> T const* x() const { return data[0].data(); }
+		template<size_t S_ = S, typename = typename std::enable_if<S_ >= 2 && S_ <= 4>::type> T const* y() const { return data[1].data(); }
+		template<size_t S_ = S, typename = typename std::enable_if<S_ >= 3 && S_ <= 4>::type> T const* z() const { return data[2].data(); }
+		template<size_t S_ = S, typename = typename std::enable_if<S_ >= 4 && S_ <= 4>::type> T const* w() const { return data[3].data(); }
+		template<size_t S_ = S, typename = typename std::enable_if<S_ >= 1 && S_ <= 4>::type> T* x() { return data[0].data(); }
+		template<size_t S_ = S, typename = typename std::enable_if<S_ >= 2 && S_ <= 4>::type> T* y() { return data[1].data(); }
+		template<size_t S_ = S, typename = typename std::enable_if<S_ >= 3 && S_ <= 4>::type> T* z() { return data[2].data(); }
+		template<size_t S_ = S, typename = typename std::enable_if<S_ >= 4 && S_ <= 4>::type> T* w() { return data[3].data(); }
+
+		std::vector<T> lengths_squared() const {
+			std::vector<T> res(size());
+			squares(0, size(), res.data());
+			return res;
+		}
+		std::vector<T> lengths(precision p = precision::precise) const {
+			std::vector<T> res(size());
+			squares(0, size(), res.data());
+			length_factors(res.data(), res.size(), p, length_factor::length);
+			return res;
+		}
+		template<typename T_ = T, typename = typename std::enable_if<std::is_floating_point<T_>::value>::type>
+		void normalize(precision p = precision::precise) {
+			normalize(0, size(), p);
+		}
+		template<typename T_ = T, typename = typename std::enable_if<std::is_floating_point<T_>::value>::type>
+		void normalize(size_t first, size_t last, precision p = precision::precise) {
+			static const size_t block = 256;
+			T factors[block];
+			for (size_t begin = first; begin < last; begin += block) {
+				size_t const count = std::min(block, last - begin);
+				squares(begin, begin + count, factors);
+				length_factors(factors, count, p, length_factor::normalization);
+				for (size_t k = 0; k < S; k++) {
+					T* lane = data[k].data() + begin;
+					size_t i = 0;
+					if constexpr (simd::lanes<T>::accelerated) {
+						using L = simd::lanes<T>;
+						for (; i + L::width <= count; i += L::width)
+							L::store(lane + i, p == precision::fast ? L::mul(L::load(lane + i), L::load(factors + i)) : L::div(L::load(lane + i), L::load(factors + i)));
+					}
+					for (; i < count; i++)
+						lane[i] = p == precision::fast ? lane[i] * factors[i] : lane[i] / factors[i];
+				}
+			}
+		}
+		template<typename T_ = T, typename = typename std::enable_if<std::is_floating_point<T_>::value>::type>
+		vector_batch<T, S> normalized(precision p = precision::precise) const {
+			vector_batch<T, S> res(*this);
+			res.normalize(p);
+			return res;
+		}
+	protected:
+		// Squared lengths of the elements in [first, last).
+		void squares(size_t first, size_t last, T* out) const {
+			size_t i = first;
+			if constexpr (simd::lanes<T>::accelerated) {
+				using L = simd::lanes<T>;
+				for (; i + L::width <= last; i += L::width) {
+					auto sum = L::broadcast(T(0));
+					for (size_t k = 0; k < S; k++) {
+						auto v = L::load(data[k].data() + i);
+						sum = L::add(sum, L::mul(v, v));
+					}
+					L::store(out + (i - first), sum);
+				}
+			}
+			for (; i < last; i++) {
+				T sum = T(0);
+				for (size_t k = 0; k < S; k++)
+					sum += data[k][i] * data[k][i];
+				out[i - first] = sum;
+			}
+		}
+	};
+
+	// Writes the first S_O rows of m * input to output for the elements in [first, last); output
+	// must already hold them. A homogeneous transform treats every input as a point with an
+	// implicit last component of one, like basic_homogeneous_vector, and drops the last row
+	// without a perspective divide. All inputs of a step are loaded before anything is stored,
+	// so input and output may alias.
+	template<bool homogeneous, typename T, size_t R, size_t C, size_t S_I, size_t S_O>
+	void transform_lanes(basic_matrix<T, R, C> const& m, vector_batch<T, S_I> const& input, vector_batch<T, S_O>& output, size_t first, size_t last) {
+		static_assert(S_O <= R && S_I + (homogeneous ? 1 : 0) == C, "Batch sizes do not match the matrix.");
+		T const* in[S_I];
+		T* out[S_O];
+		for (size_t c = 0; c < S_I; c++)
+			in[c] = input.lane(c);
+		for (size_t r = 0; r < S_O; r++)
+			out[r] = output.lane(r);
+
+		size_t i = first;
+		if constexpr (simd::lanes<T>::accelerated) {
+			using L = simd::lanes<T>;
+			typename L::type factors[S_O][C];
+			for (size_t r = 0; r < S_O; r++)
+				for (size_t c = 0; c < C; c++)
+					factors[r][c] = L::broadcast(m.element(r, c));
+			for (; i + L::width <= last; i += L::width) {
+				typename L::type v[S_I];
+				for (size_t c = 0; c < S_I; c++)
+					v[c] = L::load(in[c] + i);
+				for (size_t r = 0; r < S_O; r++) {
+					auto acc = L::broadcast(T(0));
+					for (size_t c = 0; c < S_I; c++)
+						acc = L::add(acc, L::mul(factors[r][c], v[c]));
+					if constexpr (homogeneous)
+						acc = L::add(acc, factors[r][S_I]);
+					L::store(out[r] + i, acc);
+				}
+			}
+		}
+		for (; i < last; i++) {
+			T v[S_I];
+			for (size_t c = 0; c < S_I; c++)
+				v[c] = in[c][i];
+			for (size_t r = 0; r < S_O; r++) {
+				T acc = T(0);
+				for (size_t c = 0; c < S_I; c++)
+					acc += m.element(r, c) * v[c];
+				if constexpr (homogeneous)
+					acc += m.element(r, S_I);
+				out[r][i] = acc;
+			}
+		}
+	}
+
+	// A batch of S = C components is multiplied by the matrix as is. A batch of S = C - 1
+	// components holds points for a square transformation and yields S components.
+	template<size_t R, size_t C, size_t S>
+	struct batch_transform_sizes {
+		static const bool homogeneous = S + 1 == C && R == C;
+		static const bool valid = S == C || homogeneous;
+		static const size_t result_size = homogeneous ? S : R;
+	};
+
+	template<typename T, size_t R, size_t C, size_t S>
+	auto transform(basic_matrix<T, R, C> const& m, vector_batch<T, S> const& input, vector_batch<T, batch_transform_sizes<R, C, S>::result_size>& output)
+		-> typename std::enable_if<batch_transform_sizes<R, C, S>::valid>::type {
+		output.resize(input.size());
+		transform_lanes<batch_transform_sizes<R, C, S>::homogeneous>(m, input, output, 0, input.size());
+	}
+	template<typename T, size_t R, size_t C, size_t S>
+	auto transform(basic_matrix<T, R, C> const& m, vector_batch<T, S> const& input)
+		-> typename std::enable_if<batch_transform_sizes<R, C, S>::valid, vector_batch<T, batch_transform_sizes<R, C, S>::result_size>>::type {
+		vector_batch<T, batch_transform_sizes<R, C, S>::result_size> res(input.size());
+		transform_lanes<batch_transform_sizes<R, C, S>::homogeneous>(m, input, res, 0, input.size());
+		return res;
+	}
+
+	template<typename T, size_t S>
+	std::vector<T> dot(vector_batch<T, S> const& v1, vector_batch<T, S> const& v2) {
+		if (v1.size() != v2.size())
+			throw Exceptions::VectorBatchSizeMismatch("Batches have different sizes.");
+		size_t const count = v1.size();
+		std::vector<T> res(count);
+		T const *a[S], *b[S];
+		for (size_t k = 0; k < S; k++) {
+			a[k] = v1.lane(k);
+			b[k] = v2.lane(k);
+		}
+		size_t i = 0;
+		if constexpr (simd::lanes<T>::accelerated) {
+			using L = simd::lanes<T>;
+			for (; i + L::width <= count; i += L::width) {
+				auto sum = L::broadcast(T(0));
+				for (size_t k = 0; k < S; k++)
+					sum = L::add(sum, L::mul(L::load(a[k] + i), L::load(b[k] + i)));
+				L::store(res.data() + i, sum);
+			}
+		}
+		for (; i < count; i++) {
+			T sum = T(0);
+			for (size_t k = 0; k < S; k++)
+				sum += a[k][i] * b[k][i];
+			res[i] = sum;
+		}
+		return res;
+	}
+	template<typename T>
+	vector_batch<T, 3> cross(vector_batch<T, 3> const& v1, vector_batch<T, 3> const& v2) {
+		if (v1.size() != v2.size())
+			throw Exceptions::VectorBatchSizeMismatch("Batches have different sizes.");
+		size_t const count = v1.size();
+		vector_batch<T, 3> res(count);
+		T const *ax = v1.x(), *ay = v1.y(), *az = v1.z();
+		T const *bx = v2.x(), *by = v2.y(), *bz = v2.z();
+		T *rx = res.x(), *ry = res.y(), *rz = res.z();
+		size_t i = 0;
+		if constexpr (simd::lanes<T>::accelerated) {
+			using L = simd::lanes<T>;
+			for (; i + L::width <= count; i += L::width) {
+				auto a0 = L::load(ax + i), a1 = L::load(ay + i), a2 = L::load(az + i);
+				auto b0 = L::load(bx + i), b1 = L::load(by + i), b2 = L::load(bz + i);
+				L::store(rx + i, L::sub(L::mul(a1, b2), L::mul(b1, a2)));
+				L::store(ry + i, L::sub(L::mul(a2, b0), L::mul(b2, a0)));
+				L::store(rz + i, L::sub(L::mul(a0, b1), L::mul(b0, a1)));
+			}
+		}
+		for (; i < count; i++) {
+			rx[i] = ay[i] * bz[i] - by[i] * az[i];
+			ry[i] = az[i] * bx[i] - bz[i] * ax[i];
+			rz[i] = ax[i] * by[i] - bx[i] * ay[i];
+		}
+		return res;
+	}
+
+	// The same operations on contiguous arrays of vectors, e.g. the normals of a mesh. They work
+	// through blocks of vectors so the square roots run in SIMD lanes across vectors, and use
+	// the vector array kernels of simd.hpp where there is one. Integer vectors are normalized
+	// into floating point ones, as by basic_vector::normalized().
+	template<typename T, size_t S>
+	void lengths_squared(basic_vector<T, S> const* vectors, T* out, size_t count) {
+		using K = simd::vector_array_kernel<T, S>;
+		size_t i = 0;
+		if constexpr (K::accelerated) {
+			static_assert(sizeof(basic_vector<T, S>) == sizeof(T) * S, "Vectors have to be tightly packed.");
+			for (; i + K::width <= count; i += K::width)
+				K::squares(out + i, reinterpret_cast<T const*>(vectors + i));
+		}
+		for (; i < count; i++)
+			out[i] = vectors[i] % vectors[i];
+	}
+	template<typename T, size_t S, typename = typename std::enable_if<std::is_floating_point<T>::value>::type>
+	void lengths(basic_vector<T, S> const* vectors, T* out, size_t count, precision p = precision::precise) {
+		lengths_squared(vectors, out, count);
+		length_factors(out, count, p, length_factor::length);
+	}
+	template<typename T_I, typename T, size_t S, typename = typename std::enable_if<std::is_floating_point<T>::value>::type>
+	void normalize(basic_vector<T_I, S> const* input, basic_vector<T, S>* output, size_t count, precision p = precision::precise) {
+		using K = simd::vector_array_kernel<T, S>;
+		static const size_t block = 256;
+		T factors[block];
+		for (size_t first = 0; first < count; first += block) {
+			size_t const size = std::min(block, count - first);
+			basic_vector<T, S> const* in = output + first;
+			if constexpr (std::is_same<T_I, T>::value)
+				in = input + first;
+			else
+				for (size_t i = 0; i < size; i++)
+					output[first + i] = basic_vector<T, S>(input[first + i]);
+			lengths_squared(in, factors, size);
+			length_factors(factors, size, p, length_factor::normalization);
+			size_t i = 0;
+			if constexpr (K::accelerated)
+				for (; i + K::width <= size; i += K::width)
+					K::scale(reinterpret_cast<T*>(output + first + i), reinterpret_cast<T const*>(in + i), factors + i, p == precision::fast);
+			for (; i < size; i++) {
+				output[first + i] = in[i];
+				if (p == precision::fast)
+					output[first + i] *= factors[i];
+				else
+					output[first + i] /= factors[i];
+			}
+		}
+	}
+	template<typename T, size_t S, typename = typename std::enable_if<std::is_floating_point<T>::value>::type>
+	void normalize(basic_vector<T, S>* vectors, size_t count, precision p = precision::precise) {
+		normalize(vectors, vectors, count, p);
+	}
+
+	class vector_batch3f : public vector_batch<float, 3u> { public: using vector_batch::vector_batch; };
+	class vector_batch4f : public vector_batch<float, 4u> { public: using vector_batch::vector_batch; };
+	class vector_batch3d : public vector_batch<double, 3u> { public: using vector_batch::vector_batch; };
+	class vector_batch4d : public vector_batch<double, 4u> { public: using vector_batch::vector_batch; };
+}
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "mml/aligned.hpp"
+#include "mml/array_file.hpp"
+
+#include "check.hpp"
+
+using namespace mml;
+
+static std::vector<char> read_file(std::string const& path) {
+	std::vector<char> res;
+	if (std::FILE* f = std::fopen(path.c_str(), "rb")) {
+		char buffer[4096];
+		for (size_t size; (size = std::fread(buffer, 1, sizeof(buffer), f)) > 0;)
+			res.insert(res.end(), buffer, buffer + size);
+		std::fclose(f);
+	}
+	return res;
+}
+static void write_file(std::string const& path, std::vector<char> const& bytes) {
+	if (std::FILE* f = std::fopen(path.c_str(), "wb")) {
+		std::fwrite(bytes.data(), 1, bytes.size(), f);
+		std::fclose(f);
+	}
+}
+template<typename U>
+static std::vector<char> patched(std::vector<char> bytes, size_t offset, U const& value) {
+	std::memcpy(bytes.data() + offset, &value, sizeof(value));
+	return bytes;
+}
+
+// Whether mapping path as an array of V throws an ArrayFileError mentioning message.
+template<typename V>
+static bool rejects(std::string const& path, char const* message) {
+	try {
+		mapped_array<V> array(path);
+	} catch (Exceptions::ArrayFileError const& error) {
+		return std::strstr(error.what(), message) != nullptr;
+	}
+	return false;
+}
+
+static void check_round_trip() {
+	std::vector<vector3f> points;
+	for (size_t i = 0; i < 1000; i++)
+		points.emplace_back(float(i), float(i) * 0.5f, -float(i));
+	{
+		// Written in uneven chunks; close() is safe to call again, also from the destructor.
+		array_writer<vector3f> writer("array_file_points.bin");
+		writer.write(points.data(), 7);
+		writer.write(points[7]);
+		writer.write(array_span<vector3f const>(points.data() + 8, points.size() - 8));
+		check(writer.size() == points.size());
+		writer.close();
+		writer.close();
+	}
+	mapped_array<vector3f> const read("array_file_points.bin");
+	check(read.size() == points.size());
+	check(read.header().data_offset % 64 == 0 && read.header().rows == 3 && read.header().columns == 1);
+	check(std::memcmp(read.data(), points.data(), points.size() * sizeof(vector3f)) == 0);
+	check(read[999] == points[999] && read.span(10, 5)[4] == points[14]);
+
+	// Over-aligned elements keep their padding and land on an aligned offset.
+	std::vector<aligned_vector3d> aligned(33);
+	for (size_t i = 0; i < aligned.size(); i++)
+		aligned[i] = aligned_vector3d(double(i), 1. / double(i + 1), 2.);
+	write_array("array_file_aligned.bin", aligned.data(), aligned.size());
+	mapped_array<aligned_vector3d> const read_aligned("array_file_aligned.bin");
+	check(read_aligned.size() == aligned.size() && reinterpret_cast<uintptr_t>(read_aligned.data()) % alignof(aligned_vector3d) == 0);
+	check(std::memcmp(read_aligned.data(), aligned.data(), aligned.size() * sizeof(aligned_vector3d)) == 0);
+
+	matrix4f const transform(1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f, 9.f, 10.f, 11.f, 12.f, 13.f, 14.f, 15.f, 16.f);
+	write_array("array_file_matrices.bin", &transform, 1);
+	mapped_array<matrix4f> const read_matrices("array_file_matrices.bin");
+	check(read_matrices.size() == 1 && read_matrices[0] == transform && read_matrices.header().rows == 4 && read_matrices.header().columns == 4);
+
+	write_array<vector3f>("array_file_empty.bin", nullptr, 0);
+	mapped_array<vector3f> const empty("array_file_empty.bin");
+	check(empty.size() == 0 && empty.span().empty());
+}
+
+static void check_corruption() {
+	std::vector<vector3f> const points(10, vector3f(1.f, 2.f, 3.f));
+	write_array("array_file_good.bin", points.data(), points.size());
+	std::vector<char> const good = read_file("array_file_good.bin");
+	check(good.size() == 64 + points.size() * sizeof(vector3f));
+
+	check(rejects<vector3f>("array_file_missing.bin", "Cannot open"));
+	write_file("array_file_short.bin", std::vector<char>(good.begin(), good.begin() + 32));
+	check(rejects<vector3f>("array_file_short.bin", "not an array file"));
+	write_file("array_file_magic.bin", patched(good, 0, 'X'));
+	check(rejects<vector3f>("array_file_magic.bin", "Not an array file"));
+	write_file("array_file_order.bin", patched(good, offsetof(array_file_header, byte_order), uint32_t(0x04030201)));
+	check(rejects<vector3f>("array_file_order.bin", "byte order"));
+	write_file("array_file_version.bin", patched(good, offsetof(array_file_header, version), uint32_t(2)));
+	check(rejects<vector3f>("array_file_version.bin", "version 2"));
+	check(rejects<vector3d>("array_file_good.bin", "do not match"));
+	check(rejects<vector4f>("array_file_good.bin", "do not match"));
+	check(rejects<basic_vector<int32_t, 3>>("array_file_good.bin", "do not match"));
+	write_file("array_file_offset.bin", patched(good, offsetof(array_file_header, data_offset), uint64_t(66)));
+	check(rejects<vector3f>("array_file_offset.bin", "misaligned"));
+	write_file("array_file_inside.bin", patched(good, offsetof(array_file_header, data_offset), uint64_t(32)));
+	check(rejects<vector3f>("array_file_inside.bin", "misaligned"));
+	write_file("array_file_truncated.bin", std::vector<char>(good.begin(), good.end() - 1));
+	check(rejects<vector3f>("array_file_truncated.bin", "truncated"));
+	write_file("array_file_count.bin", patched(good, offsetof(array_file_header, count), uint64_t(-1)));
+	check(rejects<vector3f>("array_file_count.bin", "truncated"));
+
+	// The untouched file still maps.
+	mapped_array<vector3f> const read("array_file_good.bin");
+	check(read.size() == points.size());
+}
+
+int main() {
+	check_round_trip();
+	check_corruption();
+	for (char const* name : {"points", "aligned", "matrices", "empty", "good", "short", "magic", "order", "version", "offset", "inside", "truncated", "count"})
+		std::remove(("array_file_" + std::string(name) + ".bin").c_str());
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "mml/bvh.hpp"
+
+#include "check.hpp"
+
+using namespace mml;
+
+using point = basic_vector<double, 3>;
+
+struct generator {
+	uint64_t state = 88172645463325252ull;
+	double operator()(double low, double high) {
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		return low + double(state >> 11) / double(uint64_t(1) << 53) * (high - low);
+	}
+	point position(double extent) {
+		double const x = (*this)(-extent, extent), y = (*this)(-extent, extent);
+		return point(x, y, (*this)(-extent, extent));
+	}
+};
+
+// Every node is reached once, children lie within their parents and the leaves cover each
+// primitive exactly once.
+template<typename P>
+static bool well_formed(basic_bvh<P> const& tree) {
+	if (tree.empty())
+		return tree.node_count() == 1 && tree.data()[0].count == 0;
+	std::vector<size_t> visits(tree.node_count(), 0), covered(tree.size(), 0);
+	std::vector<uint32_t> stack{0};
+	while (!stack.empty()) {
+		auto const& n = tree.data()[stack.back()];
+		visits[stack.back()]++;
+		stack.pop_back();
+		if (n.leaf()) {
+			for (size_t i = n.offset; i < n.offset + n.count && i < covered.size(); i++)
+				covered[i]++;
+			continue;
+		}
+		for (uint32_t child : {n.offset, n.offset + 1}) {
+			if (child >= tree.node_count() || !n.bounds.contains(tree.data()[child].bounds))
+				return false;
+			stack.push_back(child);
+		}
+	}
+	for (size_t i = 0; i < tree.node_count(); i++)
+		if (visits[i] > 1 || (visits[i] == 0 && i != 1))
+			return false;
+	return std::all_of(covered.begin(), covered.end(), [](size_t c) { return c == 1; });
+}
+
+// The queries of the tree against brute force over the input: equal distances, since both
+// use the same primitive functions, and the same sets of indices where there are no ties.
+template<typename P>
+static void check_queries(basic_bvh<P> const& tree, std::vector<P> const& input, generator& g, size_t queries) {
+	using hit = typename basic_bvh<P>::hit;
+	check(tree.size() == input.size() && well_formed(tree));
+	bool within = true, nearest = true;
+	for (size_t q = 0; q < queries; q++) {
+		point const center = g.position(15.);
+		double const radius = g(0., 4.);
+		std::vector<size_t> expected, found = tree.within(center, radius);
+		for (size_t i = 0; i < input.size(); i++)
+			if (squared_distance(center, input[i]) <= radius * radius)
+				expected.push_back(i);
+		std::sort(found.begin(), found.end());
+		within = within && found == expected;
+
+		std::vector<double> distances;
+		for (auto const& p : input)
+			distances.push_back(squared_distance(center, p));
+		std::sort(distances.begin(), distances.end());
+		for (size_t k : {size_t(1), size_t(5), input.size() + 1})
+			for (double limit : {std::numeric_limits<double>::infinity(), radius}) {
+				std::vector<hit> const hits = tree.nearest(center, k, limit);
+				size_t count = 0;
+				while (count < std::min(k, distances.size()) && distances[count] <= limit * limit)
+					count++;
+				nearest = nearest && hits.size() == count;
+				std::vector<size_t> indices;
+				for (size_t i = 0; i < hits.size() && i < count; i++) {
+					nearest = nearest && hits[i].distance == std::sqrt(distances[i]);
+					nearest = nearest && hits[i].distance == std::sqrt(squared_distance(center, input[hits[i].index]));
+					indices.push_back(hits[i].index);
+				}
+				std::sort(indices.begin(), indices.end());
+				nearest = nearest && std::adjacent_find(indices.begin(), indices.end()) == indices.end();
+			}
+	}
+	check(within);
+	check(nearest);
+}
+template<typename P>
+static void check_casts(basic_bvh<P> const& tree, std::vector<P> const& input, generator& g, size_t queries) {
+	bool cast = true;
+	for (size_t q = 0; q < queries; q++) {
+		// Also along the axes, where the slabs of the boxes divide by zero.
+		point direction = q % 8 == 0 ? point(0., 0., q % 16 ? 1. : -1.) : g.position(1.);
+		if (q % 8 == 4)
+			direction = point(direction[0], 0., 0.);
+		basic_ray<double> const ray(g.position(15.), direction);
+		for (double limit : {std::numeric_limits<double>::infinity(), 12.}) {
+			double best = limit;
+			for (auto const& p : input)
+				best = std::min(best, intersect(ray, p));
+			auto const res = tree.cast(ray, limit);
+			if (best < limit)
+				cast = cast && res && res.distance == best && intersect(ray, input[res.index]) == best;
+			else
+				cast = cast && !res && res.distance == limit;
+		}
+	}
+	check(cast);
+}
+
+int main() {
+	generator g;
+	thread_pool one(1), three(3);
+
+	std::vector<point> points;
+	for (size_t i = 0; i < 500; i++)
+		points.push_back(g.position(10.));
+	// Coincident points have no centroid extent, so they are split at the median.
+	points.insert(points.end(), 300, point(1., 2., 3.));
+	points.insert(points.end(), 40, points[7]);
+	for (size_t leaf_size : {1, 4, 16})
+		check_queries(basic_bvh<point>(points, leaf_size, one), points, g, 100);
+	std::vector<point> const same(1000, point(-1., 0., 1.));
+	basic_bvh<point> const coincident(same, 4, three);
+	check_queries(coincident, same, g, 20);
+	check(coincident.nearest(point(-1., 0., 1.), 3).size() == 3 && coincident.within(point(-1., 0., 2.), 1.).size() == same.size());
+
+	std::vector<basic_sphere<double>> spheres;
+	for (size_t i = 0; i < 800; i++)
+		spheres.emplace_back(g.position(10.), g(.05, 1.));
+	basic_bvh<basic_sphere<double>> const sphere_tree(spheres, 4, one);
+	check_queries(sphere_tree, spheres, g, 100);
+	check_casts(sphere_tree, spheres, g, 200);
+
+	std::vector<basic_triangle<double>> triangles;
+	for (size_t i = 0; i < 800; i++) {
+		point const corner = g.position(10.);
+		triangles.emplace_back(corner, corner + g.position(1.), corner + g.position(1.));
+	}
+	basic_bvh<basic_triangle<double>> const triangle_tree(triangles, 4, one);
+	check_queries(triangle_tree, triangles, g, 100);
+	check_casts(triangle_tree, triangles, g, 200);
+
+	// Above parallel_grain, both halves of the upper nodes are built by the pool.
+	std::vector<basic_triangle<double>> many;
+	for (size_t i = 0; i < 3 * basic_bvh<basic_triangle<double>>::parallel_grain; i++) {
+		point const corner = g.position(20.);
+		many.emplace_back(corner, corner + g.position(.5), corner + g.position(.5));
+	}
+	basic_bvh<basic_triangle<double>> const serial(many, 4, one), parallel(many, 4, three);
+	check(serial.node_count() == parallel.node_count());
+	check_queries(parallel, many, g, 50);
+	check_casts(parallel, many, g, 100);
+	std::vector<point> large;
+	for (size_t i = 0; i < 2 * basic_bvh<point>::parallel_grain; i++)
+		large.push_back(i % 3 ? g.position(10.) : points[i % points.size()]);
+	check_queries(basic_bvh<point>(large, 4, three), large, g, 50);
+
+	basic_bvh<point> const empty(std::vector<point>{}, 4, one);
+	check_queries(empty, std::vector<point>{}, g, 2);
+	check_casts(basic_bvh<basic_sphere<double>>(std::vector<basic_sphere<double>>{}, 4, one), std::vector<basic_sphere<double>>{}, g, 2);
+	return failures == 0 ? 0 : 1;
+}
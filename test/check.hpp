@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdio>
+
+// Counts and reports failed conditions; every test's main returns failures == 0 ? 0 : 1.
+static int failures = 0;
+#define check(...) \
+	do { \
+		if (!(__VA_ARGS__)) { \
+			std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #__VA_ARGS__); \
+			failures++; \
+		} \
+	} while (false)
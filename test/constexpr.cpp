@@ -0,0 +1,41 @@
+#include "mml/transformation.hpp"
+
+using namespace mml;
+
+// Everything here is folded by the compiler; the checks are static_asserts, so building this
+// file is the test. The constants are external so that they are emitted, and the rodata test
+// checks that they were constant initialized into read-only data.
+extern constexpr auto moved = translation(1.f, 2.f, 3.f);
+static_assert(moved.element(0, 3) == 1.f && moved.element(1, 3) == 2.f && moved.element(2, 3) == 3.f);
+static_assert(moved.element(0, 0) == 1.f && moved.element(3, 3) == 1.f && moved.element(0, 1) == 0.f);
+
+extern constexpr auto scaled = scaling(2.f, 3.f, 4.f);
+static_assert(scaled.element(0, 0) == 2.f && scaled.element(1, 1) == 3.f && scaled.element(2, 2) == 4.f);
+static_assert(scaled.element(3, 3) == 1.f && scaled.element(0, 3) == 0.f);
+
+extern constexpr auto composed = moved * scaled;
+static_assert(composed.element(0, 0) == 2.f && composed.element(2, 3) == 3.f);
+
+constexpr bool near(double a, double b) {
+	return a - b < 1e-6 && b - a < 1e-6;
+}
+
+extern constexpr auto turned_x = rotation_x(math::pi<double> / 2);
+static_assert(turned_x.element(0, 0) == 1.);
+static_assert(near(turned_x.element(1, 1), 0.) && near(turned_x.element(1, 2), -1.) && near(turned_x.element(2, 1), 1.));
+
+extern constexpr auto turned_z = rotation_z(math::pi<double> / 6);
+static_assert(near(turned_z.element(0, 0), math::constexpr_sqrt(3.) / 2) && near(turned_z.element(1, 0), .5));
+static_assert(near(turned_z.element(0, 1), -.5) && turned_z.element(2, 2) == 1.);
+
+extern constexpr auto orthographic = orthographic_projection(-2.f, 2.f, -1.f, 1.f, 1.f, 3.f);
+static_assert(orthographic.element(0, 0) == .5f && orthographic.element(1, 1) == 1.f);
+static_assert(orthographic.element(2, 2) == -1.f && orthographic.element(2, 3) == -2.f && orthographic.element(3, 3) == 1.f);
+
+extern constexpr auto perspective = perspective_projection(-1.f, 1.f, -1.f, 1.f, 1.f, 3.f);
+static_assert(perspective.element(0, 0) == 1.f && perspective.element(1, 1) == 1.f);
+static_assert(perspective.element(2, 2) == -2.f && perspective.element(2, 3) == -3.f && perspective.element(3, 2) == -1.f);
+
+int main() {
+	return 0;
+}
@@ -0,0 +1,147 @@
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "mml/dynamic_decomposition.hpp"
+
+#include "check.hpp"
+
+using namespace mml;
+
+// Residuals are relative, and bounded by a small multiple of n epsilon, which a backward
+// stable factorization of these well-conditioned matrices stays well within.
+template<typename T>
+static bool small(double residual, size_t n) {
+	return residual <= double(std::numeric_limits<T>::epsilon()) * double(n) * 32;
+}
+
+template<typename T>
+static double norm(dynamic_matrix<T> const& m) {
+	double sum = 0;
+	for (size_t r = 0; r < m.rows(); r++)
+		for (size_t c = 0; c < m.columns(); c++)
+			sum += double(m.element(r, c)) * double(m.element(r, c));
+	return std::sqrt(sum);
+}
+template<typename T>
+static double relative(dynamic_matrix<T> const& difference, dynamic_matrix<T> const& reference) {
+	return norm(difference) / norm(reference);
+}
+
+struct generator {
+	uint64_t state = 88172645463325252ull;
+	double operator()() {
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		return double(state >> 11) / double(uint64_t(1) << 53) * 2 - 1;
+	}
+};
+
+// Diagonally dominant for lu and qr, B B^T + n I for cholesky.
+template<typename T>
+static dynamic_matrix<T> general(size_t rows, size_t columns, generator& g) {
+	dynamic_matrix<T> m(rows, columns, ZeroMatrix);
+	for (size_t r = 0; r < rows; r++)
+		for (size_t c = 0; c < columns; c++)
+			m.element(r, c) = T(g()) + (r == c ? T(columns) : T(0));
+	return m;
+}
+template<typename T>
+static dynamic_matrix<T> positive_definite(size_t n, generator& g) {
+	dynamic_matrix<T> b(n, n, ZeroMatrix);
+	for (size_t r = 0; r < n; r++)
+		for (size_t c = 0; c < n; c++)
+			b.element(r, c) = T(g());
+	dynamic_matrix<T> m = b * b.transposed();
+	for (size_t i = 0; i < n; i++)
+		m.element(i, i) += T(n);
+	return m;
+}
+template<typename T>
+static dynamic_matrix<T> identity(size_t n) {
+	return dynamic_matrix<T>(n, n);
+}
+template<typename T, size_t S>
+static dynamic_matrix<T> column(basic_vector<T, S> const& v) {
+	dynamic_matrix<T> m(S, 1, ZeroMatrix);
+	for (size_t i = 0; i < S; i++)
+		m.element(i, 0) = v[i];
+	return m;
+}
+
+template<typename T>
+static void check_dynamic(size_t n, generator& g) {
+	dynamic_matrix<T> const b = general<T>(n, 3, g);
+
+	dynamic_matrix<T> const a = general<T>(n, n, g);
+	dynamic_lu<T> const lu(a);
+	check(small<T>(relative(a * lu.solve(b) - b, b), n));
+	dynamic_matrix<T> permuted(n, n, ZeroMatrix);
+	for (size_t r = 0; r < n; r++)
+		for (size_t c = 0; c < n; c++)
+			permuted.element(r, c) = a.element(lu.permutation(r), c);
+	check(small<T>(relative(lu.lower() * lu.upper() - permuted, a), n));
+
+	dynamic_qr<T> const qr(a);
+	check(small<T>(relative(a * qr.solve(b) - b, b), n));
+	dynamic_matrix<T> const q = qr.q();
+	check(small<T>(norm(q.transposed() * q - identity<T>(n)), n));
+	check(small<T>(relative(q * qr.r() - a, a), n));
+
+	// A tall matrix keeps columns() columns of Q.
+	dynamic_matrix<T> const tall = general<T>(n + 9, n, g);
+	dynamic_qr<T> const tall_qr(tall);
+	dynamic_matrix<T> const tall_q = tall_qr.q();
+	check(small<T>(norm(tall_q.transposed() * tall_q - identity<T>(n)), n));
+	check(small<T>(relative(tall_q * tall_qr.r() - tall, tall), n));
+
+	dynamic_matrix<T> const spd = positive_definite<T>(n, g);
+	dynamic_cholesky<T> const cholesky(spd);
+	check(small<T>(relative(spd * cholesky.solve(b) - b, b), n));
+	check(small<T>(relative(cholesky.lower() * cholesky.lower().transposed() - spd, spd), n));
+}
+
+template<typename T, size_t S>
+static void check_fixed(generator& g) {
+	basic_matrix<T, S, S> const a(general<T>(S, S, g));
+	basic_vector<T, S> b;
+	for (size_t i = 0; i < S; i++)
+		b[i] = T(g());
+	dynamic_matrix<T> const b_column = column(b);
+
+	auto const residual = [&](basic_matrix<T, S, S> const& m, basic_vector<T, S> const& x) {
+		return relative(dynamic_matrix<T>(m) * column(x) - b_column, b_column);
+	};
+
+	lu_decomposition<T, S> const lu(a);
+	check(small<T>(residual(a, lu.solve(b)), S));
+
+	qr_decomposition<T, S, S> const qr(a);
+	check(small<T>(residual(a, qr.solve(b)), S));
+	dynamic_matrix<T> const q(qr.q());
+	check(small<T>(norm(q.transposed() * q - identity<T>(S)), S));
+	check(small<T>(relative(q * dynamic_matrix<T>(qr.r()) - dynamic_matrix<T>(a), dynamic_matrix<T>(a)), S));
+
+	basic_matrix<T, S, S> const spd(positive_definite<T>(S, g));
+	cholesky_decomposition<T, S> const cholesky(spd);
+	check(small<T>(residual(spd, cholesky.solve(b)), S));
+	dynamic_matrix<T> const l(cholesky.lower());
+	check(small<T>(relative(l * l.transposed() - dynamic_matrix<T>(spd), dynamic_matrix<T>(spd)), S));
+}
+
+int main() {
+	generator g;
+	// Around triangular_kernel<T>::block, the panel width of the dynamic factorizations.
+	for (size_t n : {1, 5, 63, 64, 65, 127, 130}) {
+		check_dynamic<double>(n, g);
+		check_dynamic<float>(n, g);
+	}
+	check_fixed<double, 4>(g);
+	check_fixed<float, 4>(g);
+	check_fixed<double, 63>(g);
+	check_fixed<double, 65>(g);
+	check_fixed<float, 65>(g);
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+#include <cmath>
+#include <type_traits>
+#include <utility>
+
+#include "mml/matrix.hpp"
+
+#include "check.hpp"
+
+using namespace mml;
+
+int main() {
+	// Operators on plain vectors and matrices evaluate at once, so later changes to the
+	// operands do not reach results kept with auto, and those results can be modified.
+	vector3f a(1.f, 1.f, 1.f), b(1.f, 2.f, 3.f), c(1.f, 1.f, 1.f);
+	auto d = a - b;
+	a = vector3f(10.f, 10.f, 10.f);
+	vector3f r = d;
+	check(r == basic_vector<float, 3>(0.f, -1.f, -2.f));
+	auto x = a + b;
+	x += c;
+	check(x == basic_vector<float, 3>(12.f, 13.f, 14.f));
+	auto s = b * 2.f;
+	s /= 2.f;
+	check(s == b);
+
+	matrix3f m(IdentityMatrix), n(ZeroMatrix);
+	auto p = m + n;
+	m = matrix3f(ZeroMatrix);
+	p *= 2.f;
+	check(p == basic_matrix<float, 3, 3>(IdentityMatrix) * 2.f);
+
+	// Mixed types and sizes keep the eager promotion rules.
+	basic_vector<double, 2> e(1.0, 2.0);
+	auto f = basic_vector<double, 3>(1.0, 1.0, 1.0) + e;
+	static_assert(std::is_same<decltype(f), basic_vector<double, 3>>::value, "");
+	check(f == basic_vector<double, 3>(2.0, 3.0, 1.0));
+	auto g = basic_vector<int, 2>(1, 2) * 0.5;
+	static_assert(std::is_same<decltype(g), basic_vector<double, 2>>::value, "");
+	check(g == basic_vector<double, 2>(0.5, 1.0));
+
+	// lazy() opts into fused expressions, which reference their lvalue operands.
+	a = vector3f(1.f, 1.f, 1.f);
+	auto lazy_sum = lazy(a) + b * 2.f - c;
+	static_assert(is_vector_expression<decltype(lazy_sum)>::value, "");
+	check(basic_vector<float, 3>(lazy_sum) == basic_vector<float, 3>(2.f, 4.f, 6.f));
+	a = vector3f(2.f, 2.f, 2.f);
+	check(lazy_sum.eval() == basic_vector<float, 3>(3.f, 5.f, 7.f));
+	vector3f y;
+	y = lazy(a) * 3.f + lazy(b);
+	check(y == basic_vector<float, 3>(7.f, 8.f, 9.f));
+	y += lazy(b) / 2.f;
+	check(y == basic_vector<float, 3>(7.5f, 9.f, 10.5f));
+
+	matrix3f q = lazy(p) * 0.5f - lazy(n);
+	check(q == basic_matrix<float, 3, 3>(IdentityMatrix));
+
+	// Assigning an expression returns a modifiable reference, as the other assignments do.
+	(y = lazy(b) * 2.f).normalize();
+	check(std::abs(y.length() - 1.f) < 1e-6f && std::abs(y[2] / y[0] - 3.f) < 1e-6f);
+	basic_matrix<float, 3, 3> w;
+	static_assert(std::is_same<decltype(w = lazy(p) - lazy(n)), basic_matrix<float, 3, 3>&>::value, "");
+	static_assert(std::is_same<decltype(std::declval<basic_vector<float, 3>&>() = lazy(a) + b), basic_vector<float, 3>&>::value, "");
+	(w = lazy(p) - lazy(n))[0][0] = 5.f;
+	check(w.element(0, 0) == 5.f);
+	return failures == 0 ? 0 : 1;
+}
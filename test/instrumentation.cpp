@@ -0,0 +1,57 @@
+#include <string>
+
+#include "mml/matrix.hpp"
+#include "mml/instrumentation.hpp"
+
+#include "check.hpp"
+
+using namespace mml;
+namespace counters = mml::instrumentation;
+
+static counters::snapshot measure() {
+	auto res = counters::take();
+	counters::reset();
+	return res;
+}
+
+int main() {
+	counters::reset();
+
+	// A matrix counts once as a matrix and never as the vectors of its rows.
+	matrix4f m;
+	auto s = measure();
+	check(s[counters::matrix_constructions] == 1 && s[counters::vector_constructions] == 0);
+	matrix4f n(m);
+	s = measure();
+	check(s[counters::matrix_copies] == 1 && s[counters::vector_copies] == 0);
+	matrix4f o(std::move(n));
+	o = m;
+	s = measure();
+	check(s[counters::matrix_moves] == 1 && s[counters::matrix_copies] == 1 && s[counters::vector_moves] == 0 && s[counters::vector_copies] == 0);
+
+	// Element-wise arithmetic counts one flop per element and operation.
+	vector3f a(1.f, 2.f, 3.f), b(1.f, 1.f, 1.f), c;
+	measure();
+	c = a + b;
+	check(measure()[counters::flops] == 3);
+	c += b;
+	check(measure()[counters::flops] == 3);
+	c = lazy(a) + b * 2.f - c;
+	check(measure()[counters::flops] == 9);
+	matrix4f p = m + o;
+	check(measure()[counters::flops] == 16);
+	p *= 2.f;
+	check(measure()[counters::flops] == 16);
+
+	// Regions are told apart by their names, not by the addresses of the names.
+	std::string const name = std::string("frame") + ".update";
+	for (int i = 0; i < 2; i++) {
+		MMLInstrumentedRegion("frame.update");
+	}
+	{
+		MMLInstrumentedRegion(name.c_str());
+	}
+	s = measure();
+	check(s.regions.size() == 1 && s.regions[0].calls == 3 && std::string(s.regions[0].name) == "frame.update");
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "mml/quaternion.hpp"
+
+#include "check.hpp"
+
+using namespace mml;
+
+// Unit magnitudes, so a few epsilon absolute: the scalar reference may be contracted into fma
+// by the compiler when the kernels are not.
+template<typename O>
+static bool close(O const* a, O const* b, size_t count) {
+	using T = std::remove_cv_t<std::remove_pointer_t<decltype(a->begin())>>;
+	for (size_t i = 0; i < count; i++)
+		for (size_t k = 0; k < sizeof(O) / sizeof(T); k++)
+			if (!(std::abs(a[i].begin()[k] - b[i].begin()[k]) <= std::numeric_limits<T>::epsilon() * 16))
+				return false;
+	return true;
+}
+
+// The batched functions agree with the single quaternion ones for every count around the
+// SIMD width and with outputs aliasing inputs.
+template<typename T>
+static void check_type() {
+	size_t const count = 37;
+	std::vector<basic_quaternion<T>> a(count), b(count), out(count), expected(count);
+	std::vector<basic_vector<T, 3>> v(count), moved(count), expected_moved(count);
+	for (size_t i = 0; i < count; i++) {
+		T const f = T(i) * T(0.37);
+		a[i] = quaternion_rotation(f - T(3), basic_vector<T, 3>(T(1), f, T(0.5) - f));
+		b[i] = quaternion_rotation(T(1) - f * T(0.5), basic_vector<T, 3>(f * f, T(-1), T(2)));
+		v[i] = basic_vector<T, 3>(f, T(1) - f, T(3));
+	}
+	for (size_t n = 0; n <= count; n++) {
+		for (size_t i = 0; i < n; i++) {
+			expected[i] = a[i] * b[i];
+			expected_moved[i] = a[i].rotate(v[i]);
+		}
+		multiply(a.data(), b.data(), n, out.data());
+		check(close(out.data(), expected.data(), n));
+		rotate(a.data(), v.data(), n, moved.data());
+		check(close(moved.data(), expected_moved.data(), n));
+		for (size_t i = 0; i < n; i++)
+			expected[i] = nlerp(a[i], b[i], T(0.3));
+		nlerp(a.data(), b.data(), n, T(0.3), out.data());
+		check(close(out.data(), expected.data(), n));
+	}
+	auto c = a;
+	for (size_t i = 0; i < count; i++)
+		expected[i] = a[i] * b[i];
+	multiply(c.data(), b.data(), count, c.data());
+	check(close(c.data(), expected.data(), count));
+	auto w = v;
+	rotate(a.data(), w.data(), count, w.data());
+	for (size_t i = 0; i < count; i++)
+		expected_moved[i] = a[i].rotate(v[i]);
+	check(close(w.data(), expected_moved.data(), count));
+}
+
+int main() {
+	check_type<float>();
+	check_type<double>();
+	std::vector<quaternionf> named(11);
+	multiply(named.data(), named.data(), named.size(), named.data());
+	check(named[10] == basic_quaternion<float>());
+	return failures == 0 ? 0 : 1;
+}
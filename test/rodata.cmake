@@ -0,0 +1,11 @@
+# Fails unless every constant of constexpr.cpp is in a read-only data section of FILE, as
+# listed by OBJDUMP -t.
+execute_process(COMMAND ${OBJDUMP} -t ${FILE} OUTPUT_VARIABLE symbols RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+	message(FATAL_ERROR "${OBJDUMP} -t ${FILE} failed.")
+endif()
+foreach(name moved scaled composed turned_x turned_z orthographic perspective)
+	if(NOT symbols MATCHES "[ \t]O[ \t]+\\.rodata[^ \t]*[ \t]+[0-9a-fA-F]+[ \t]+${name}\n")
+		message(FATAL_ERROR "${name} is not in .rodata.")
+	endif()
+endforeach()
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include <cstdint>
+#include <vector>
+
+#include "mml/sparse_matrix.hpp"
+
+#include "check.hpp"
+
+using namespace mml;
+
+// Small integers throughout, so every sum is exact whatever order it runs in and results can
+// be compared with == against dense references.
+struct generator {
+	uint32_t state = 12345;
+	size_t operator()(size_t bound) {
+		state = state * 1664525u + 1013904223u;
+		return size_t(state >> 8) % bound;
+	}
+	double value() {
+		return double(int((*this)(9)) - 4);
+	}
+};
+
+template<typename V>
+static bool sorted(sparse_matrix<V> const& a) {
+	size_t const outer = a.layout() == RowMajor ? a.rows() : a.columns();
+	for (size_t o = 0; o < outer; o++)
+		for (size_t k = a.outer_starts()[o] + 1; k < a.outer_starts()[o + 1]; k++)
+			if (a.inner_indices()[k - 1] >= a.inner_indices()[k])
+				return false;
+	return true;
+}
+template<typename V>
+static bool same_arrays(sparse_matrix<V> const& a, sparse_matrix<V> const& b) {
+	size_t const outer = a.layout() == RowMajor ? a.rows() : a.columns();
+	if (a.layout() != b.layout() || a.rows() != b.rows() || a.columns() != b.columns() || a.non_zeros() != b.non_zeros())
+		return false;
+	for (size_t o = 0; o <= outer; o++)
+		if (a.outer_starts()[o] != b.outer_starts()[o])
+			return false;
+	for (size_t k = 0; k < a.non_zeros(); k++)
+		if (a.inner_indices()[k] != b.inner_indices()[k] || !(a.data()[k] == b.data()[k]))
+			return false;
+	return true;
+}
+
+static void check_scalar(size_t rows, size_t columns, generator& g) {
+	// Repeated coordinates, and one row and one column long enough for the sorted path.
+	std::vector<sparse_entry<double>> entries;
+	dynamic_matrix<double> dense(rows, columns, ZeroMatrix);
+	auto const add = [&](size_t r, size_t c) {
+		double const value = g.value();
+		entries.push_back({r, c, value});
+		dense.element(r, c) += value;
+	};
+	for (size_t i = 0; i < rows * columns / 3 + 1; i++)
+		add(g(rows), g(columns));
+	for (size_t i = 0; i < 80; i++) {
+		add(rows / 2, g(columns));
+		add(g(rows), columns - 1);
+	}
+	size_t stored = 0;
+	for (size_t r = 0; r < rows; r++)
+		for (size_t c = 0; c < columns; c++)
+			for (auto const& e : entries)
+				if (e.row == r && e.column == c) {
+					stored++;
+					break;
+				}
+
+	sparse_builder<double> builder(rows, columns);
+	for (auto const& e : entries)
+		builder.add(e.row, e.column, e.value);
+	sparse_matrix<double> const csr = builder.build(), csc = builder.build(ColumnMajor);
+	check(same_arrays(csr, sparse_matrix<double>(rows, columns, entries)));
+	for (auto const* a : {&csr, &csc}) {
+		check(a->rows() == rows && a->columns() == columns && a->non_zeros() == stored && sorted(*a));
+		bool equal = true;
+		for (size_t r = 0; r < rows; r++)
+			for (size_t c = 0; c < columns; c++)
+				equal = equal && a->at(r, c) == dense.element(r, c);
+		check(equal);
+		dynamic_matrix<double> const converted(*a);
+		check(converted == dense);
+	}
+	check(same_arrays(csr.with_layout(ColumnMajor), csc) && same_arrays(csc.with_layout(RowMajor), csr));
+	check(same_arrays(csr.with_layout(RowMajor), csr));
+	auto const transposed = csr.transposed();
+	check(transposed.layout() == ColumnMajor && transposed.rows() == columns && dynamic_matrix<double>(transposed) == dense.transposed());
+
+	std::vector<double> x(columns);
+	std::vector<basic_vector<double, 3>> xs(columns);
+	for (size_t c = 0; c < columns; c++) {
+		x[c] = g.value();
+		xs[c] = basic_vector<double, 3>(g.value(), g.value(), g.value());
+	}
+	dynamic_matrix<double> b(columns, 4, ZeroMatrix, ColumnMajor);
+	for (size_t r = 0; r < columns; r++)
+		for (size_t c = 0; c < 4; c++)
+			b.element(r, c) = g.value();
+	std::vector<double> expected(rows, 0.);
+	std::vector<basic_vector<double, 3>> expected_multi(rows, basic_vector<double, 3>());
+	for (size_t r = 0; r < rows; r++)
+		for (size_t c = 0; c < columns; c++) {
+			expected[r] += dense.element(r, c) * x[c];
+			for (size_t k = 0; k < 3; k++)
+				expected_multi[r][k] += dense.element(r, c) * xs[c][k];
+		}
+	dynamic_matrix<double> const expected_dense = dense * b;
+
+	// One thread, and more threads than some of the matrices have rows, for the row ranges
+	// of the CSC products.
+	thread_pool one(1), three(3);
+	for (thread_pool* pool : {&one, &three})
+		for (auto const* a : {&csr, &csc}) {
+			std::vector<double> y(rows, -1.);
+			multiply(*a, x.data(), y.data(), 4, *pool);
+			check(y == expected);
+			std::vector<basic_vector<double, 3>> ys(rows);
+			multiply(*a, xs.data(), ys.data(), 4, *pool);
+			check(ys == expected_multi);
+			dynamic_matrix<double> c;
+			multiply(*a, b, c, *pool);
+			check(c == expected_dense);
+		}
+	check(csr * x == expected && csc * x == expected);
+}
+
+static void check_blocks(size_t nodes, generator& g) {
+	using block = basic_matrix<double, 3, 3>;
+	using point = basic_vector<double, 3>;
+	std::vector<sparse_entry<block>> entries;
+	dynamic_matrix<double> dense(3 * nodes, 3 * nodes, ZeroMatrix);
+	for (size_t i = 0; i < 4 * nodes; i++) {
+		size_t const r = g(nodes), c = g(nodes);
+		block value(ZeroMatrix);
+		for (size_t p = 0; p < 3; p++)
+			for (size_t q = 0; q < 3; q++) {
+				value.element(p, q) = g.value();
+				dense.element(3 * r + p, 3 * c + q) += value.element(p, q);
+			}
+		entries.push_back({r, c, value});
+	}
+	std::vector<point> x(nodes);
+	for (auto& value : x)
+		value = point(g.value(), g.value(), g.value());
+	std::vector<point> expected(nodes, point());
+	for (size_t r = 0; r < 3 * nodes; r++)
+		for (size_t c = 0; c < 3 * nodes; c++)
+			expected[r / 3][r % 3] += dense.element(r, c) * x[c / 3][c % 3];
+
+	thread_pool three(3);
+	for (MatrixLayout layout : {RowMajor, ColumnMajor}) {
+		sparse_matrix<block> const a(nodes, nodes, entries, layout);
+		std::vector<point> y(nodes);
+		multiply(a, x.data(), y.data(), 2, three);
+		check(y == expected);
+		// Blocks are transposed along with the matrix.
+		auto const t = a.transposed();
+		bool equal = true;
+		for (size_t r = 0; r < 3 * nodes; r++)
+			for (size_t c = 0; c < 3 * nodes; c++)
+				equal = equal && t.at(c / 3, r / 3).element(c % 3, r % 3) == dense.element(r, c);
+		check(equal);
+	}
+}
+
+int main() {
+	generator g;
+	for (auto const& size : std::vector<std::pair<size_t, size_t>>{{1, 1}, {2, 40}, {7, 5}, {50, 3}, {64, 64}})
+		check_scalar(size.first, size.second, g);
+	check_blocks(1, g);
+	check_blocks(17, g);
+
+	bool thrown = false;
+	try {
+		sparse_matrix<double>(2, 2, std::vector<sparse_entry<double>>{{2, 0, 1.}});
+	} catch (Exceptions::MatrixIndexOutOfBounds const&) {
+		thrown = true;
+	}
+	check(thrown);
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,60 @@
+#include <cmath>
+#include <limits>
+
+#include "mml/math.hpp"
+
+#include "check.hpp"
+
+using namespace mml;
+
+template<typename T>
+static bool same(T a, T b) {
+	return a == b || (std::isnan(a) && std::isnan(b));
+}
+
+// The error against a long double reference, within the bound documented for |x| <= limit.
+template<typename T>
+static bool accurate(T x, math::sine_cosine<T> const& res, long double bound) {
+	long double const y = x;
+	return std::abs(res.sin - std::sin(y)) <= bound && std::abs(res.cos - std::cos(y)) <= bound;
+}
+
+template<typename T>
+static void check_type(long double bound) {
+	T const inf = std::numeric_limits<T>::infinity(), nan = std::numeric_limits<T>::quiet_NaN();
+	T const angles[] = {T(0), T(0.5), T(-3), T(100), T(-8192), T(8192), T(8192.5), T(-1e5), T(1e10), T(-1e30), inf, -inf, nan, T(1e-3)};
+	size_t const count = sizeof(angles) / sizeof(angles[0]);
+	for (T x : angles) {
+		auto const res = math::fast_sincos(x);
+		if (std::abs(x) <= math::fast_trigonometry<T>::limit)
+			check(accurate(x, res, bound));
+		else
+			check(same(res.sin, T(std::sin(x))) && same(res.cos, T(std::cos(x))));
+	}
+
+	// The kernel matches the scalar function lane for lane, also beyond the limit.
+	using K = simd::trigonometry_kernel<T>;
+	if constexpr (K::accelerated) {
+		T sines[count], cosines[count];
+		size_t i = 0;
+		for (; i + K::width <= count; i += K::width)
+			K::template sincos<math::fast_trigonometry<T>>(sines + i, cosines + i, angles + i);
+		for (size_t j = 0; j < i; j++) {
+			auto const res = math::fast_sincos(angles[j]);
+			check(same(sines[j], res.sin) && same(cosines[j], res.cos));
+		}
+	}
+	// Every 1 / 64 over the whole range, where steps are exact in float.
+	bool all = true;
+	for (int k = -8192 * 64; k <= 8192 * 64; k++) {
+		T const x = T(k) / T(64);
+		all = all && accurate(x, math::fast_sincos(x), bound);
+	}
+	check(all);
+}
+
+int main() {
+	check_type<float>(1e-7L);
+	check_type<double>(3e-9L);
+	return failures == 0 ? 0 : 1;
+}